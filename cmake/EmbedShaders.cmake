@@ -0,0 +1,35 @@
+# Writes the shader bytecode compiled at build time into CompiledShaders.inc as constant arrays.
+# Usage: cmake -DSHADERS_DIR=<dir> -P EmbedShaders.cmake
+# <dir>/Shaders.txt lists one shader per line: <index>|<backend>|<file>|<macros>, and the
+# bytecode of every shader is in <dir>/<index>.bin.
+
+file(STRINGS "${SHADERS_DIR}/Shaders.txt" SHADER_ENTRIES)
+
+set(LINE_PATTERN "")
+foreach(i RANGE 1 32)
+    string(APPEND LINE_PATTERN "0x..,")
+endforeach()
+
+set(ARRAYS "")
+set(TABLE "")
+foreach(ENTRY ${SHADER_ENTRIES})
+    string(REPLACE "|" ";" ENTRY "${ENTRY}")
+    list(GET ENTRY 0 INDEX)
+    list(GET ENTRY 1 BACKEND)
+    list(GET ENTRY 2 SHADER_FILE)
+    list(GET ENTRY 3 MACROS)
+
+    file(READ "${SHADERS_DIR}/${INDEX}.bin" BYTECODE HEX)
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," BYTECODE "${BYTECODE}")
+    # 32 bytes per line
+    string(REGEX REPLACE "(${LINE_PATTERN})" "\\1\n    " BYTECODE "${BYTECODE}")
+
+    string(APPEND ARRAYS "static const Uint8 CompiledShader${INDEX}[] =\n{\n    ${BYTECODE}\n};\n\n")
+    string(APPEND TABLE "    {\"${BACKEND}\", \"${SHADER_FILE}\", \"${MACROS}\", CompiledShader${INDEX}, sizeof(CompiledShader${INDEX})},\n")
+endforeach()
+
+set(CONTENT "// Generated by EmbedShaders.cmake. Do not edit.\n\n")
+string(APPEND CONTENT "${ARRAYS}")
+string(APPEND CONTENT "static const CompiledShaderEntry CompiledShaders[] =\n{\n${TABLE}};\n")
+
+file(WRITE "${SHADERS_DIR}/CompiledShaders.inc" "${CONTENT}")
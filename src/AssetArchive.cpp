@@ -0,0 +1,439 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "AssetArchive.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#if PLATFORM_WIN32
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    include <Windows.h>
+#elif PLATFORM_LINUX || PLATFORM_MACOS
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Lexicographic byte order; a prefix sorts before the longer name
+bool NameLess(const char* pName0, size_t Len0, const char* pName1, size_t Len1)
+{
+    const int Cmp = memcmp(pName0, pName1, std::min(Len0, Len1));
+    return Cmp != 0 ? Cmp < 0 : Len0 < Len1;
+}
+
+constexpr Uint64 DataAlignment = 16;
+
+} // namespace
+
+std::unique_ptr<AssetArchive> AssetArchive::Open(const char* Path)
+{
+    std::unique_ptr<AssetArchive> pArchive{new AssetArchive{}};
+
+#if PLATFORM_WIN32
+    HANDLE hFile = CreateFileA(Path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+    {
+        LOG_ERROR_MESSAGE("Failed to open asset archive '", Path, "'");
+        return {};
+    }
+    pArchive->m_hFile = hFile;
+
+    LARGE_INTEGER FileSize{};
+    GetFileSizeEx(hFile, &FileSize);
+    pArchive->m_Size = static_cast<size_t>(FileSize.QuadPart);
+    if (pArchive->m_Size > 0)
+    {
+        pArchive->m_hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (pArchive->m_hMapping != nullptr)
+            pArchive->m_pData = static_cast<const Uint8*>(MapViewOfFile(pArchive->m_hMapping, FILE_MAP_READ, 0, 0, 0));
+    }
+#elif PLATFORM_LINUX || PLATFORM_MACOS
+    const int fd = open(Path, O_RDONLY);
+    if (fd < 0)
+    {
+        LOG_ERROR_MESSAGE("Failed to open asset archive '", Path, "'");
+        return {};
+    }
+    struct stat FileStat = {};
+    fstat(fd, &FileStat);
+    pArchive->m_Size = static_cast<size_t>(FileStat.st_size);
+    if (pArchive->m_Size > 0)
+    {
+        void* pMapped = mmap(nullptr, pArchive->m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (pMapped != MAP_FAILED)
+            pArchive->m_pData = static_cast<const Uint8*>(pMapped);
+    }
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+#endif
+
+    if (pArchive->m_pData == nullptr)
+    {
+        // Platforms without memory mapping read the whole file
+        FILE* pFile = fopen(Path, "rb");
+        if (pFile == nullptr)
+        {
+            LOG_ERROR_MESSAGE("Failed to open asset archive '", Path, "'");
+            return {};
+        }
+        fseek(pFile, 0, SEEK_END);
+        pArchive->m_FileData.resize(static_cast<size_t>(ftell(pFile)));
+        fseek(pFile, 0, SEEK_SET);
+        const size_t BytesRead = fread(pArchive->m_FileData.data(), 1, pArchive->m_FileData.size(), pFile);
+        fclose(pFile);
+        pArchive->m_FileData.resize(BytesRead);
+        pArchive->m_pData = pArchive->m_FileData.data();
+        pArchive->m_Size  = pArchive->m_FileData.size();
+    }
+
+    const Uint8* pData = pArchive->m_pData;
+    const size_t Size  = pArchive->m_Size;
+    if (Size < sizeof(Header) || memcmp(pData, Magic, sizeof(Magic)) != 0)
+    {
+        LOG_ERROR_MESSAGE("'", Path, "' is not an asset archive");
+        return {};
+    }
+
+    pArchive->m_pHeader = reinterpret_cast<const Header*>(pData);
+    const auto& Hdr     = *pArchive->m_pHeader;
+    if (Hdr.Version != Version)
+    {
+        LOG_ERROR_MESSAGE("Asset archive '", Path, "' has version ", Hdr.Version, " while version ", Version, " is expected");
+        return {};
+    }
+
+    const Uint64 NamesOffset = sizeof(Header) + Uint64{sizeof(Entry)} * Hdr.NumEntries;
+    if (NamesOffset + Hdr.NamesSize > Size)
+    {
+        LOG_ERROR_MESSAGE("Asset archive '", Path, "' is truncated");
+        return {};
+    }
+    pArchive->m_pEntries = reinterpret_cast<const Entry*>(pData + sizeof(Header));
+    pArchive->m_pNames   = reinterpret_cast<const char*>(pData + NamesOffset);
+
+    for (Uint32 i = 0; i < Hdr.NumEntries; ++i)
+    {
+        const auto& E = pArchive->m_pEntries[i];
+        if (Uint64{E.NameOffset} + E.NameLength > Hdr.NamesSize || E.DataOffset > Size || E.StoredSize > Size - E.DataOffset ||
+            E.Compression > COMPRESSION_LZ4 || (E.Compression == COMPRESSION_NONE && E.StoredSize != E.Size))
+        {
+            LOG_ERROR_MESSAGE("Asset archive '", Path, "' has an invalid entry ", i);
+            return {};
+        }
+    }
+
+    return pArchive;
+}
+
+AssetArchive::~AssetArchive()
+{
+    if (m_FileData.empty() && m_pData != nullptr)
+    {
+#if PLATFORM_WIN32
+        UnmapViewOfFile(m_pData);
+#elif PLATFORM_LINUX || PLATFORM_MACOS
+        munmap(const_cast<Uint8*>(m_pData), m_Size);
+#endif
+    }
+#if PLATFORM_WIN32
+    if (m_hMapping != nullptr)
+        CloseHandle(m_hMapping);
+    if (m_hFile != nullptr)
+        CloseHandle(m_hFile);
+#endif
+}
+
+const AssetArchive::Entry* AssetArchive::Find(const char* Name) const
+{
+    const size_t NameLen = strlen(Name);
+
+    const Entry* pBegin = m_pEntries;
+    const Entry* pEnd   = m_pEntries + m_pHeader->NumEntries;
+    const Entry* pEntry = std::lower_bound(pBegin, pEnd, Name, [&](const Entry& E, const char* pName) {
+        return NameLess(m_pNames + E.NameOffset, E.NameLength, pName, NameLen);
+    });
+    if (pEntry == pEnd || pEntry->NameLength != NameLen || memcmp(m_pNames + pEntry->NameOffset, Name, NameLen) != 0)
+        return nullptr;
+    return pEntry;
+}
+
+bool AssetArchive::Read(const Entry& E, std::vector<Uint8>& Data) const
+{
+    Data.resize(static_cast<size_t>(E.Size));
+    const Uint8* pStored = m_pData + E.DataOffset;
+    switch (E.Compression)
+    {
+        case COMPRESSION_NONE:
+            if (!Data.empty())
+                memcpy(Data.data(), pStored, Data.size());
+            return true;
+
+        case COMPRESSION_LZ4:
+            return DecompressLZ4(pStored, static_cast<size_t>(E.StoredSize), Data.data(), Data.size());
+
+        default:
+            return false;
+    }
+}
+
+bool AssetArchive::Write(const char* Path, std::vector<SourceFile> Files, bool Compress)
+{
+    std::sort(Files.begin(), Files.end(), [](const SourceFile& F0, const SourceFile& F1) {
+        return NameLess(F0.Name.data(), F0.Name.size(), F1.Name.data(), F1.Name.size());
+    });
+    for (size_t i = 1; i < Files.size(); ++i)
+    {
+        if (Files[i].Name == Files[i - 1].Name)
+        {
+            LOG_ERROR_MESSAGE("Duplicate asset name '", Files[i].Name, "'");
+            return false;
+        }
+    }
+
+    Header Hdr;
+    memcpy(Hdr.Magic, Magic, sizeof(Magic));
+    Hdr.Version    = Version;
+    Hdr.NumEntries = static_cast<Uint32>(Files.size());
+    Hdr.NamesSize  = 0;
+    for (const auto& File : Files)
+        Hdr.NamesSize += static_cast<Uint32>(File.Name.size());
+
+    std::vector<Entry>              Entries(Files.size());
+    std::vector<std::vector<Uint8>> StoredData(Files.size());
+
+    Uint64 DataOffset = sizeof(Header) + Uint64{sizeof(Entry)} * Files.size() + Hdr.NamesSize;
+    Uint32 NameOffset = 0;
+    for (size_t i = 0; i < Files.size(); ++i)
+    {
+        const auto& File = Files[i];
+        auto&       E    = Entries[i];
+        E.Compression    = COMPRESSION_NONE;
+        if (Compress && !File.Data.empty())
+        {
+            // Already compressed data (e.g. PNG) is stored as is, so that it can be used
+            // directly from the mapped file
+            auto Compressed = CompressLZ4(File.Data.data(), File.Data.size());
+            if (Compressed.size() < File.Data.size() - File.Data.size() / 16)
+            {
+                StoredData[i] = std::move(Compressed);
+                E.Compression = COMPRESSION_LZ4;
+            }
+        }
+        const auto& Stored = E.Compression == COMPRESSION_NONE ? File.Data : StoredData[i];
+
+        DataOffset   = (DataOffset + DataAlignment - 1) / DataAlignment * DataAlignment;
+        E.DataOffset = DataOffset;
+        E.StoredSize = Stored.size();
+        E.Size       = File.Data.size();
+        E.NameOffset = NameOffset;
+        E.NameLength = static_cast<Uint16>(File.Name.size());
+        E.Reserved   = 0;
+
+        DataOffset += E.StoredSize;
+        NameOffset += E.NameLength;
+    }
+
+    FILE* pFile = fopen(Path, "wb");
+    if (pFile == nullptr)
+    {
+        LOG_ERROR_MESSAGE("Failed to create asset archive '", Path, "'");
+        return false;
+    }
+
+    bool Success = fwrite(&Hdr, sizeof(Hdr), 1, pFile) == 1;
+    if (!Entries.empty())
+        Success = Success && fwrite(Entries.data(), sizeof(Entry), Entries.size(), pFile) == Entries.size();
+    for (const auto& File : Files)
+        Success = Success && fwrite(File.Name.data(), 1, File.Name.size(), pFile) == File.Name.size();
+    for (size_t i = 0; i < Files.size() && Success; ++i)
+    {
+        const auto& E      = Entries[i];
+        const auto& Stored = E.Compression == COMPRESSION_NONE ? Files[i].Data : StoredData[i];
+
+        // Pad to the aligned entry offset
+        static constexpr Uint8 Zeros[DataAlignment] = {};
+        const size_t           Padding              = static_cast<size_t>(E.DataOffset - static_cast<Uint64>(ftell(pFile)));
+
+        Success = fwrite(Zeros, 1, Padding, pFile) == Padding;
+        Success = Success && (Stored.empty() || fwrite(Stored.data(), 1, Stored.size(), pFile) == Stored.size());
+    }
+    Success = fclose(pFile) == 0 && Success;
+
+    if (!Success)
+        LOG_ERROR_MESSAGE("Failed to write asset archive '", Path, "'");
+    return Success;
+}
+
+std::vector<Uint8> AssetArchive::CompressLZ4(const Uint8* pSrc, size_t SrcSize)
+{
+    // Greedy single-probe matcher. The block format requires the last 5 bytes to be literals
+    // and the last match to start at least 12 bytes before the end of the block.
+    constexpr size_t MinMatch     = 4;
+    constexpr size_t LastLiterals = 5;
+    constexpr size_t MFLimit      = 12;
+    constexpr size_t MaxOffset    = 65535;
+    constexpr Uint32 HashLog      = 16;
+    constexpr Uint32 InvalidPos   = ~0u;
+
+    std::vector<Uint8> Dst;
+    Dst.reserve(SrcSize + SrcSize / 255 + 16);
+
+    auto EmitLength = [&Dst](size_t Length) {
+        for (; Length >= 255; Length -= 255)
+            Dst.push_back(255);
+        Dst.push_back(static_cast<Uint8>(Length));
+    };
+
+    size_t Anchor       = 0;
+    auto   EmitSequence = [&](size_t LiteralsEnd, size_t MatchLength, size_t Offset) {
+        const size_t NumLiterals = LiteralsEnd - Anchor;
+        const size_t TokenPos    = Dst.size();
+        Dst.push_back(static_cast<Uint8>(std::min<size_t>(NumLiterals, 15) << 4));
+        if (NumLiterals >= 15)
+            EmitLength(NumLiterals - 15);
+        Dst.insert(Dst.end(), pSrc + Anchor, pSrc + LiteralsEnd);
+        if (MatchLength > 0)
+        {
+            Dst.push_back(static_cast<Uint8>(Offset & 0xFF));
+            Dst.push_back(static_cast<Uint8>(Offset >> 8));
+            const size_t ExtraLength = MatchLength - MinMatch;
+            Dst[TokenPos] |= static_cast<Uint8>(std::min<size_t>(ExtraLength, 15));
+            if (ExtraLength >= 15)
+                EmitLength(ExtraLength - 15);
+        }
+    };
+
+    if (SrcSize > MFLimit)
+    {
+        std::vector<Uint32> HashTable(size_t{1} << HashLog, InvalidPos);
+
+        const size_t MatchLimit = SrcSize - LastLiterals;
+        size_t       Pos        = 0;
+        while (Pos <= SrcSize - MFLimit)
+        {
+            Uint32 Sequence;
+            memcpy(&Sequence, pSrc + Pos, sizeof(Sequence));
+            const Uint32 Hash      = (Sequence * 2654435761u) >> (32 - HashLog);
+            const Uint32 Candidate = HashTable[Hash];
+            HashTable[Hash]        = static_cast<Uint32>(Pos);
+
+            if (Candidate != InvalidPos && Pos - Candidate <= MaxOffset && memcmp(pSrc + Candidate, pSrc + Pos, MinMatch) == 0)
+            {
+                size_t MatchLength = MinMatch;
+                while (Pos + MatchLength < MatchLimit && pSrc[Candidate + MatchLength] == pSrc[Pos + MatchLength])
+                    ++MatchLength;
+
+                EmitSequence(Pos, MatchLength, Pos - Candidate);
+                Pos += MatchLength;
+                Anchor = Pos;
+            }
+            else
+            {
+                ++Pos;
+            }
+        }
+    }
+
+    // The last sequence only has literals
+    EmitSequence(SrcSize, 0, 0);
+    return Dst;
+}
+
+bool AssetArchive::DecompressLZ4(const Uint8* pSrc, size_t SrcSize, Uint8* pDst, size_t DstSize)
+{
+    const Uint8* pIn     = pSrc;
+    const Uint8* pInEnd  = pSrc + SrcSize;
+    Uint8*       pOut    = pDst;
+    Uint8*       pOutEnd = pDst + DstSize;
+
+    auto ReadLength = [&](size_t& Length) {
+        Uint8 Byte = 255;
+        while (Byte == 255)
+        {
+            if (pIn >= pInEnd)
+                return false;
+            Byte = *pIn++;
+            Length += Byte;
+        }
+        return true;
+    };
+
+    while (pIn < pInEnd)
+    {
+        const Uint8 Token = *pIn++;
+
+        size_t NumLiterals = Token >> 4;
+        if (NumLiterals == 15 && !ReadLength(NumLiterals))
+            return false;
+        if (NumLiterals > static_cast<size_t>(pInEnd - pIn) || NumLiterals > static_cast<size_t>(pOutEnd - pOut))
+            return false;
+        if (NumLiterals > 0)
+            memcpy(pOut, pIn, NumLiterals);
+        pIn += NumLiterals;
+        pOut += NumLiterals;
+
+        // The last sequence has no match
+        if (pIn == pInEnd)
+            break;
+
+        if (pInEnd - pIn < 2)
+            return false;
+        const size_t Offset = size_t{pIn[0]} | (size_t{pIn[1]} << 8);
+        pIn += 2;
+        if (Offset == 0 || Offset > static_cast<size_t>(pOut - pDst))
+            return false;
+
+        size_t MatchLength = Token & 15;
+        if (MatchLength == 15 && !ReadLength(MatchLength))
+            return false;
+        MatchLength += 4;
+        if (MatchLength > static_cast<size_t>(pOutEnd - pOut))
+            return false;
+
+        // The match may overlap the output, so it is copied byte by byte
+        const Uint8* pMatch = pOut - Offset;
+        for (size_t i = 0; i < MatchLength; ++i)
+            pOut[i] = pMatch[i];
+        pOut += MatchLength;
+    }
+    return pOut == pOutEnd;
+}
+
+} // namespace Diligent
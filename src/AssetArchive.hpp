@@ -0,0 +1,123 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BasicTypes.h"
+
+namespace Diligent
+{
+
+// Read-only archive that packs all assets of the sample into one file. The file starts with
+// a table of contents sorted by name, followed by the names and the entry data. Entries are
+// stored either as is or LZ4-compressed (block format). The file is memory-mapped, so
+// uncompressed entries are accessed without copies and only touched pages are read.
+// All integers are little-endian.
+class AssetArchive
+{
+public:
+    enum COMPRESSION : Uint8
+    {
+        COMPRESSION_NONE = 0,
+        COMPRESSION_LZ4  = 1
+    };
+
+    struct Header
+    {
+        char   Magic[4];
+        Uint32 Version;
+        Uint32 NumEntries;
+        Uint32 NamesSize;
+    };
+
+    struct Entry
+    {
+        Uint64 DataOffset; // From the start of the file
+        Uint64 StoredSize; // Size in the file
+        Uint64 Size;       // Uncompressed size
+        Uint32 NameOffset; // From the start of the name table
+        Uint16 NameLength;
+        Uint8  Compression;
+        Uint8  Reserved;
+    };
+    static_assert(sizeof(Header) == 16 && sizeof(Entry) == 32, "The archive layout must not depend on the compiler");
+
+    static constexpr char   Magic[4] = {'T', '5', 'P', 'K'};
+    static constexpr Uint32 Version  = 1;
+
+    // Returns null if the file cannot be opened or is not a valid archive.
+    static std::unique_ptr<AssetArchive> Open(const char* Path);
+
+    ~AssetArchive();
+
+    // Binary search in the table of contents. Returns null if there is no such entry.
+    const Entry* Find(const char* Name) const;
+
+    Uint32       GetNumEntries() const { return m_pHeader->NumEntries; }
+    const Entry& GetEntry(Uint32 Index) const { return m_pEntries[Index]; }
+    std::string  GetName(const Entry& E) const { return std::string{m_pNames + E.NameOffset, E.NameLength}; }
+
+    // Returns the mapped data of an uncompressed entry, or null if the entry is compressed
+    const void* GetData(const Entry& E) const { return E.Compression == COMPRESSION_NONE ? m_pData + E.DataOffset : nullptr; }
+
+    // Decompresses or copies the entry. Returns false if the data is corrupted.
+    bool Read(const Entry& E, std::vector<Uint8>& Data) const;
+
+    struct SourceFile
+    {
+        std::string        Name;
+        std::vector<Uint8> Data;
+    };
+    // Writes an archive. If Compress is true, entries that shrink noticeably are LZ4-compressed.
+    static bool Write(const char* Path, std::vector<SourceFile> Files, bool Compress);
+
+    // LZ4 block format: https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+    static std::vector<Uint8> CompressLZ4(const Uint8* pSrc, size_t SrcSize);
+    static bool               DecompressLZ4(const Uint8* pSrc, size_t SrcSize, Uint8* pDst, size_t DstSize);
+
+private:
+    AssetArchive() = default;
+
+    const Uint8*  m_pData    = nullptr;
+    size_t        m_Size     = 0;
+    const Header* m_pHeader  = nullptr;
+    const Entry*  m_pEntries = nullptr;
+    const char*   m_pNames   = nullptr;
+
+    // Storage of the file if it could not be mapped
+    std::vector<Uint8> m_FileData;
+#if PLATFORM_WIN32
+    void* m_hFile    = nullptr;
+    void* m_hMapping = nullptr;
+#endif
+};
+
+} // namespace Diligent
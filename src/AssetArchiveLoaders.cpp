@@ -0,0 +1,117 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "AssetArchiveLoaders.hpp"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "ShaderSourceFactoryUtils.h"
+
+namespace Diligent
+{
+
+namespace
+{
+
+bool IsShaderSource(const std::string& Name)
+{
+    static constexpr const char* Extensions[] = {".vsh", ".psh", ".fxh", ".hlsl", ".glsl", ".h"};
+    for (const char* Ext : Extensions)
+    {
+        const size_t ExtLen = strlen(Ext);
+        if (Name.size() > ExtLen && Name.compare(Name.size() - ExtLen, ExtLen, Ext) == 0)
+            return true;
+    }
+    return false;
+}
+
+} // namespace
+
+void CreateArchiveShaderSourceFactory(const AssetArchive& Archive, IShaderSourceInputStreamFactory** ppFactory)
+{
+    std::vector<std::string>        Names;
+    std::vector<std::vector<Uint8>> Sources;
+    for (Uint32 i = 0; i < Archive.GetNumEntries(); ++i)
+    {
+        const auto& Entry = Archive.GetEntry(i);
+        std::string Name  = Archive.GetName(Entry);
+        if (!IsShaderSource(Name))
+            continue;
+
+        std::vector<Uint8> Source;
+        if (!Archive.Read(Entry, Source))
+        {
+            LOG_ERROR_MESSAGE("Failed to read shader source '", Name, "' from the asset archive");
+            continue;
+        }
+        Names.emplace_back(std::move(Name));
+        Sources.emplace_back(std::move(Source));
+    }
+
+    std::vector<MemoryShaderSourceFileInfo> SourceInfos(Names.size());
+    for (size_t i = 0; i < Names.size(); ++i)
+    {
+        SourceInfos[i].Name   = Names[i].c_str();
+        SourceInfos[i].pData  = reinterpret_cast<const Char*>(Sources[i].data());
+        SourceInfos[i].Length = static_cast<Uint32>(Sources[i].size());
+    }
+
+    MemoryShaderSourceFactoryCreateInfo FactoryCI;
+    FactoryCI.pSources    = SourceInfos.data();
+    FactoryCI.NumSources  = static_cast<Uint32>(SourceInfos.size());
+    FactoryCI.CopySources = true;
+    CreateMemoryShaderSourceFactory(FactoryCI, ppFactory);
+}
+
+void CreateArchiveTextureLoader(const AssetArchive& Archive, const char* Name, const TextureLoadInfo& LoadInfo, ITextureLoader** ppLoader)
+{
+    const auto* pEntry = Archive.Find(Name);
+    if (pEntry == nullptr)
+    {
+        LOG_ERROR_MESSAGE("Texture '", Name, "' is not in the asset archive");
+        return;
+    }
+
+    if (const void* pData = Archive.GetData(*pEntry))
+    {
+        // The archive stays mapped while the sample runs, so the loader does not need a copy
+        CreateTextureLoaderFromMemory(pData, static_cast<size_t>(pEntry->Size), false, LoadInfo, ppLoader);
+        return;
+    }
+
+    std::vector<Uint8> Data;
+    if (!Archive.Read(*pEntry, Data))
+    {
+        LOG_ERROR_MESSAGE("Failed to read texture '", Name, "' from the asset archive");
+        return;
+    }
+    CreateTextureLoaderFromMemory(Data.data(), Data.size(), true, LoadInfo, ppLoader);
+}
+
+} // namespace Diligent
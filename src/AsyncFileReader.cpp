@@ -0,0 +1,575 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "AsyncFileReader.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#if PLATFORM_LINUX
+#    include <fcntl.h>
+#    include <linux/io_uring.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+#if PLATFORM_LINUX
+
+// Minimal io_uring wrapper on top of the raw system calls, so that liburing is not required.
+// Only reads are issued, and the rings are only accessed by one thread at a time.
+class AsyncFileReader::IoUring
+{
+public:
+    static std::unique_ptr<IoUring> Create(Uint32 NumEntries)
+    {
+        std::unique_ptr<IoUring> pRing{new IoUring{}};
+
+        io_uring_params Params = {};
+        pRing->m_fd            = static_cast<int>(syscall(__NR_io_uring_setup, NumEntries, &Params));
+        if (pRing->m_fd < 0)
+            return {};
+
+        pRing->m_SQRingSize = Params.sq_off.array + Params.sq_entries * sizeof(Uint32);
+        pRing->m_CQRingSize = Params.cq_off.cqes + Params.cq_entries * sizeof(io_uring_cqe);
+        if (Params.features & IORING_FEAT_SINGLE_MMAP)
+            pRing->m_SQRingSize = pRing->m_CQRingSize = std::max(pRing->m_SQRingSize, pRing->m_CQRingSize);
+
+        pRing->m_pSQRing = mmap(nullptr, pRing->m_SQRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, pRing->m_fd, IORING_OFF_SQ_RING);
+        if (pRing->m_pSQRing == MAP_FAILED)
+            return {};
+
+        if (Params.features & IORING_FEAT_SINGLE_MMAP)
+        {
+            pRing->m_pCQRing = pRing->m_pSQRing;
+        }
+        else
+        {
+            pRing->m_pCQRing = mmap(nullptr, pRing->m_CQRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, pRing->m_fd, IORING_OFF_CQ_RING);
+            if (pRing->m_pCQRing == MAP_FAILED)
+                return {};
+        }
+
+        pRing->m_SQEsSize = Params.sq_entries * sizeof(io_uring_sqe);
+        void* pSQEs       = mmap(nullptr, pRing->m_SQEsSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, pRing->m_fd, IORING_OFF_SQES);
+        if (pSQEs == MAP_FAILED)
+            return {};
+        pRing->m_pSQEs = static_cast<io_uring_sqe*>(pSQEs);
+
+        Uint8* pSQ         = static_cast<Uint8*>(pRing->m_pSQRing);
+        Uint8* pCQ         = static_cast<Uint8*>(pRing->m_pCQRing);
+        pRing->m_pSQTail   = reinterpret_cast<Uint32*>(pSQ + Params.sq_off.tail);
+        pRing->m_SQMask    = *reinterpret_cast<Uint32*>(pSQ + Params.sq_off.ring_mask);
+        pRing->m_pSQArray  = reinterpret_cast<Uint32*>(pSQ + Params.sq_off.array);
+        pRing->m_pCQHead   = reinterpret_cast<Uint32*>(pCQ + Params.cq_off.head);
+        pRing->m_pCQTail   = reinterpret_cast<Uint32*>(pCQ + Params.cq_off.tail);
+        pRing->m_CQMask    = *reinterpret_cast<Uint32*>(pCQ + Params.cq_off.ring_mask);
+        pRing->m_pCQEs     = reinterpret_cast<io_uring_cqe*>(pCQ + Params.cq_off.cqes);
+
+        pRing->m_SQTail     = *pRing->m_pSQTail;
+        pRing->m_NumEntries = Params.sq_entries;
+        return pRing;
+    }
+
+    ~IoUring()
+    {
+        if (m_pSQEs != nullptr)
+            munmap(m_pSQEs, m_SQEsSize);
+        if (m_pCQRing != nullptr && m_pCQRing != MAP_FAILED && m_pCQRing != m_pSQRing)
+            munmap(m_pCQRing, m_CQRingSize);
+        if (m_pSQRing != nullptr && m_pSQRing != MAP_FAILED)
+            munmap(m_pSQRing, m_SQRingSize);
+        if (m_fd >= 0)
+            close(m_fd);
+    }
+
+    // The number of in-flight reads is limited by the size of the submission queue,
+    // so the completion queue (which is at least twice as large) never overflows.
+    bool CanPrepare() const { return m_NumInFlight + m_NumToSubmit < m_NumEntries; }
+    bool IsIdle() const { return m_NumInFlight + m_NumToSubmit == 0; }
+    bool HasInFlight() const { return m_NumInFlight > 0; }
+
+    void PrepareRead(int fd, void* pDst, Uint32 Size, Uint64 Offset, Uint64 UserData)
+    {
+        VERIFY_EXPR(CanPrepare());
+        const Uint32 Index = m_SQTail & m_SQMask;
+        io_uring_sqe& SQE  = m_pSQEs[Index];
+        SQE                = {};
+        SQE.opcode         = IORING_OP_READ;
+        SQE.fd             = fd;
+        SQE.addr           = reinterpret_cast<Uint64>(pDst);
+        SQE.len            = Size;
+        SQE.off            = Offset;
+        SQE.user_data      = UserData;
+        m_pSQArray[Index]  = Index;
+        ++m_SQTail;
+        ++m_NumToSubmit;
+    }
+
+    // Submits the prepared reads and blocks until at least MinComplete reads complete
+    bool Enter(Uint32 MinComplete)
+    {
+        // Make the entries visible to the kernel before the tail is updated
+        __atomic_store_n(m_pSQTail, m_SQTail, __ATOMIC_RELEASE);
+        for (;;)
+        {
+            const long Res = syscall(__NR_io_uring_enter, m_fd, m_NumToSubmit, MinComplete, MinComplete > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+            if (Res >= 0)
+            {
+                m_NumToSubmit -= static_cast<Uint32>(Res);
+                m_NumInFlight += static_cast<Uint32>(Res);
+                return true;
+            }
+            if (errno != EINTR)
+                return false;
+        }
+    }
+
+    // Blocks until at least one submitted read completes. Prepared reads are not submitted.
+    bool WaitForCompletion()
+    {
+        for (;;)
+        {
+            if (syscall(__NR_io_uring_enter, m_fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) >= 0)
+                return true;
+            if (errno != EINTR)
+                return false;
+        }
+    }
+
+    // Returns false if there are no completions
+    bool PopCompletion(Uint64& UserData, Int32& Result)
+    {
+        const Uint32 Head = *m_pCQHead;
+        if (Head == __atomic_load_n(m_pCQTail, __ATOMIC_ACQUIRE))
+            return false;
+
+        const io_uring_cqe& CQE = m_pCQEs[Head & m_CQMask];
+        UserData                = CQE.user_data;
+        Result                  = CQE.res;
+        __atomic_store_n(m_pCQHead, Head + 1, __ATOMIC_RELEASE);
+        --m_NumInFlight;
+        return true;
+    }
+
+private:
+    IoUring() = default;
+
+    int m_fd = -1;
+
+    void*         m_pSQRing    = nullptr;
+    void*         m_pCQRing    = nullptr;
+    io_uring_sqe* m_pSQEs      = nullptr;
+    size_t        m_SQRingSize = 0;
+    size_t        m_CQRingSize = 0;
+    size_t        m_SQEsSize   = 0;
+
+    Uint32*       m_pSQTail  = nullptr;
+    Uint32*       m_pSQArray = nullptr;
+    Uint32        m_SQMask   = 0;
+    Uint32*       m_pCQHead  = nullptr;
+    Uint32*       m_pCQTail  = nullptr;
+    Uint32        m_CQMask   = 0;
+    io_uring_cqe* m_pCQEs    = nullptr;
+
+    Uint32 m_SQTail      = 0;
+    Uint32 m_NumEntries  = 0;
+    Uint32 m_NumToSubmit = 0;
+    Uint32 m_NumInFlight = 0;
+};
+
+#else
+
+class AsyncFileReader::IoUring
+{
+};
+
+#endif
+
+AsyncFileReader::AsyncFileReader(IThreadPool* pThreadPool, Uint32 QueueDepth) :
+    m_pThreadPool{pThreadPool}
+{
+#if PLATFORM_LINUX
+    m_pIoUring = IoUring::Create(QueueDepth);
+    if (!m_pIoUring)
+        LOG_INFO_MESSAGE("io_uring is not available (", strerror(errno), "); files will be read on the thread pool");
+#else
+    (void)QueueDepth;
+#endif
+}
+
+AsyncFileReader::~AsyncFileReader()
+{
+    for (auto& pTask : m_Tasks)
+        pTask->WaitForCompletion();
+
+#if PLATFORM_LINUX
+    if (m_pIoUring)
+    {
+        // The kernel may still be writing into the buffers
+        m_ReadQueue.clear();
+        while (!m_pIoUring->IsIdle() && m_pIoUring->Enter(1))
+        {
+            Uint64 UserData = 0;
+            Int32  Result   = 0;
+            while (m_pIoUring->PopCompletion(UserData, Result))
+            {
+            }
+        }
+    }
+    for (auto& Req : m_Requests)
+    {
+        if (Req.fd >= 0)
+            close(Req.fd);
+    }
+#endif
+}
+
+Uint32 AsyncFileReader::AddRequest(const char* Path)
+{
+    VERIFY(m_Tasks.empty() && m_ReadQueue.empty(), "Requests must be added before Submit() is called");
+    m_Requests.emplace_back();
+    m_Requests.back().Path = Path;
+    return static_cast<Uint32>(m_Requests.size() - 1);
+}
+
+void AsyncFileReader::Submit()
+{
+    if (m_pIoUring)
+    {
+        SubmitIoUring();
+        return;
+    }
+
+    m_Tasks.reserve(m_Requests.size());
+    for (auto& Req : m_Requests)
+    {
+        Req.Status = STATUS::Reading;
+        m_Tasks.emplace_back(EnqueueAsyncWork(m_pThreadPool,
+                                              [this, &Req](Uint32) {
+                                                  ReadFile(Req);
+                                                  return ASYNC_TASK_STATUS_COMPLETE;
+                                              }));
+    }
+}
+
+void AsyncFileReader::ReadFile(Request& Req)
+{
+    FILE* pFile = fopen(Req.Path.c_str(), "rb");
+    if (pFile == nullptr)
+    {
+        LOG_ERROR_MESSAGE("Failed to open '", Req.Path, "'");
+        CompleteRequest(Req, STATUS::Failed);
+        return;
+    }
+
+    fseek(pFile, 0, SEEK_END);
+    const long Size = ftell(pFile);
+    fseek(pFile, 0, SEEK_SET);
+    Req.Data.resize(static_cast<size_t>(std::max(Size, 0l)));
+    Req.BytesRead = fread(Req.Data.data(), 1, Req.Data.size(), pFile);
+    fclose(pFile);
+
+    Req.Data.resize(static_cast<size_t>(Req.BytesRead));
+    CompleteRequest(Req, STATUS::Complete);
+}
+
+void AsyncFileReader::CompleteRequest(Request& Req, STATUS Status)
+{
+#if PLATFORM_LINUX
+    if (Req.fd >= 0)
+    {
+        close(Req.fd);
+        Req.fd = -1;
+    }
+#endif
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        Req.Status = Status;
+        m_CompletionOrder.push_back(static_cast<Uint32>(&Req - m_Requests.data()));
+    }
+    m_CompletedCV.notify_all();
+}
+
+bool AsyncFileReader::Wait(Uint32 Request)
+{
+    auto& Req = m_Requests[Request];
+#if PLATFORM_LINUX
+    {
+        // Another waiting thread may destroy the ring when it falls back to synchronous reads,
+        // in which case all requests are complete once the lock is acquired
+        std::lock_guard<std::mutex> Lock{m_IoUringMtx};
+        if (m_pIoUring)
+        {
+            while (Req.Status == STATUS::Pending || Req.Status == STATUS::Reading)
+            {
+                FillSubmissionQueue();
+                if (!m_pIoUring->Enter(1))
+                {
+                    FinishSynchronously();
+                    break;
+                }
+                ProcessCompletions();
+            }
+            return Req.Status == STATUS::Complete;
+        }
+    }
+#endif
+
+    std::unique_lock<std::mutex> Lock{m_Mtx};
+    m_CompletedCV.wait(Lock, [&Req]() { return Req.Status == STATUS::Complete || Req.Status == STATUS::Failed; });
+    return Req.Status == STATUS::Complete;
+}
+
+Uint32 AsyncFileReader::WaitAny(Uint32 FirstRequest, Uint32 NumRequests)
+{
+    VERIFY_EXPR(FirstRequest + NumRequests <= m_Requests.size());
+#if PLATFORM_LINUX
+    {
+        std::lock_guard<std::mutex> Lock{m_IoUringMtx};
+        if (m_pIoUring)
+        {
+            for (;;)
+            {
+                {
+                    std::lock_guard<std::mutex> CompletionLock{m_Mtx};
+                    const Uint32                Request = PopCompletedRequest(FirstRequest, NumRequests);
+                    if (Request != InvalidRequest || !HasRequestsInFlight(FirstRequest, NumRequests))
+                        return Request;
+                }
+                FillSubmissionQueue();
+                if (!m_pIoUring->Enter(1))
+                {
+                    FinishSynchronously();
+                    break;
+                }
+                ProcessCompletions();
+            }
+        }
+    }
+#endif
+
+    std::unique_lock<std::mutex> Lock{m_Mtx};
+    Uint32                       Request = InvalidRequest;
+    m_CompletedCV.wait(Lock, [&]() {
+        Request = PopCompletedRequest(FirstRequest, NumRequests);
+        return Request != InvalidRequest || !HasRequestsInFlight(FirstRequest, NumRequests);
+    });
+    return Request;
+}
+
+Uint32 AsyncFileReader::PopCompletedRequest(Uint32 FirstRequest, Uint32 NumRequests)
+{
+    for (Uint32 Request : m_CompletionOrder)
+    {
+        auto& Req = m_Requests[Request];
+        if (Request >= FirstRequest && Request < FirstRequest + NumRequests && !Req.Returned)
+        {
+            Req.Returned = true;
+            return Request;
+        }
+    }
+    return InvalidRequest;
+}
+
+bool AsyncFileReader::HasRequestsInFlight(Uint32 FirstRequest, Uint32 NumRequests) const
+{
+    for (Uint32 Request = FirstRequest; Request < FirstRequest + NumRequests; ++Request)
+    {
+        const auto Status = m_Requests[Request].Status;
+        if (Status == STATUS::Pending || Status == STATUS::Reading)
+            return true;
+    }
+    return false;
+}
+
+void AsyncFileReader::Release(Uint32 Request)
+{
+    auto& Req = m_Requests[Request];
+    VERIFY(Req.Status == STATUS::Complete || Req.Status == STATUS::Failed, "Only completed requests can be released");
+    std::vector<Uint8>{}.swap(Req.Data);
+}
+
+Uint64 AsyncFileReader::GetBytesRead() const
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+
+    Uint64 BytesRead = 0;
+    for (const auto& Req : m_Requests)
+        BytesRead += Req.BytesRead;
+    return BytesRead;
+}
+
+bool AsyncFileReader::IsUsingIoUring() const
+{
+    std::lock_guard<std::mutex> Lock{m_IoUringMtx};
+    return m_pIoUring != nullptr;
+}
+
+#if PLATFORM_LINUX
+
+void AsyncFileReader::SubmitIoUring()
+{
+    // Opening is synchronous, but it only touches the metadata, which is much cheaper than the reads
+    for (Uint32 i = 0; i < m_Requests.size(); ++i)
+    {
+        auto& Req = m_Requests[i];
+        Req.fd    = open(Req.Path.c_str(), O_RDONLY);
+        if (Req.fd < 0)
+        {
+            LOG_ERROR_MESSAGE("Failed to open '", Req.Path, "'");
+            CompleteRequest(Req, STATUS::Failed);
+            continue;
+        }
+
+        struct stat FileStat = {};
+        fstat(Req.fd, &FileStat);
+        Req.Data.resize(static_cast<size_t>(FileStat.st_size));
+        if (Req.Data.empty())
+        {
+            CompleteRequest(Req, STATUS::Complete);
+            continue;
+        }
+        Req.Status = STATUS::Reading;
+        m_ReadQueue.push_back(i);
+    }
+
+    // Start the first reads right away rather than at the first Wait()
+    FillSubmissionQueue();
+    if (!m_pIoUring->Enter(0))
+        FinishSynchronously();
+}
+
+void AsyncFileReader::FinishSynchronously()
+{
+    LOG_ERROR_MESSAGE("io_uring_enter failed (", strerror(errno), "); reading the remaining files synchronously");
+
+    // The kernel writes into the buffers of the reads in flight, and destroying the ring does not
+    // wait for them, so they must complete before the buffers are read again or freed. Completed
+    // reads are kept; the rest is read from the start. Prepared reads that were never submitted
+    // are dropped with the ring.
+    while (m_pIoUring->HasInFlight())
+    {
+        if (!m_pIoUring->WaitForCompletion())
+        {
+            // The buffers may still be written, so the reads cannot be retried. The ring is kept
+            // until the destructor, which waits for the reads again.
+            LOG_ERROR_MESSAGE("Failed to wait for the io_uring reads in flight (", strerror(errno), ")");
+            m_ReadQueue.clear();
+            for (auto& Req : m_Requests)
+            {
+                if (Req.Status == STATUS::Pending || Req.Status == STATUS::Reading)
+                    CompleteRequest(Req, STATUS::Failed);
+            }
+            return;
+        }
+        ProcessCompletions();
+    }
+    m_pIoUring.reset();
+    m_ReadQueue.clear();
+    for (auto& Req : m_Requests)
+    {
+        if (Req.Status == STATUS::Pending || Req.Status == STATUS::Reading)
+            ReadFile(Req);
+    }
+}
+
+void AsyncFileReader::FillSubmissionQueue()
+{
+    // A single read is limited to 1 GB; larger files are read in several steps
+    constexpr Uint64 MaxReadSize = Uint64{1} << 30;
+    while (!m_ReadQueue.empty() && m_pIoUring->CanPrepare())
+    {
+        const Uint32 Index = m_ReadQueue.front();
+        m_ReadQueue.pop_front();
+
+        auto&        Req  = m_Requests[Index];
+        const Uint32 Size = static_cast<Uint32>(std::min<Uint64>(Req.Data.size() - Req.BytesRead, MaxReadSize));
+        m_pIoUring->PrepareRead(Req.fd, Req.Data.data() + Req.BytesRead, Size, Req.BytesRead, Index);
+    }
+}
+
+void AsyncFileReader::ProcessCompletions()
+{
+    Uint64 UserData = 0;
+    Int32  Result   = 0;
+    while (m_pIoUring->PopCompletion(UserData, Result))
+    {
+        auto& Req = m_Requests[static_cast<size_t>(UserData)];
+        if (Result == -EINTR || Result == -EAGAIN)
+        {
+            m_ReadQueue.push_back(static_cast<Uint32>(UserData));
+        }
+        else if (Result == -EINVAL || Result == -EOPNOTSUPP)
+        {
+            // IORING_OP_READ requires Linux 5.6
+            const ssize_t Read = pread(Req.fd, Req.Data.data() + Req.BytesRead, Req.Data.size() - Req.BytesRead, static_cast<off_t>(Req.BytesRead));
+            Req.BytesRead += static_cast<Uint64>(std::max<ssize_t>(Read, 0));
+            Req.Data.resize(static_cast<size_t>(Req.BytesRead));
+            CompleteRequest(Req, Read >= 0 ? STATUS::Complete : STATUS::Failed);
+        }
+        else if (Result < 0)
+        {
+            LOG_ERROR_MESSAGE("Failed to read '", Req.Path, "': ", strerror(-Result));
+            CompleteRequest(Req, STATUS::Failed);
+        }
+        else
+        {
+            Req.BytesRead += static_cast<Uint64>(Result);
+            if (Result == 0 || Req.BytesRead == Req.Data.size())
+            {
+                // A zero-byte read means the file was truncated after it was opened
+                Req.Data.resize(static_cast<size_t>(Req.BytesRead));
+                CompleteRequest(Req, STATUS::Complete);
+            }
+            else
+            {
+                // Short read
+                m_ReadQueue.push_back(static_cast<Uint32>(UserData));
+            }
+        }
+    }
+}
+
+#else
+
+void AsyncFileReader::SubmitIoUring() {}
+void AsyncFileReader::FinishSynchronously() {}
+void AsyncFileReader::FillSubmissionQueue() {}
+void AsyncFileReader::ProcessCompletions() {}
+
+#endif
+
+} // namespace Diligent
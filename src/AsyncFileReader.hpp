@@ -0,0 +1,132 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "BasicTypes.h"
+#include "ThreadPool.hpp"
+
+namespace Diligent
+{
+
+// Reads a batch of files asynchronously. All reads are submitted at once, so the disk latency
+// of the files that have not arrived yet overlaps with the processing of those that have.
+// On Linux the reads are issued through io_uring. On other platforms, or when io_uring is
+// not available (older kernels, seccomp filters in containers), every file is read by
+// a task of the thread pool.
+class AsyncFileReader
+{
+public:
+    static constexpr Uint32 InvalidRequest = ~0u;
+
+    explicit AsyncFileReader(IThreadPool* pThreadPool, Uint32 QueueDepth = 64);
+    ~AsyncFileReader();
+
+    // Adds a file to the batch and returns the index of the request. Must be called before Submit().
+    Uint32 AddRequest(const char* Path);
+
+    // Starts reading all requested files
+    void Submit();
+
+    // Blocks until the file has been read. Returns false if it could not be read. Several threads
+    // may wait for different files. Must not be called from a task of the reader's thread pool,
+    // as the read may be queued behind it.
+    bool Wait(Uint32 Request);
+
+    // Blocks until a request in [FirstRequest, FirstRequest + NumRequests) that has not been returned
+    // by WaitAny() before has completed or failed, and returns its index. Requests are returned in the
+    // order they complete, so a slow file does not hold back the files that have already arrived.
+    // Returns InvalidRequest once all requests of the range have been returned. The same restrictions
+    // as for Wait() apply, and only one thread may wait for a given range.
+    Uint32 WaitAny(Uint32 FirstRequest, Uint32 NumRequests);
+
+    // Contents of a completed request, valid until Release() is called
+    const std::vector<Uint8>& GetData(Uint32 Request) const { return m_Requests[Request].Data; }
+    const std::string&        GetPath(Uint32 Request) const { return m_Requests[Request].Path; }
+
+    // Frees the contents of a completed request
+    void Release(Uint32 Request);
+
+    Uint32 GetNumRequests() const { return static_cast<Uint32>(m_Requests.size()); }
+    Uint64 GetBytesRead() const;
+    bool   IsUsingIoUring() const;
+
+private:
+    enum class STATUS
+    {
+        Pending,
+        Reading,
+        Complete,
+        Failed
+    };
+
+    struct Request
+    {
+        std::string        Path;
+        std::vector<Uint8> Data;
+        Uint64             BytesRead = 0;
+        int                fd        = -1;
+        STATUS             Status    = STATUS::Pending;
+        bool               Returned  = false; // Returned by WaitAny()
+    };
+
+    void ReadFile(Request& Req);
+
+    void SubmitIoUring();
+    void FinishSynchronously();
+    void FillSubmissionQueue();
+    void ProcessCompletions();
+    void CompleteRequest(Request& Req, STATUS Status);
+    // Must be called with m_Mtx locked
+    Uint32 PopCompletedRequest(Uint32 FirstRequest, Uint32 NumRequests);
+    bool   HasRequestsInFlight(Uint32 FirstRequest, Uint32 NumRequests) const;
+
+    RefCntAutoPtr<IThreadPool> m_pThreadPool;
+    std::vector<Request>       m_Requests;
+
+    // Thread pool path
+    std::vector<RefCntAutoPtr<IAsyncTask>> m_Tasks;
+    mutable std::mutex                     m_Mtx;
+    std::condition_variable                m_CompletedCV;
+    std::vector<Uint32>                    m_CompletionOrder; // Indices of the completed requests
+
+    // io_uring path. The rings are driven by the waiting thread; threads that wait at the same time take turns.
+    // m_pIoUring is only accessed under m_IoUringMtx once the reads have been submitted.
+    class IoUring;
+    std::unique_ptr<IoUring> m_pIoUring;
+    std::deque<Uint32>       m_ReadQueue; // Requests waiting for a submission queue entry
+    mutable std::mutex       m_IoUringMtx;
+};
+
+} // namespace Diligent
@@ -0,0 +1,182 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "BatchRender.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#include "TextureReadback.hpp"
+#include "GraphicsAccessories.hpp"
+#include "Image.h"
+#include "FileWrapper.hpp"
+
+namespace Diligent
+{
+
+bool LoadBatchCameraPoses(const char* FilePath, std::vector<BatchCameraPose>& Poses)
+{
+    std::ifstream File{FilePath};
+    if (!File)
+    {
+        LOG_ERROR_MESSAGE("Failed to open camera pose file '", FilePath, "'");
+        return false;
+    }
+
+    std::string Line;
+    size_t      LineNum = 0;
+    while (std::getline(File, Line))
+    {
+        ++LineNum;
+        if (Line.empty() || Line[0] == '#' || Line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        std::istringstream LineSS{Line};
+        BatchCameraPose    Pose;
+        float              YawDeg = 0, PitchDeg = 0;
+        if (!(LineSS >> Pose.Name >> YawDeg >> PitchDeg >> Pose.Distance >> Pose.Target.x >> Pose.Target.y >> Pose.Target.z))
+        {
+            LOG_ERROR_MESSAGE(FilePath, "(", LineNum, "): expected '<name> <yaw> <pitch> <distance> <x> <y> <z>'");
+            return false;
+        }
+        Pose.Yaw   = YawDeg * PI_F / 180.f;
+        Pose.Pitch = PitchDeg * PI_F / 180.f;
+        Poses.emplace_back(std::move(Pose));
+    }
+    return true;
+}
+
+Uint32 RunBatchRender(const BatchRenderInfo& Info, const std::vector<BatchCameraPose>& Poses, const BatchRenderViewCallback& RenderView)
+{
+    RefCntAutoPtr<ITexture> pColor;
+    RefCntAutoPtr<ITexture> pDepth;
+    {
+        TextureDesc TexDesc;
+        TexDesc.Name      = "Batch render color";
+        TexDesc.Type      = RESOURCE_DIM_TEX_2D;
+        TexDesc.Width     = Info.Width;
+        TexDesc.Height    = Info.Height;
+        TexDesc.MipLevels = 1;
+        TexDesc.Format    = Info.ColorFormat;
+        TexDesc.BindFlags = BIND_RENDER_TARGET;
+        Info.pDevice->CreateTexture(TexDesc, nullptr, &pColor);
+
+        TexDesc.Name      = "Batch render depth";
+        TexDesc.Format    = Info.DepthFormat;
+        TexDesc.BindFlags = BIND_DEPTH_STENCIL;
+        Info.pDevice->CreateTexture(TexDesc, nullptr, &pDepth);
+    }
+    if (!pColor || !pDepth)
+        return 0;
+
+    TextureReadback Readback{Info.pDevice, Info.Width, Info.Height, Info.ColorFormat, std::max(Info.ReadbackLatency, 1u)};
+
+    const bool          FlipY      = Info.pDevice->GetDeviceInfo().IsGLDevice();
+    const Uint32        RowSize    = Info.Width * GetTextureFormatAttribs(Info.ColorFormat).GetElementSize();
+    const size_t        MaxEncodes = 2 * std::max(std::thread::hardware_concurrency(), 1u);
+    std::atomic<Uint32> NumWritten{0};
+
+    std::deque<RefCntAutoPtr<IAsyncTask>> EncodeTasks;
+
+    // Copies the pixels out of the mapped staging texture and encodes them on the thread pool
+    auto OnReadbackComplete = [&](Uint64 PoseIdx, const MappedTextureSubresource& MappedData) {
+        auto pPixels = std::make_shared<std::vector<Uint8>>(size_t{RowSize} * Info.Height);
+        for (Uint32 row = 0; row < Info.Height; ++row)
+            memcpy(pPixels->data() + size_t{RowSize} * row, static_cast<const Uint8*>(MappedData.pData) + size_t{MappedData.Stride} * row, RowSize);
+
+        // Bound the number of images waiting to be encoded to keep memory usage in check
+        while (EncodeTasks.size() >= MaxEncodes)
+        {
+            EncodeTasks.front()->WaitForCompletion();
+            EncodeTasks.pop_front();
+        }
+
+        const std::string FilePath = Info.OutputDir + "/" + Poses[static_cast<size_t>(PoseIdx)].Name + ".png";
+        EncodeTasks.emplace_back(EnqueueAsyncWork(
+            Info.pThreadPool,
+            [&Info, &NumWritten, pPixels, FilePath, RowSize, FlipY](Uint32) {
+                Image::EncodeInfo EncodeInfo;
+                EncodeInfo.Width      = Info.Width;
+                EncodeInfo.Height     = Info.Height;
+                EncodeInfo.TexFormat  = Info.ColorFormat;
+                EncodeInfo.KeepAlpha  = false;
+                EncodeInfo.FlipY      = FlipY;
+                EncodeInfo.pData      = pPixels->data();
+                EncodeInfo.Stride     = RowSize;
+                EncodeInfo.FileFormat = IMAGE_FILE_FORMAT_PNG;
+
+                RefCntAutoPtr<IDataBlob> pEncodedImage;
+                Image::Encode(EncodeInfo, &pEncodedImage);
+
+                FileWrapper File{FilePath.c_str(), EFileAccessMode::Overwrite};
+                if (pEncodedImage && File && File->Write(pEncodedImage->GetDataPtr(), pEncodedImage->GetSize()))
+                    NumWritten.fetch_add(1);
+                else
+                    LOG_ERROR_MESSAGE("Failed to write '", FilePath, "'");
+                return ASYNC_TASK_STATUS_COMPLETE;
+            }));
+    };
+
+    const auto StartTime = std::chrono::high_resolution_clock::now();
+
+    ITextureView* pRTV = pColor->GetDefaultView(TEXTURE_VIEW_RENDER_TARGET);
+    ITextureView* pDSV = pDepth->GetDefaultView(TEXTURE_VIEW_DEPTH_STENCIL);
+    for (size_t i = 0; i < Poses.size(); ++i)
+    {
+        RenderView(Poses[i], pRTV, pDSV);
+
+        // Only wait for the GPU when all staging textures are in flight
+        while (!Readback.Enqueue(Info.pContext, pColor, i))
+            Readback.Poll(Info.pContext, OnReadbackComplete, /*WaitForOldest = */ true);
+
+        Info.pContext->Flush();
+        // There is no present in the loop, so release dynamic memory and stale resources explicitly
+        Info.pContext->FinishFrame();
+
+        Readback.Poll(Info.pContext, OnReadbackComplete);
+    }
+
+    while (Readback.GetNumPending() > 0)
+        Readback.Poll(Info.pContext, OnReadbackComplete, /*WaitForOldest = */ true);
+    for (auto& pTask : EncodeTasks)
+        pTask->WaitForCompletion();
+
+    const double Seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - StartTime).count();
+    LOG_INFO_MESSAGE("Batch render: ", NumWritten.load(), " of ", Poses.size(), " views written to '", Info.OutputDir, "' in ", Seconds, " s (",
+                     Seconds > 0 ? static_cast<double>(Poses.size()) / Seconds : 0.0, " views/s)");
+
+    return NumWritten.load();
+}
+
+} // namespace Diligent
@@ -0,0 +1,79 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "ThreadPool.hpp"
+#include "BasicMath.hpp"
+
+namespace Diligent
+{
+
+struct BatchCameraPose
+{
+    std::string Name;
+    float       Yaw      = 0;
+    float       Pitch    = 0;
+    float       Distance = 20;
+    float3      Target;
+};
+
+// Reads camera poses from a text file. Every non-empty line that does not start with '#' has the form
+//     <name> <yaw degrees> <pitch degrees> <distance> <target x> <target y> <target z>
+bool LoadBatchCameraPoses(const char* FilePath, std::vector<BatchCameraPose>& Poses);
+
+struct BatchRenderInfo
+{
+    IRenderDevice*  pDevice     = nullptr;
+    IDeviceContext* pContext    = nullptr;
+    IThreadPool*    pThreadPool = nullptr;
+
+    Uint32         Width       = 512;
+    Uint32         Height      = 512;
+    TEXTURE_FORMAT ColorFormat = TEX_FORMAT_RGBA8_UNORM_SRGB;
+    TEXTURE_FORMAT DepthFormat = TEX_FORMAT_D32_FLOAT;
+
+    // Number of views whose readback may be in flight before the CPU waits for the GPU
+    Uint32 ReadbackLatency = 4;
+
+    std::string OutputDir = ".";
+};
+
+// Renders the scene into the given targets for the given pose
+using BatchRenderViewCallback = std::function<void(const BatchCameraPose& Pose, ITextureView* pRTV, ITextureView* pDSV)>;
+
+// Renders every pose into an offscreen target, reads the images back asynchronously and
+// encodes them to <OutputDir>/<name>.png on the thread pool. Returns the number of written images.
+Uint32 RunBatchRender(const BatchRenderInfo& Info, const std::vector<BatchCameraPose>& Poses, const BatchRenderViewCallback& RenderView);
+
+} // namespace Diligent
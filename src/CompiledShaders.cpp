@@ -0,0 +1,113 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "CompiledShaders.hpp"
+
+#include <cstring>
+#include <string>
+
+namespace Diligent
+{
+
+namespace
+{
+
+struct CompiledShaderEntry
+{
+    const char*  Backend;
+    const char*  FilePath;
+    const char*  Macros; // NAME=VALUE pairs separated by commas, in the order they are set by the application
+    const Uint8* pByteCode;
+    size_t       ByteCodeSize;
+};
+
+#if TUTORIAL05_OFFLINE_SHADERS
+#    include "CompiledShaders.inc"
+#else
+static const CompiledShaderEntry CompiledShaders[] = {{"", "", "", nullptr, 0}};
+#endif
+
+const char* GetBackendName(RENDER_DEVICE_TYPE DeviceType)
+{
+    switch (DeviceType)
+    {
+        case RENDER_DEVICE_TYPE_VULKAN: return "vk";
+        case RENDER_DEVICE_TYPE_D3D12: return "d3d12";
+        default: return nullptr;
+    }
+}
+
+} // namespace
+
+bool FindCompiledShader(RENDER_DEVICE_TYPE      DeviceType,
+                        const char*             FilePath,
+                        const ShaderMacroArray& Macros,
+                        const void*&            pByteCode,
+                        size_t&                 ByteCodeSize)
+{
+    const char* Backend = GetBackendName(DeviceType);
+    if (Backend == nullptr)
+        return false;
+
+    std::string MacroKey;
+    for (Uint32 i = 0; i < Macros.Count; ++i)
+    {
+        if (i > 0)
+            MacroKey += ',';
+        MacroKey += Macros.Elements[i].Name;
+        MacroKey += '=';
+        MacroKey += Macros.Elements[i].Definition;
+    }
+
+    for (const auto& Entry : CompiledShaders)
+    {
+        if (Entry.pByteCode != nullptr && strcmp(Entry.Backend, Backend) == 0 &&
+            strcmp(Entry.FilePath, FilePath) == 0 && MacroKey == Entry.Macros)
+        {
+            pByteCode    = Entry.pByteCode;
+            ByteCodeSize = Entry.ByteCodeSize;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool HasCompiledShaders(RENDER_DEVICE_TYPE DeviceType)
+{
+    const char* Backend = GetBackendName(DeviceType);
+    if (Backend == nullptr)
+        return false;
+
+    for (const auto& Entry : CompiledShaders)
+    {
+        if (Entry.pByteCode != nullptr && strcmp(Entry.Backend, Backend) == 0)
+            return true;
+    }
+    return false;
+}
+
+} // namespace Diligent
@@ -0,0 +1,49 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include "GraphicsTypes.h"
+#include "Shader.h"
+
+namespace Diligent
+{
+
+// Looks up the bytecode of a shader compiled at build time (TUTORIAL05_OFFLINE_SHADERS).
+// Shaders are compiled to SPIR-V for Vulkan and to DXIL for Direct3D12 with every macro
+// permutation listed in CMakeLists.txt. Returns false if the shader was not compiled for the
+// device type and the macros, in which case it must be compiled from source at runtime.
+bool FindCompiledShader(RENDER_DEVICE_TYPE      DeviceType,
+                        const char*             FilePath,
+                        const ShaderMacroArray& Macros,
+                        const void*&            pByteCode,
+                        size_t&                 ByteCodeSize);
+
+// Returns true if any shader was compiled at build time for the device type
+bool HasCompiledShaders(RENDER_DEVICE_TYPE DeviceType);
+
+} // namespace Diligent
@@ -0,0 +1,126 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "ContextStateCache.hpp"
+
+#include <algorithm>
+
+namespace Diligent
+{
+
+void ContextStateCache::SetPipelineState(IPipelineState* pPSO)
+{
+    if (Filter(pPSO != nullptr && pPSO == m_pPSO))
+        return;
+
+    m_pContext->SetPipelineState(pPSO);
+    m_pPSO = pPSO;
+    // The resources must be committed again for the new pipeline
+    m_pSRB = nullptr;
+}
+
+void ContextStateCache::CommitShaderResources(IShaderResourceBinding* pSRB, RESOURCE_STATE_TRANSITION_MODE TransitionMode)
+{
+    if (Filter(pSRB != nullptr && pSRB == m_pSRB && TransitionMode != RESOURCE_STATE_TRANSITION_MODE_TRANSITION))
+        return;
+
+    m_pContext->CommitShaderResources(pSRB, TransitionMode);
+    m_pSRB = pSRB;
+}
+
+void ContextStateCache::SetVertexBuffers(Uint32                         StartSlot,
+                                         Uint32                         NumBuffersSet,
+                                         IBuffer* const*                ppBuffers,
+                                         const Uint64*                  pOffsets,
+                                         RESOURCE_STATE_TRANSITION_MODE TransitionMode,
+                                         SET_VERTEX_BUFFERS_FLAGS       Flags)
+{
+    const bool Reset = (Flags & SET_VERTEX_BUFFERS_FLAG_RESET) != 0;
+    const bool Cacheable =
+        TransitionMode != RESOURCE_STATE_TRANSITION_MODE_TRANSITION && StartSlot + NumBuffersSet <= MaxCachedVertexBuffers;
+
+    bool IsRedundant = Cacheable && m_VertexBuffersValid;
+    if (IsRedundant)
+    {
+        // With the reset flag, slots outside of the range must be empty as well
+        IsRedundant = Reset ? (StartSlot == 0 && NumBuffersSet == m_NumVertexBuffers) : StartSlot + NumBuffersSet <= m_NumVertexBuffers;
+    }
+    for (Uint32 i = 0; i < NumBuffersSet && IsRedundant; ++i)
+    {
+        const Uint64 Offset = pOffsets != nullptr ? pOffsets[i] : 0;
+        IsRedundant         = m_pVertexBuffers[StartSlot + i] == ppBuffers[i] && m_VertexOffsets[StartSlot + i] == Offset;
+    }
+    if (Filter(IsRedundant))
+        return;
+
+    m_pContext->SetVertexBuffers(StartSlot, NumBuffersSet, ppBuffers, pOffsets, TransitionMode, Flags);
+
+    // Only track bindings that start from an empty or fully known state
+    m_VertexBuffersValid = Cacheable && (Reset || m_VertexBuffersValid);
+    if (!m_VertexBuffersValid)
+        return;
+
+    if (Reset)
+        m_NumVertexBuffers = 0;
+    for (Uint32 i = m_NumVertexBuffers; i < StartSlot; ++i)
+    {
+        m_pVertexBuffers[i] = nullptr;
+        m_VertexOffsets[i]  = 0;
+    }
+    for (Uint32 i = 0; i < NumBuffersSet; ++i)
+    {
+        m_pVertexBuffers[StartSlot + i] = ppBuffers[i];
+        m_VertexOffsets[StartSlot + i]  = pOffsets != nullptr ? pOffsets[i] : 0;
+    }
+    m_NumVertexBuffers = std::max(m_NumVertexBuffers, StartSlot + NumBuffersSet);
+}
+
+void ContextStateCache::SetIndexBuffer(IBuffer* pIndexBuffer, Uint64 ByteOffset, RESOURCE_STATE_TRANSITION_MODE TransitionMode)
+{
+    const bool IsRedundant = TransitionMode != RESOURCE_STATE_TRANSITION_MODE_TRANSITION && m_IndexBufferValid &&
+        m_pIndexBuffer == pIndexBuffer && m_IndexOffset == ByteOffset;
+    if (Filter(IsRedundant))
+        return;
+
+    m_pContext->SetIndexBuffer(pIndexBuffer, ByteOffset, TransitionMode);
+    m_pIndexBuffer     = pIndexBuffer;
+    m_IndexOffset      = ByteOffset;
+    m_IndexBufferValid = true;
+}
+
+void ContextStateCache::Invalidate()
+{
+    m_pPSO               = nullptr;
+    m_pSRB               = nullptr;
+    m_pIndexBuffer       = nullptr;
+    m_IndexOffset        = 0;
+    m_IndexBufferValid   = false;
+    m_NumVertexBuffers   = 0;
+    m_VertexBuffersValid = false;
+}
+
+} // namespace Diligent
@@ -0,0 +1,112 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include "DeviceContext.h"
+#include "PipelineState.h"
+#include "ShaderResourceBinding.h"
+
+namespace Diligent
+{
+
+// Thin layer in front of a device context that drops binding calls which would set the state
+// that is already bound. The cache only knows about calls made through it, so it must be
+// invalidated whenever the context is used directly (e.g. by the UI or at the start of a
+// command list), and after variables of a committed SRB have been changed.
+class ContextStateCache
+{
+public:
+    struct Stats
+    {
+        Uint32 NumIssued   = 0;
+        Uint32 NumFiltered = 0;
+    };
+
+    explicit ContextStateCache(IDeviceContext* pContext = nullptr) :
+        m_pContext{pContext}
+    {}
+
+    void SetContext(IDeviceContext* pContext)
+    {
+        m_pContext = pContext;
+        Invalidate();
+    }
+
+    IDeviceContext* GetContext() const { return m_pContext; }
+
+    void SetPipelineState(IPipelineState* pPSO);
+
+    // Commits that request state transitions are always forwarded, as resource
+    // states may have changed since the previous commit.
+    void CommitShaderResources(IShaderResourceBinding* pSRB, RESOURCE_STATE_TRANSITION_MODE TransitionMode);
+
+    void SetVertexBuffers(Uint32                         StartSlot,
+                          Uint32                         NumBuffersSet,
+                          IBuffer* const*                ppBuffers,
+                          const Uint64*                  pOffsets,
+                          RESOURCE_STATE_TRANSITION_MODE TransitionMode,
+                          SET_VERTEX_BUFFERS_FLAGS       Flags);
+
+    void SetIndexBuffer(IBuffer* pIndexBuffer, Uint64 ByteOffset, RESOURCE_STATE_TRANSITION_MODE TransitionMode);
+
+    // Forgets all bindings; the next call of every kind is forwarded to the context.
+    void Invalidate();
+
+    const Stats& GetStats() const { return m_Stats; }
+    void         ResetStats() { m_Stats = {}; }
+
+private:
+    bool Filter(bool IsRedundant)
+    {
+        if (IsRedundant)
+            ++m_Stats.NumFiltered;
+        else
+            ++m_Stats.NumIssued;
+        return IsRedundant;
+    }
+
+    static constexpr Uint32 MaxCachedVertexBuffers = 8;
+
+    IDeviceContext* m_pContext = nullptr;
+
+    // Cached objects are only compared, never dereferenced
+    IPipelineState*         m_pPSO         = nullptr;
+    IShaderResourceBinding* m_pSRB         = nullptr;
+    IBuffer*                m_pIndexBuffer     = nullptr;
+    Uint64                  m_IndexOffset      = 0;
+    bool                    m_IndexBufferValid = false;
+
+    IBuffer* m_pVertexBuffers[MaxCachedVertexBuffers] = {};
+    Uint64   m_VertexOffsets[MaxCachedVertexBuffers]  = {};
+    Uint32   m_NumVertexBuffers                       = 0;
+    bool     m_VertexBuffersValid                     = false;
+
+    Stats m_Stats;
+};
+
+} // namespace Diligent
@@ -0,0 +1,83 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "DynamicUniformRing.hpp"
+
+#include <algorithm>
+
+#include "Align.hpp"
+
+namespace Diligent
+{
+
+DynamicUniformRing::DynamicUniformRing(IRenderDevice* pDevice, IBuffer* pBuffer) :
+    m_pBuffer{pBuffer},
+    m_Size{static_cast<Uint32>(pBuffer->GetDesc().Size)},
+    m_Alignment{std::max(pDevice->GetAdapterInfo().Buffer.ConstantBufferOffsetAlignment, 16u)}
+{
+    VERIFY(pBuffer->GetDesc().Usage == USAGE_DYNAMIC, "The ring must use a dynamic buffer");
+}
+
+void DynamicUniformRing::Begin(IDeviceContext* pContext)
+{
+    VERIFY(m_pData == nullptr, "The ring is already mapped");
+
+    void* pData = nullptr;
+    pContext->MapBuffer(m_pBuffer, MAP_WRITE, MAP_FLAG_DISCARD, pData);
+    m_pContext  = pContext;
+    m_pData     = static_cast<Uint8*>(pData);
+    m_UsedSize  = 0;
+    m_NumBlocks = 0;
+}
+
+void DynamicUniformRing::End()
+{
+    // Draws must not be issued while the buffer is mapped on some backends (e.g. OpenGL)
+    VERIFY(m_pData != nullptr, "The ring is not mapped");
+    m_pContext->UnmapBuffer(m_pBuffer, MAP_WRITE);
+    m_pContext = nullptr;
+    m_pData    = nullptr;
+}
+
+void* DynamicUniformRing::Allocate(Uint32 Size, Uint32& Offset)
+{
+    VERIFY(m_pData != nullptr, "Blocks can only be allocated between Begin() and End()");
+
+    const Uint32 Start = AlignUp(m_UsedSize, m_Alignment);
+    if (Start + Size > m_Size)
+    {
+        LOG_ERROR_MESSAGE("Dynamic uniform ring is full: ", m_NumBlocks, " blocks, ", m_Size, " bytes");
+        return nullptr;
+    }
+
+    Offset     = Start;
+    m_UsedSize = Start + Size;
+    ++m_NumBlocks;
+    return m_pData + Start;
+}
+
+} // namespace Diligent
@@ -0,0 +1,78 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "Buffer.h"
+#include "RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+// Per-frame suballocator for constant blocks. The dynamic buffer is mapped once with
+// MAP_FLAG_DISCARD, blocks are handed out at offsets aligned to the constant buffer offset
+// alignment, and draws select their block with IShaderResourceVariable::SetBufferOffset().
+// Dynamic buffer contents are local to a context, so every context needs its own ring;
+// all rings may share the same buffer.
+class DynamicUniformRing
+{
+public:
+    DynamicUniformRing() = default;
+    DynamicUniformRing(IRenderDevice* pDevice, IBuffer* pBuffer);
+
+    // Maps the buffer. All blocks of the frame must be allocated before End() is called.
+    void Begin(IDeviceContext* pContext);
+    void End();
+
+    // Returns a pointer to the block and its offset in the buffer, or null if the ring is full.
+    void* Allocate(Uint32 Size, Uint32& Offset);
+
+    template <typename BlockType>
+    BlockType* Allocate(Uint32& Offset)
+    {
+        return static_cast<BlockType*>(Allocate(sizeof(BlockType), Offset));
+    }
+
+    IBuffer* GetBuffer() const { return m_pBuffer; }
+
+    Uint32 GetUsedSize() const { return m_UsedSize; }
+    Uint32 GetNumBlocks() const { return m_NumBlocks; }
+
+private:
+    RefCntAutoPtr<IBuffer> m_pBuffer;
+    Uint32                 m_Size      = 0;
+    Uint32                 m_Alignment = 1;
+
+    IDeviceContext* m_pContext  = nullptr;
+    Uint8*          m_pData     = nullptr;
+    Uint32          m_UsedSize  = 0;
+    Uint32          m_NumBlocks = 0;
+};
+
+} // namespace Diligent
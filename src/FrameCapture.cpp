@@ -0,0 +1,283 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "FrameCapture.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "GraphicsAccessories.hpp"
+#include "Image.h"
+#include "FileWrapper.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+bool IsBGRAFormat(TEXTURE_FORMAT Format)
+{
+    return Format == TEX_FORMAT_BGRA8_UNORM || Format == TEX_FORMAT_BGRA8_UNORM_SRGB;
+}
+
+bool IsSupportedFormat(TEXTURE_FORMAT Format)
+{
+    return Format == TEX_FORMAT_RGBA8_UNORM || Format == TEX_FORMAT_RGBA8_UNORM_SRGB || IsBGRAFormat(Format);
+}
+
+} // namespace
+
+std::unique_ptr<FrameCapture> FrameCapture::Create(const CreateInfo& CI)
+{
+    if (!IsSupportedFormat(CI.Format))
+    {
+        LOG_ERROR_MESSAGE("Frame capture does not support ", GetTextureFormatAttribs(CI.Format).Name, " format");
+        return {};
+    }
+
+    FILE* pFile = nullptr;
+    if (CI.FileFormat != FILE_FORMAT::PNG)
+    {
+        pFile = fopen(CI.OutputPath.c_str(), "wb");
+        if (pFile == nullptr)
+        {
+            LOG_ERROR_MESSAGE("Failed to open capture file '", CI.OutputPath, "'");
+            return {};
+        }
+        if (CI.FileFormat == FILE_FORMAT::Y4M)
+            fprintf(pFile, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C444\n", CI.Width, CI.Height, CI.FrameRate);
+    }
+
+    return std::unique_ptr<FrameCapture>{new FrameCapture{CI, pFile}};
+}
+
+FrameCapture::FrameCapture(const CreateInfo& CI, FILE* pFile) :
+    m_CI{CI},
+    m_IsBGRA{IsBGRAFormat(CI.Format)},
+    m_FlipY{CI.pDevice->GetDeviceInfo().IsGLDevice()},
+    m_pFile{pFile},
+    m_Readback{CI.pDevice, CI.Width, CI.Height, CI.Format, CI.NumStagingTextures},
+    m_WriterThread{&FrameCapture::WriterThreadFunc, this}
+{
+}
+
+FrameCapture::~FrameCapture()
+{
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        m_Stop = true;
+    }
+    m_CondVar.notify_one();
+    m_WriterThread.join();
+
+    if (m_pFile != nullptr)
+        fclose(m_pFile);
+}
+
+void FrameCapture::CaptureFrame(IDeviceContext* pContext, ITexture* pSrcTexture, RESOURCE_STATE_TRANSITION_MODE SrcTransitionMode)
+{
+    // Map the copies that have completed since the last frame
+    m_Readback.Poll(pContext, [this](Uint64 FrameIdx, const MappedTextureSubresource& MappedData) {
+        OnReadbackComplete(FrameIdx, MappedData);
+    });
+
+    if (m_Readback.Enqueue(pContext, pSrcTexture, m_NextFrameIdx, SrcTransitionMode))
+    {
+        ++m_NextFrameIdx;
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        ++m_Stats.NumCaptured;
+    }
+    else
+    {
+        // All staging textures are still in flight: drop the frame rather than wait for the GPU
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        ++m_Stats.NumDropped;
+    }
+}
+
+void FrameCapture::Finish(IDeviceContext* pContext)
+{
+    while (m_Readback.GetNumPending() > 0)
+    {
+        m_Readback.Poll(
+            pContext,
+            [this](Uint64 FrameIdx, const MappedTextureSubresource& MappedData) {
+                OnReadbackComplete(FrameIdx, MappedData);
+            },
+            /*WaitForOldest = */ true);
+    }
+
+    // Let the writer drain the queue. The last frame is popped before it is written, so
+    // an empty queue does not mean that the writer is done.
+    std::unique_lock<std::mutex> Lock{m_Mtx};
+    m_CondVar.wait(Lock, [this] { return m_Queue.empty() && !m_IsWriting; });
+    // The writer is idle, so the stream can be flushed from this thread
+    if (m_pFile != nullptr)
+        fflush(m_pFile);
+}
+
+FrameCapture::Stats FrameCapture::GetStats() const
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    return m_Stats;
+}
+
+void FrameCapture::OnReadbackComplete(Uint64 FrameIdx, const MappedTextureSubresource& MappedData)
+{
+    const size_t RowSize = size_t{m_CI.Width} * 4;
+
+    Frame Frm;
+    Frm.Index = FrameIdx;
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        if (m_Queue.size() >= m_CI.MaxQueuedFrames)
+        {
+            // The writer cannot keep up
+            ++m_Stats.NumDropped;
+            return;
+        }
+        if (!m_FreeBuffers.empty())
+        {
+            Frm.Pixels = std::move(m_FreeBuffers.back());
+            m_FreeBuffers.pop_back();
+        }
+    }
+
+    // Only copy the rows out of the mapped memory here; conversion is done by the writer
+    Frm.Pixels.resize(RowSize * m_CI.Height);
+    for (Uint32 row = 0; row < m_CI.Height; ++row)
+    {
+        const Uint32 SrcRow = m_FlipY ? m_CI.Height - 1 - row : row;
+        memcpy(&Frm.Pixels[RowSize * row], static_cast<const Uint8*>(MappedData.pData) + size_t{MappedData.Stride} * SrcRow, RowSize);
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        m_Queue.emplace_back(std::move(Frm));
+    }
+    m_CondVar.notify_all();
+}
+
+void FrameCapture::WriterThreadFunc()
+{
+    std::unique_lock<std::mutex> Lock{m_Mtx};
+    for (;;)
+    {
+        m_CondVar.wait(Lock, [this] { return m_Stop || !m_Queue.empty(); });
+        if (m_Queue.empty())
+            break; // Stop was requested and all frames are written
+
+        Frame Frm = std::move(m_Queue.front());
+        m_Queue.pop_front();
+        m_IsWriting = true;
+
+        Lock.unlock();
+        WriteFrame(Frm);
+        Lock.lock();
+
+        m_IsWriting = false;
+        ++m_Stats.NumWritten;
+        m_FreeBuffers.emplace_back(std::move(Frm.Pixels));
+        // Wake up Finish() if it waits for the queue to drain
+        m_CondVar.notify_all();
+    }
+}
+
+void FrameCapture::WriteFrame(const Frame& Frm)
+{
+    const size_t NumPixels = size_t{m_CI.Width} * m_CI.Height;
+    const Uint8* pPixels   = Frm.Pixels.data();
+
+    // Channel offsets of red and blue in the source pixels
+    const size_t R = m_IsBGRA ? 2 : 0;
+    const size_t B = m_IsBGRA ? 0 : 2;
+
+    switch (m_CI.FileFormat)
+    {
+        case FILE_FORMAT::Y4M:
+        {
+            // Full-range BT.601 conversion of the gamma-encoded color, one plane per component
+            m_ConvertBuffer.resize(NumPixels * 3);
+            Uint8* pY = m_ConvertBuffer.data();
+            Uint8* pU = pY + NumPixels;
+            Uint8* pV = pU + NumPixels;
+            for (size_t i = 0; i < NumPixels; ++i)
+            {
+                const float r = pPixels[i * 4 + R];
+                const float g = pPixels[i * 4 + 1];
+                const float b = pPixels[i * 4 + B];
+
+                pY[i] = static_cast<Uint8>(std::min(std::max(0.299f * r + 0.587f * g + 0.114f * b + 0.5f, 0.f), 255.f));
+                pU[i] = static_cast<Uint8>(std::min(std::max(-0.168736f * r - 0.331264f * g + 0.5f * b + 128.5f, 0.f), 255.f));
+                pV[i] = static_cast<Uint8>(std::min(std::max(0.5f * r - 0.418688f * g - 0.081312f * b + 128.5f, 0.f), 255.f));
+            }
+            fputs("FRAME\n", m_pFile);
+            fwrite(m_ConvertBuffer.data(), 1, m_ConvertBuffer.size(), m_pFile);
+            break;
+        }
+
+        case FILE_FORMAT::Raw:
+        {
+            if (m_IsBGRA)
+            {
+                m_ConvertBuffer.assign(Frm.Pixels.begin(), Frm.Pixels.end());
+                for (size_t i = 0; i < NumPixels; ++i)
+                    std::swap(m_ConvertBuffer[i * 4 + 0], m_ConvertBuffer[i * 4 + 2]);
+                pPixels = m_ConvertBuffer.data();
+            }
+            fwrite(pPixels, 1, NumPixels * 4, m_pFile);
+            break;
+        }
+
+        case FILE_FORMAT::PNG:
+        {
+            Image::EncodeInfo EncodeInfo;
+            EncodeInfo.Width      = m_CI.Width;
+            EncodeInfo.Height     = m_CI.Height;
+            EncodeInfo.TexFormat  = m_CI.Format;
+            EncodeInfo.KeepAlpha  = false;
+            EncodeInfo.pData      = pPixels;
+            EncodeInfo.Stride     = m_CI.Width * 4;
+            EncodeInfo.FileFormat = IMAGE_FILE_FORMAT_PNG;
+
+            RefCntAutoPtr<IDataBlob> pEncodedImage;
+            Image::Encode(EncodeInfo, &pEncodedImage);
+
+            char FileName[32];
+            snprintf(FileName, sizeof(FileName), "/frame_%06llu.png", static_cast<unsigned long long>(Frm.Index));
+            const std::string FilePath = m_CI.OutputPath + FileName;
+
+            FileWrapper File{FilePath.c_str(), EFileAccessMode::Overwrite};
+            if (!pEncodedImage || !File || !File->Write(pEncodedImage->GetDataPtr(), pEncodedImage->GetSize()))
+                LOG_ERROR_MESSAGE("Failed to write '", FilePath, "'");
+            break;
+        }
+    }
+}
+
+} // namespace Diligent
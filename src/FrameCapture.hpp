@@ -0,0 +1,140 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "TextureReadback.hpp"
+
+namespace Diligent
+{
+
+// Records rendered frames to disk without stalling the frame being captured. The back buffer
+// is copied into a small pool of staging textures, the staging textures are mapped a few frames
+// later once their fence has completed, and a background thread converts and writes the frames.
+// If the writer falls behind, frames are dropped instead of blocking the render thread.
+class FrameCapture
+{
+public:
+    enum class FILE_FORMAT : int
+    {
+        // YUV4MPEG2 stream with 4:4:4 chroma, playable by ffplay/mpv and accepted by ffmpeg
+        Y4M,
+        // Headerless stream of RGBA8 frames
+        Raw,
+        // One PNG file per frame
+        PNG
+    };
+
+    struct CreateInfo
+    {
+        IRenderDevice* pDevice = nullptr;
+
+        Uint32         Width  = 0;
+        Uint32         Height = 0;
+        TEXTURE_FORMAT Format = TEX_FORMAT_UNKNOWN;
+
+        FILE_FORMAT FileFormat = FILE_FORMAT::Y4M;
+        // Output file for Y4M and raw formats, output directory for PNG
+        std::string OutputPath;
+        Uint32      FrameRate = 60;
+
+        // Number of frames whose copies may be in flight on the GPU
+        Uint32 NumStagingTextures = 3;
+        // Maximum number of frames waiting for the writer thread
+        Uint32 MaxQueuedFrames = 8;
+    };
+
+    struct Stats
+    {
+        Uint32 NumCaptured = 0;
+        Uint32 NumWritten  = 0;
+        Uint32 NumDropped  = 0;
+    };
+
+    // Returns null if the format is not supported or the output cannot be opened.
+    static std::unique_ptr<FrameCapture> Create(const CreateInfo& CI);
+
+    ~FrameCapture();
+
+    // Records a copy of the texture and processes completed copies. Never waits for the GPU.
+    void CaptureFrame(IDeviceContext*                pContext,
+                      ITexture*                      pSrcTexture,
+                      RESOURCE_STATE_TRANSITION_MODE SrcTransitionMode = RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    // Waits for the pending copies and writes all queued frames.
+    void Finish(IDeviceContext* pContext);
+
+    Stats GetStats() const;
+
+    const CreateInfo& GetCreateInfo() const { return m_CI; }
+
+private:
+    FrameCapture(const CreateInfo& CI, FILE* pFile);
+
+    struct Frame
+    {
+        Uint64             Index = 0;
+        std::vector<Uint8> Pixels; // Tightly packed RGBA8
+    };
+
+    void OnReadbackComplete(Uint64 FrameIdx, const MappedTextureSubresource& MappedData);
+    void WriterThreadFunc();
+    void WriteFrame(const Frame& Frm);
+
+    const CreateInfo m_CI;
+    const bool       m_IsBGRA;
+    const bool       m_FlipY;
+    FILE* const      m_pFile;
+
+    TextureReadback m_Readback;
+    Uint64          m_NextFrameIdx = 0;
+
+    mutable std::mutex      m_Mtx;
+    std::condition_variable m_CondVar;
+    std::deque<Frame>       m_Queue;
+    // Frame buffers are recycled to avoid allocations in the steady state
+    std::vector<std::vector<Uint8>> m_FreeBuffers;
+    bool                            m_Stop      = false;
+    bool                            m_IsWriting = false; // A popped frame is being written
+    Stats                           m_Stats;
+
+    std::vector<Uint8> m_ConvertBuffer; // Writer thread only
+    std::thread        m_WriterThread;
+};
+
+} // namespace Diligent
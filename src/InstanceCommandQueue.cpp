@@ -0,0 +1,97 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "InstanceCommandQueue.hpp"
+
+namespace Diligent
+{
+
+InstanceProducer* InstanceCommandHub::RegisterProducer(Uint32 MaxObjects)
+{
+    std::lock_guard<std::mutex> Lock{m_RegisterMtx};
+
+    const Uint32 Idx = m_NumProducers.load(std::memory_order_relaxed);
+    if (Idx >= MaxProducers)
+        return nullptr;
+
+    m_Producers[Idx] = std::make_unique<InstanceProducer>(MaxObjects);
+    // Publish the producer to the render thread only after it has been fully constructed
+    m_NumProducers.store(Idx + 1, std::memory_order_release);
+    return m_Producers[Idx].get();
+}
+
+InstanceCommandHub::DrainStats InstanceCommandHub::Drain(InstanceManager& Instances, Uint32 MaxCommandsPerProducer)
+{
+    DrainStats Stats;
+
+    const Uint32 NumProducers = m_NumProducers.load(std::memory_order_acquire);
+    for (Uint32 p = 0; p < NumProducers; ++p)
+    {
+        auto& Producer = *m_Producers[p];
+        auto& Handles  = Producer.m_Handles;
+
+        const Uint32 NumDroppedBefore = Stats.NumDropped;
+        const Uint32 NumConsumed      = Producer.m_Queue.Consume(
+            [&](const InstanceCommand& Cmd) //
+            {
+                if (Cmd.LocalId >= Handles.size())
+                {
+                    ++Stats.NumDropped;
+                    return;
+                }
+
+                auto& Handle = Handles[Cmd.LocalId];
+                switch (Cmd.Type)
+                {
+                    case InstanceCommand::TYPE::Create:
+                        // Creating an id that is already alive replaces the instance
+                        Instances.Remove(Handle);
+                        Handle = Instances.Add(Cmd.Data);
+                        if (!Handle.IsValid())
+                            ++Stats.NumDropped;
+                        break;
+
+                    case InstanceCommand::TYPE::Update:
+                        if (!Instances.Update(Handle, Cmd.Data))
+                            ++Stats.NumDropped;
+                        break;
+
+                    case InstanceCommand::TYPE::Destroy:
+                        if (!Instances.Remove(Handle))
+                            ++Stats.NumDropped;
+                        Handle = {};
+                        break;
+                }
+            },
+            MaxCommandsPerProducer);
+        Stats.NumApplied += NumConsumed - (Stats.NumDropped - NumDroppedBefore);
+    }
+
+    return Stats;
+}
+
+} // namespace Diligent
@@ -0,0 +1,165 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "InstanceManager.hpp"
+
+namespace Diligent
+{
+
+// Bounded single-producer/single-consumer ring buffer. Capacity must be a power of two.
+template <typename T, Uint32 Capacity>
+class SPSCQueue
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Producer side. Pushes up to Count items and publishes them at once.
+    // Returns the number of items pushed.
+    Uint32 TryPush(const T* pItems, Uint32 Count)
+    {
+        const Uint32 Tail = m_Tail.load(std::memory_order_relaxed);
+        const Uint32 Head = m_Head.load(std::memory_order_acquire);
+
+        const Uint32 NumToPush = std::min(Count, Capacity - (Tail - Head));
+        for (Uint32 i = 0; i < NumToPush; ++i)
+            m_Items[(Tail + i) & (Capacity - 1)] = pItems[i];
+
+        m_Tail.store(Tail + NumToPush, std::memory_order_release);
+        return NumToPush;
+    }
+
+    bool TryPush(const T& Item) { return TryPush(&Item, 1) == 1; }
+
+    // Consumer side. Calls Handler for at most MaxCount items and returns the number of consumed items.
+    template <typename HandlerType>
+    Uint32 Consume(HandlerType&& Handler, Uint32 MaxCount = ~0u)
+    {
+        const Uint32 Head = m_Head.load(std::memory_order_relaxed);
+        const Uint32 Tail = m_Tail.load(std::memory_order_acquire);
+
+        const Uint32 NumToPop = std::min(Tail - Head, MaxCount);
+        for (Uint32 i = 0; i < NumToPop; ++i)
+            Handler(m_Items[(Head + i) & (Capacity - 1)]);
+
+        m_Head.store(Head + NumToPop, std::memory_order_release);
+        return NumToPop;
+    }
+
+private:
+    // Keep the indices on separate cache lines to avoid false sharing between the threads
+    alignas(64) std::atomic<Uint32> m_Head{0};
+    alignas(64) std::atomic<Uint32> m_Tail{0};
+    alignas(64) std::array<T, Capacity> m_Items;
+};
+
+struct InstanceCommand
+{
+    enum class TYPE : Uint8
+    {
+        Create,
+        Update,
+        Destroy
+    };
+
+    TYPE         Type    = TYPE::Update;
+    Uint32       LocalId = 0;
+    InstanceData Data;
+};
+
+class InstanceCommandHub;
+
+// Command queue owned by a single producer thread. Objects are identified by producer-local
+// ids in [0, MaxObjects); the render thread maps them to instance handles, so producers
+// never need to wait for a handle to be returned.
+class InstanceProducer
+{
+public:
+    static constexpr Uint32 QueueSize = 4096;
+
+    explicit InstanceProducer(Uint32 MaxObjects) :
+        m_Handles(MaxObjects)
+    {}
+
+    // All methods return false when the queue is full; the producer may retry next frame.
+    bool Create(Uint32 LocalId, const InstanceData& Data) { return Push({InstanceCommand::TYPE::Create, LocalId, Data}); }
+    bool Update(Uint32 LocalId, const InstanceData& Data) { return Push({InstanceCommand::TYPE::Update, LocalId, Data}); }
+    bool Destroy(Uint32 LocalId) { return Push({InstanceCommand::TYPE::Destroy, LocalId, {}}); }
+
+    // Submits a batch of commands with a single publish. Returns the number of submitted commands.
+    Uint32 Submit(const InstanceCommand* pCommands, Uint32 Count) { return m_Queue.TryPush(pCommands, Count); }
+
+    Uint32 GetMaxObjects() const { return static_cast<Uint32>(m_Handles.size()); }
+
+private:
+    friend class InstanceCommandHub;
+
+    bool Push(const InstanceCommand& Cmd) { return m_Queue.TryPush(Cmd); }
+
+    SPSCQueue<InstanceCommand, QueueSize> m_Queue;
+
+    // Accessed by the render thread only
+    std::vector<InstanceHandle> m_Handles;
+};
+
+// Collects per-thread producer queues and applies their commands to the instance manager on
+// the render thread. Registration takes a lock, but draining is lock-free.
+class InstanceCommandHub
+{
+public:
+    static constexpr Uint32 MaxProducers = 16;
+
+    // Thread-safe. Returns null if the producer limit has been reached.
+    // The producer remains valid for the lifetime of the hub.
+    InstanceProducer* RegisterProducer(Uint32 MaxObjects);
+
+    struct DrainStats
+    {
+        // Commands that changed the instances
+        Uint32 NumApplied = 0;
+        // Commands referring to unknown ids or failing because the manager is full
+        Uint32 NumDropped = 0;
+    };
+
+    // Render thread only. Applies up to MaxCommandsPerProducer pending commands of every producer.
+    DrainStats Drain(InstanceManager& Instances, Uint32 MaxCommandsPerProducer = InstanceProducer::QueueSize);
+
+private:
+    std::mutex                                                  m_RegisterMtx;
+    std::array<std::unique_ptr<InstanceProducer>, MaxProducers> m_Producers;
+    std::atomic<Uint32>                                         m_NumProducers{0};
+};
+
+} // namespace Diligent
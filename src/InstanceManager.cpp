@@ -0,0 +1,220 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "InstanceManager.hpp"
+
+#include <algorithm>
+
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+InstanceManager::InstanceManager(Uint32 Capacity) :
+    m_Slots(Capacity),
+    m_Dense(Capacity),
+    m_DenseToSlot(Capacity)
+{
+    Clear();
+}
+
+void InstanceManager::Clear()
+{
+    // Chain all slots into the free list. Generations are preserved so that
+    // handles obtained before Clear() remain stale.
+    const auto Capacity = GetCapacity();
+    for (Uint32 i = 0; i < Capacity; ++i)
+    {
+        auto& Slot = m_Slots[i];
+        if (Slot.Alive)
+            ++Slot.Generation;
+        Slot.Alive           = false;
+        Slot.DenseOrNextFree = i + 1 < Capacity ? i + 1 : InstanceHandle::InvalidIndex;
+    }
+    m_FirstFree      = Capacity > 0 ? 0 : InstanceHandle::InvalidIndex;
+    m_Count          = 0;
+    m_DirtyRanges.Clear();
+}
+
+Uint32 InstanceManager::GetDenseIndex(InstanceHandle Handle) const
+{
+    if (Handle.Index >= m_Slots.size())
+        return InstanceHandle::InvalidIndex;
+
+    const auto& Slot = m_Slots[Handle.Index];
+    return Slot.Alive && Slot.Generation == Handle.Generation ? Slot.DenseOrNextFree : InstanceHandle::InvalidIndex;
+}
+
+InstanceHandle InstanceManager::Add(const InstanceData& Data)
+{
+    if (m_FirstFree == InstanceHandle::InvalidIndex)
+        return {};
+
+    const Uint32 SlotIdx = m_FirstFree;
+    auto&        Slot    = m_Slots[SlotIdx];
+    m_FirstFree          = Slot.DenseOrNextFree;
+
+    const Uint32 DenseIdx   = m_Count++;
+    Slot.DenseOrNextFree    = DenseIdx;
+    Slot.Alive              = true;
+    m_Dense[DenseIdx]       = Data;
+    m_DenseToSlot[DenseIdx] = SlotIdx;
+    m_DirtyRanges.MarkDirty(DenseIdx);
+
+    return {SlotIdx, Slot.Generation};
+}
+
+bool InstanceManager::Remove(InstanceHandle Handle)
+{
+    const Uint32 DenseIdx = GetDenseIndex(Handle);
+    if (DenseIdx == InstanceHandle::InvalidIndex)
+        return false;
+
+    // Move the last instance into the hole to keep the array dense
+    const Uint32 LastIdx = --m_Count;
+    if (DenseIdx != LastIdx)
+    {
+        const Uint32 MovedSlot             = m_DenseToSlot[LastIdx];
+        m_Dense[DenseIdx]                  = m_Dense[LastIdx];
+        m_DenseToSlot[DenseIdx]            = MovedSlot;
+        m_Slots[MovedSlot].DenseOrNextFree = DenseIdx;
+        m_DirtyRanges.MarkDirty(DenseIdx);
+    }
+
+    auto& Slot = m_Slots[Handle.Index];
+    ++Slot.Generation;
+    Slot.Alive           = false;
+    Slot.DenseOrNextFree = m_FirstFree;
+    m_FirstFree          = Handle.Index;
+
+    return true;
+}
+
+bool InstanceManager::Update(InstanceHandle Handle, const InstanceData& Data)
+{
+    const Uint32 DenseIdx = GetDenseIndex(Handle);
+    if (DenseIdx == InstanceHandle::InvalidIndex)
+        return false;
+
+    m_Dense[DenseIdx] = Data;
+    m_DirtyRanges.MarkDirty(DenseIdx);
+    return true;
+}
+
+const InstanceData* InstanceManager::Get(InstanceHandle Handle) const
+{
+    const Uint32 DenseIdx = GetDenseIndex(Handle);
+    return DenseIdx != InstanceHandle::InvalidIndex ? &m_Dense[DenseIdx] : nullptr;
+}
+
+Uint64 InstanceManager::FlushDirty(UploadManager& Uploads, IBuffer* pInstanceBuffer)
+{
+    Uint64 UploadedSize = 0;
+    m_DirtyRanges.Flush([&](const DirtyRangeList::Range& Range) {
+        // Elements past the live count were removed and will not be drawn
+        const Uint32 End = std::min(Range.End, m_Count);
+        if (Range.Begin >= End)
+            return true;
+
+        const Uint64 Offset = Uint64{sizeof(InstanceData)} * Range.Begin;
+        const Uint64 Size   = Uint64{sizeof(InstanceData)} * (End - Range.Begin);
+        if (!Uploads.EnqueueBufferUpdate(pInstanceBuffer, Offset, Size, &m_Dense[Range.Begin]))
+            return false; // The staging arena is full; retry next time
+
+        UploadedSize += Size;
+        return true;
+    });
+    return UploadedSize;
+}
+
+void DirtyRangeList::Merge(Uint32 RangeIdx)
+{
+    // Ranges are sorted, so only the neighbors can overlap or touch a range that has grown
+    while (RangeIdx > 0 && m_Ranges[RangeIdx - 1].End >= m_Ranges[RangeIdx].Begin)
+        --RangeIdx;
+
+    auto&  Range   = m_Ranges[RangeIdx];
+    Uint32 NextIdx = RangeIdx + 1;
+    while (NextIdx < m_NumRanges && m_Ranges[NextIdx].Begin <= Range.End)
+    {
+        Range.End = std::max(Range.End, m_Ranges[NextIdx].End);
+        ++NextIdx;
+    }
+    std::copy(m_Ranges + NextIdx, m_Ranges + m_NumRanges, m_Ranges + RangeIdx + 1);
+    m_NumRanges -= NextIdx - (RangeIdx + 1);
+}
+
+void DirtyRangeList::MarkDirty(Uint32 Index)
+{
+    // Extend an existing range if the element is inside or adjacent to it
+    for (Uint32 i = 0; i < m_NumRanges; ++i)
+    {
+        auto& Range = m_Ranges[i];
+        if (Index + 1 >= Range.Begin && Index <= Range.End)
+        {
+            Range.Begin = std::min(Range.Begin, Index);
+            Range.End   = std::max(Range.End, Index + 1);
+            // The extended range may now touch its neighbors
+            Merge(i);
+            return;
+        }
+    }
+
+    if (m_NumRanges == MaxRanges)
+    {
+        // Merge the two ranges with the smallest gap to make room. Ranges are kept sorted
+        // and disjoint, so every gap is positive.
+        Uint32 MergeIdx = 0;
+        Uint32 MinGap   = ~0u;
+        for (Uint32 i = 0; i + 1 < m_NumRanges; ++i)
+        {
+            VERIFY_EXPR(m_Ranges[i + 1].Begin > m_Ranges[i].End);
+            const Uint32 Gap = m_Ranges[i + 1].Begin - m_Ranges[i].End;
+            if (Gap < MinGap)
+            {
+                MinGap   = Gap;
+                MergeIdx = i;
+            }
+        }
+        m_Ranges[MergeIdx].End = m_Ranges[MergeIdx + 1].End;
+        std::copy(m_Ranges + MergeIdx + 2, m_Ranges + m_NumRanges, m_Ranges + MergeIdx + 1);
+        --m_NumRanges;
+    }
+
+    // Insert the new range keeping the ranges sorted
+    Uint32 InsertIdx = 0;
+    while (InsertIdx < m_NumRanges && m_Ranges[InsertIdx].Begin < Index)
+        ++InsertIdx;
+    std::copy_backward(m_Ranges + InsertIdx, m_Ranges + m_NumRanges, m_Ranges + m_NumRanges + 1);
+    m_Ranges[InsertIdx] = {Index, Index + 1};
+    ++m_NumRanges;
+
+    // The new element may have filled the gap between two neighbors
+    Merge(InsertIdx);
+}
+
+} // namespace Diligent
@@ -0,0 +1,153 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "InstanceData.hpp"
+#include "RefCntAutoPtr.hpp"
+#include "DeviceContext.h"
+#include "Buffer.h"
+#include "UploadManager.hpp"
+
+namespace Diligent
+{
+
+// Stable handle to an instance. A handle becomes stale when the instance is removed:
+// the slot generation is incremented and the handle no longer resolves.
+struct InstanceHandle
+{
+    static constexpr Uint32 InvalidIndex = ~0u;
+
+    Uint32 Index      = InvalidIndex;
+    Uint32 Generation = 0;
+
+    bool IsValid() const { return Index != InvalidIndex; }
+
+    bool operator==(const InstanceHandle& rhs) const { return Index == rhs.Index && Generation == rhs.Generation; }
+    bool operator!=(const InstanceHandle& rhs) const { return !(*this == rhs); }
+};
+
+// Sorted, disjoint ranges of modified elements. The number of ranges is bounded: when a new range
+// does not fit, the two ranges with the smallest gap are merged, and the clean elements between
+// them are uploaded again.
+class DirtyRangeList
+{
+public:
+    struct Range
+    {
+        Uint32 Begin = 0;
+        Uint32 End   = 0;
+    };
+
+    static constexpr Uint32 MaxRanges = 8;
+
+    void MarkDirty(Uint32 Index);
+    void Clear() { m_NumRanges = 0; }
+
+    // Calls Handler for every range and removes the ranges for which it returns true
+    template <typename HandlerType>
+    void Flush(HandlerType&& Handler)
+    {
+        Uint32 NumKept = 0;
+        for (Uint32 i = 0; i < m_NumRanges; ++i)
+        {
+            if (!Handler(m_Ranges[i]))
+                m_Ranges[NumKept++] = m_Ranges[i];
+        }
+        m_NumRanges = NumKept;
+    }
+
+    bool         IsEmpty() const { return m_NumRanges == 0; }
+    Uint32       GetNumRanges() const { return m_NumRanges; }
+    const Range& GetRange(Uint32 Index) const { return m_Ranges[Index]; }
+
+private:
+    void Merge(Uint32 RangeIdx);
+
+    Range  m_Ranges[MaxRanges];
+    Uint32 m_NumRanges = 0;
+};
+
+// Slot map that keeps live instances in a dense array that can be uploaded to the
+// instance buffer as is. All storage is allocated up front, so adding and removing
+// instances never allocates. Removal moves the last instance into the hole, which
+// keeps the array contiguous; the modified elements are tracked as dirty ranges that
+// are uploaded to the GPU by FlushDirty().
+class InstanceManager
+{
+public:
+    explicit InstanceManager(Uint32 Capacity);
+
+    // Returns invalid handle if the manager is full.
+    InstanceHandle Add(const InstanceData& Data);
+
+    // Returns false if the handle is stale.
+    bool Remove(InstanceHandle Handle);
+    bool Update(InstanceHandle Handle, const InstanceData& Data);
+
+    const InstanceData* Get(InstanceHandle Handle) const;
+
+    bool IsAlive(InstanceHandle Handle) const { return GetDenseIndex(Handle) != InstanceHandle::InvalidIndex; }
+
+    void Clear();
+
+    Uint32 GetCount() const { return m_Count; }
+    Uint32 GetCapacity() const { return static_cast<Uint32>(m_Slots.size()); }
+
+    const InstanceData* GetData() const { return m_Dense.data(); }
+
+    bool IsDirty() const { return !m_DirtyRanges.IsEmpty(); }
+
+    // Enqueues the modified part of the dense array for upload to the instance buffer and resets
+    // the dirty ranges. Ranges that do not fit into the staging arena stay dirty.
+    // Returns the number of bytes enqueued.
+    Uint64 FlushDirty(UploadManager& Uploads, IBuffer* pInstanceBuffer);
+
+private:
+    Uint32 GetDenseIndex(InstanceHandle Handle) const;
+
+    struct Slot
+    {
+        // Index of the instance in the dense array, or the next free slot if the slot is not used.
+        Uint32 DenseOrNextFree = InstanceHandle::InvalidIndex;
+        Uint32 Generation      = 0;
+        bool   Alive           = false;
+    };
+
+    std::vector<Slot>         m_Slots;
+    std::vector<InstanceData> m_Dense;
+    std::vector<Uint32>       m_DenseToSlot;
+
+    Uint32 m_Count     = 0;
+    Uint32 m_FirstFree = InstanceHandle::InvalidIndex;
+
+    DirtyRangeList m_DirtyRanges;
+};
+
+} // namespace Diligent
@@ -0,0 +1,119 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "MipFeedback.hpp"
+
+#include <algorithm>
+
+namespace Diligent
+{
+
+MipFeedback::MipFeedback(IRenderDevice* pDevice, Uint32 NumSlices, Uint32 MaxInFlight) :
+    m_ClearData(NumSlices, NotSampled)
+{
+    BufferDesc BuffDesc;
+    BuffDesc.Name              = "Mip feedback buffer";
+    BuffDesc.Usage             = USAGE_DEFAULT;
+    BuffDesc.BindFlags         = BIND_UNORDERED_ACCESS;
+    BuffDesc.Mode              = BUFFER_MODE_STRUCTURED;
+    BuffDesc.ElementByteStride = sizeof(Uint32);
+    BuffDesc.Size              = sizeof(Uint32) * NumSlices;
+    BufferData InitData{m_ClearData.data(), BuffDesc.Size};
+    pDevice->CreateBuffer(BuffDesc, &InitData, &m_pBuffer);
+
+    BufferDesc StagingDesc;
+    StagingDesc.Name           = "Mip feedback staging buffer";
+    StagingDesc.Usage          = USAGE_STAGING;
+    StagingDesc.CPUAccessFlags = CPU_ACCESS_READ;
+    StagingDesc.Size           = BuffDesc.Size;
+    m_FreeStaging.resize(MaxInFlight);
+    for (auto& pStaging : m_FreeStaging)
+        pDevice->CreateBuffer(StagingDesc, nullptr, &pStaging);
+
+    FenceDesc FenceCI;
+    FenceCI.Name = "Mip feedback fence";
+    FenceCI.Type = FENCE_TYPE_CPU_WAIT_ONLY;
+    pDevice->CreateFence(FenceCI, &m_pFence);
+}
+
+bool MipFeedback::EndWindow(IDeviceContext* pContext, RESOURCE_STATE_TRANSITION_MODE SrcTransitionMode)
+{
+    if (m_FreeStaging.empty())
+        return false;
+
+    PendingReadback Readback;
+    Readback.pStaging = std::move(m_FreeStaging.back());
+    m_FreeStaging.pop_back();
+
+    const Uint64 Size = m_pBuffer->GetDesc().Size;
+    pContext->CopyBuffer(m_pBuffer, 0, SrcTransitionMode, Readback.pStaging, 0, Size, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    pContext->UpdateBuffer(m_pBuffer, 0, Size, m_ClearData.data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    Readback.FenceValue = m_NextFenceValue++;
+    Readback.Generation = m_Generation;
+    pContext->EnqueueSignal(m_pFence, Readback.FenceValue);
+
+    m_Pending.emplace_back(std::move(Readback));
+    return true;
+}
+
+bool MipFeedback::Poll(IDeviceContext* pContext, std::vector<Uint32>& FinestMips)
+{
+    bool         HasData        = false;
+    const Uint64 CompletedValue = m_pFence->GetCompletedValue();
+    while (!m_Pending.empty() && m_Pending.front().FenceValue <= CompletedValue)
+    {
+        auto Readback = std::move(m_Pending.front());
+        m_Pending.pop_front();
+
+        if (Readback.Generation == m_Generation)
+        {
+            void* pData = nullptr;
+            pContext->MapBuffer(Readback.pStaging, MAP_READ, MAP_FLAG_DO_NOT_WAIT, pData);
+            if (pData != nullptr)
+            {
+                if (!HasData)
+                    FinestMips.assign(m_ClearData.size(), NotSampled);
+                const Uint32* pMips = static_cast<const Uint32*>(pData);
+                for (size_t Slice = 0; Slice < FinestMips.size(); ++Slice)
+                    FinestMips[Slice] = std::min(FinestMips[Slice], pMips[Slice]);
+                pContext->UnmapBuffer(Readback.pStaging, MAP_READ);
+                HasData = true;
+            }
+        }
+        m_FreeStaging.emplace_back(std::move(Readback.pStaging));
+    }
+    return HasData;
+}
+
+void MipFeedback::Reset(IDeviceContext* pContext)
+{
+    ++m_Generation;
+    pContext->UpdateBuffer(m_pBuffer, 0, m_pBuffer->GetDesc().Size, m_ClearData.data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+}
+
+} // namespace Diligent
@@ -0,0 +1,91 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "Fence.h"
+#include "RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+// Feedback of the finest mip level that the pixel shader samples from every slice of a texture
+// array. The shader lowers the level of a slice with an atomic min in a small structured buffer.
+// At the end of a collection window, the buffer is copied into a staging buffer and cleared;
+// the staging buffer is mapped only after its fence has completed, as in TextureReadback.
+class MipFeedback
+{
+public:
+    // Levels are stored plus one, so that magnified slices, which would sample a level above
+    // the top of the array, are reported as level 0
+    static constexpr Uint32 LevelBias = 1;
+    // Level of a slice that was not sampled during the window
+    static constexpr Uint32 NotSampled = ~0u;
+
+    MipFeedback(IRenderDevice* pDevice, Uint32 NumSlices, Uint32 MaxInFlight);
+
+    IBuffer*     GetBuffer() const { return m_pBuffer; }
+    IBufferView* GetUAV() const { return m_pBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS); }
+
+    // Records a copy of the levels collected during the window and clears the buffer, which
+    // is left in the COPY_DEST state. Returns false if all staging buffers are in flight;
+    // the buffer then keeps accumulating into the next window.
+    bool EndWindow(IDeviceContext* pContext, RESOURCE_STATE_TRANSITION_MODE SrcTransitionMode);
+
+    // Returns true and the finest level sampled from every slice, plus LevelBias, if at least
+    // one window has been read back. Levels of all completed windows are combined.
+    bool Poll(IDeviceContext* pContext, std::vector<Uint32>& FinestMips);
+
+    // Discards the windows in flight and clears the buffer, e.g. after the mip chain of the
+    // texture has changed and the collected levels are no longer valid
+    void Reset(IDeviceContext* pContext);
+
+    Uint32 GetNumSlices() const { return static_cast<Uint32>(m_ClearData.size()); }
+
+private:
+    struct PendingReadback
+    {
+        RefCntAutoPtr<IBuffer> pStaging;
+        Uint64                 FenceValue = 0;
+        Uint32                 Generation = 0;
+    };
+
+    RefCntAutoPtr<IBuffer>              m_pBuffer;
+    RefCntAutoPtr<IFence>               m_pFence;
+    Uint64                              m_NextFenceValue = 1;
+    Uint32                              m_Generation     = 0; // Incremented by Reset()
+    std::vector<Uint32>                 m_ClearData;
+    std::vector<RefCntAutoPtr<IBuffer>> m_FreeStaging;
+    std::deque<PendingReadback>         m_Pending;
+};
+
+} // namespace Diligent
@@ -0,0 +1,139 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "OffscreenScene.hpp"
+
+#include "ColorConversion.h"
+#include "SceneConstants.hpp"
+
+namespace Diligent
+{
+
+OffscreenScene::OffscreenScene(IRenderDevice* pDevice,
+                               const char*    Name,
+                               Uint32         Width,
+                               Uint32         Height,
+                               TEXTURE_FORMAT ColorFormat,
+                               TEXTURE_FORMAT DepthFormat,
+                               Uint32         MaxInstances) :
+    m_Name{Name},
+    m_DepthFormat{DepthFormat},
+    m_Instances{MaxInstances}
+{
+    TextureDesc TexDesc;
+    TexDesc.Type      = RESOURCE_DIM_TEX_2D;
+    TexDesc.Width     = Width;
+    TexDesc.Height    = Height;
+    TexDesc.MipLevels = 1;
+
+    const std::string ColorName = m_Name + " color";
+    TexDesc.Name                = ColorName.c_str();
+    TexDesc.Format              = ColorFormat;
+    TexDesc.BindFlags           = BIND_RENDER_TARGET | BIND_SHADER_RESOURCE;
+    pDevice->CreateTexture(TexDesc, nullptr, &m_pColor);
+
+    const std::string InstBuffName = m_Name + " instance buffer";
+    BufferDesc        InstBuffDesc;
+    InstBuffDesc.Name      = InstBuffName.c_str();
+    InstBuffDesc.Usage     = USAGE_DEFAULT;
+    InstBuffDesc.BindFlags = BIND_VERTEX_BUFFER;
+    InstBuffDesc.Size      = sizeof(InstanceData) * MaxInstances;
+    pDevice->CreateBuffer(InstBuffDesc, nullptr, &m_InstanceBuffer);
+}
+
+void OffscreenScene::UpdateInstances(UploadManager& Uploads)
+{
+    m_Instances.FlushDirty(Uploads, m_InstanceBuffer);
+}
+
+Uint32 OffscreenScene::WriteConstants(DynamicUniformRing& Ring, float Time) const
+{
+    Uint32 Offset     = ~0u;
+    auto*  pConstants = Ring.Allocate<VSConstants>(Offset);
+    if (pConstants == nullptr)
+        return ~0u;
+
+    pConstants->ViewProj = m_ViewProj;
+    pConstants->Rotation = float4x4::Identity();
+    pConstants->Time     = float4{Time, 1, 0, 0};
+    return Offset;
+}
+
+TextureDesc OffscreenScene::GetDepthBufferDesc() const
+{
+    const auto& ColorDesc = m_pColor->GetDesc();
+
+    TextureDesc DepthDesc;
+    DepthDesc.Name      = "Offscreen scene depth";
+    DepthDesc.Type      = RESOURCE_DIM_TEX_2D;
+    DepthDesc.Width     = ColorDesc.Width;
+    DepthDesc.Height    = ColorDesc.Height;
+    DepthDesc.MipLevels = 1;
+    DepthDesc.Format    = m_DepthFormat;
+    DepthDesc.BindFlags = BIND_DEPTH_STENCIL;
+    return DepthDesc;
+}
+
+void OffscreenScene::Render(ContextStateCache&             StateCache,
+                            const SharedSceneResources&    Shared,
+                            ITextureView*                  pDSV,
+                            Uint32                         ConstantsOffset,
+                            RESOURCE_STATE_TRANSITION_MODE TransitionMode) const
+{
+    if (ConstantsOffset == ~0u)
+        return;
+
+    IDeviceContext* pContext = StateCache.GetContext();
+
+    ITextureView* pRTV = m_pColor->GetDefaultView(TEXTURE_VIEW_RENDER_TARGET);
+    pContext->SetRenderTargets(1, &pRTV, pDSV, TransitionMode);
+
+    float4 ClearColor = {0.0f, 0.0f, 0.0f, 1.0f};
+    if (Shared.ConvertPSOutputToGamma)
+        ClearColor = LinearToSRGB(ClearColor);
+    pContext->ClearRenderTarget(pRTV, ClearColor.Data(), TransitionMode);
+    pContext->ClearDepthStencil(pDSV, CLEAR_DEPTH_FLAG, 1.f, 0, TransitionMode);
+
+    const Uint64 Offsets[] = {0, 0};
+    IBuffer*     pBuffs[]  = {Shared.pCubeVB, m_InstanceBuffer};
+    StateCache.SetVertexBuffers(0, _countof(pBuffs), pBuffs, Offsets, TransitionMode, Shared.ValidateDraws ? SET_VERTEX_BUFFERS_FLAG_RESET : SET_VERTEX_BUFFERS_FLAG_NONE);
+    StateCache.SetIndexBuffer(Shared.pCubeIB, 0, TransitionMode);
+
+    StateCache.SetPipelineState(Shared.pPSO);
+    StateCache.CommitShaderResources(Shared.pSRB, TransitionMode);
+    // Dynamic offsets are applied at draw time, so the SRB does not need to be committed again
+    Shared.pConstantsVar->SetBufferOffset(ConstantsOffset);
+
+    DrawIndexedAttribs DrawAttrs;
+    DrawAttrs.IndexType    = VT_UINT32;
+    DrawAttrs.NumIndices   = 36;
+    DrawAttrs.NumInstances = m_Instances.GetCount();
+    DrawAttrs.Flags        = Shared.ValidateDraws ? DRAW_FLAG_VERIFY_ALL : DRAW_FLAG_NONE;
+    pContext->DrawIndexed(DrawAttrs);
+}
+
+} // namespace Diligent
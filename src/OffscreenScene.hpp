@@ -0,0 +1,111 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "RefCntAutoPtr.hpp"
+#include "BasicMath.hpp"
+#include "InstanceManager.hpp"
+#include "ContextStateCache.hpp"
+#include "DynamicUniformRing.hpp"
+
+namespace Diligent
+{
+
+// Resources shared by all scenes hosted in the process
+struct SharedSceneResources
+{
+    IPipelineState*          pPSO                   = nullptr;
+    IShaderResourceBinding*  pSRB                   = nullptr;
+    IShaderResourceVariable* pConstantsVar          = nullptr; // "Constants" variable of pSRB
+    IBuffer*                 pCubeVB                = nullptr;
+    IBuffer*                 pCubeIB                = nullptr;
+    bool                     ConvertPSOutputToGamma = false;
+    bool                     ValidateDraws          = true; // Verify draw arguments and buffer states
+};
+
+// Independent scene with its own camera, instance set and offscreen render target.
+// The pipeline, texture array and cube geometry are shared with other scenes.
+class OffscreenScene
+{
+public:
+    OffscreenScene(IRenderDevice* pDevice,
+                   const char*    Name,
+                   Uint32         Width,
+                   Uint32         Height,
+                   TEXTURE_FORMAT ColorFormat,
+                   TEXTURE_FORMAT DepthFormat,
+                   Uint32         MaxInstances);
+
+    InstanceManager& GetInstances() { return m_Instances; }
+
+    void SetViewProj(const float4x4& ViewProj) { m_ViewProj = ViewProj; }
+
+    // Enqueues modified instances for upload
+    void UpdateInstances(UploadManager& Uploads);
+
+    // Writes the scene camera into the mapped ring of the context that will render the scene
+    // and returns the offset of the block, or ~0u if the ring is full.
+    Uint32 WriteConstants(DynamicUniformRing& Ring, float Time) const;
+
+    // Renders the scene into its offscreen target using the given depth buffer. Deferred contexts
+    // must use RESOURCE_STATE_TRANSITION_MODE_VERIFY after the resources were transitioned
+    // on the immediate context, as state transitions are not thread-safe. Bindings go through
+    // the state cache of the context, so scenes rendered in a row share the common state.
+    // ConstantsOffset is the block returned by WriteConstants().
+    void Render(ContextStateCache&             StateCache,
+                const SharedSceneResources&    Shared,
+                ITextureView*                  pDSV,
+                Uint32                         ConstantsOffset,
+                RESOURCE_STATE_TRANSITION_MODE TransitionMode) const;
+
+    ITexture*     GetColorTexture() const { return m_pColor; }
+    ITextureView* GetColorSRV() const { return m_pColor->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE); }
+    IBuffer*      GetInstanceBuffer() const { return m_InstanceBuffer; }
+
+    // The depth buffer is only needed while the scene is rendered, so it is not owned by the scene
+    TextureDesc GetDepthBufferDesc() const;
+
+    const std::string& GetName() const { return m_Name; }
+
+private:
+    const std::string m_Name;
+
+    RefCntAutoPtr<ITexture> m_pColor;
+    const TEXTURE_FORMAT    m_DepthFormat;
+    RefCntAutoPtr<IBuffer>  m_InstanceBuffer;
+
+    InstanceManager m_Instances;
+    float4x4        m_ViewProj = float4x4::Identity();
+};
+
+} // namespace Diligent
@@ -0,0 +1,833 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "PngDecoder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define PNG_DECODER_SSE2 1
+#else
+#    define PNG_DECODER_SSE2 0
+#endif
+
+#include "GraphicsAccessories.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Inflate (RFC 1950, RFC 1951)
+
+constexpr Uint32 HuffmanFastBits = 10;
+
+Uint32 ReverseBits(Uint32 Code, Uint32 NumBits)
+{
+    Uint32 Reversed = 0;
+    for (Uint32 i = 0; i < NumBits; ++i, Code >>= 1)
+        Reversed = (Reversed << 1) | (Code & 1);
+    return Reversed;
+}
+
+// Canonical Huffman code. Codes of up to HuffmanFastBits bits are decoded with a single lookup,
+// longer codes are found by comparing against the largest code of each length.
+struct HuffmanTable
+{
+    Uint16 Fast[1u << HuffmanFastBits]; // (length << 9) | symbol, indexed by the bit-reversed code
+    Uint16 FirstCode[16];
+    Uint32 MaxCode[17];
+    Uint16 FirstSymbol[16];
+    Uint8  Length[288];
+    Uint16 Symbol[288];
+
+    bool Build(const Uint8* pLengths, Uint32 NumSymbols)
+    {
+        Uint32 Counts[16] = {};
+        for (Uint32 i = 0; i < NumSymbols; ++i)
+            ++Counts[pLengths[i]];
+        Counts[0] = 0;
+        memset(Fast, 0, sizeof(Fast));
+
+        Uint32 NextCode[16] = {};
+        Uint32 Code         = 0;
+        Uint32 Index        = 0;
+        for (Uint32 Len = 1; Len < 16; ++Len)
+        {
+            NextCode[Len]    = Code;
+            FirstCode[Len]   = static_cast<Uint16>(Code);
+            FirstSymbol[Len] = static_cast<Uint16>(Index);
+            Code += Counts[Len];
+            if (Counts[Len] != 0 && Code - 1 >= (1u << Len))
+                return false; // Over-subscribed code
+            MaxCode[Len] = Code << (16 - Len);
+            Code <<= 1;
+            Index += Counts[Len];
+        }
+        MaxCode[16] = 0x10000;
+
+        for (Uint32 Sym = 0; Sym < NumSymbols; ++Sym)
+        {
+            const Uint32 Len = pLengths[Sym];
+            if (Len == 0)
+                continue;
+            const Uint32 Pos = NextCode[Len] - FirstCode[Len] + FirstSymbol[Len];
+            Length[Pos]      = static_cast<Uint8>(Len);
+            Symbol[Pos]      = static_cast<Uint16>(Sym);
+            if (Len <= HuffmanFastBits)
+            {
+                for (Uint32 j = ReverseBits(NextCode[Len], Len); j < (1u << HuffmanFastBits); j += 1u << Len)
+                    Fast[j] = static_cast<Uint16>((Len << 9) | Sym);
+            }
+            ++NextCode[Len];
+        }
+        return true;
+    }
+};
+
+// Deflate streams are read LSB-first. The buffer is refilled with 8-byte loads
+// (little-endian hosts only), which keeps at least 56 bits available, enough for
+// a length/distance pair with all extra bits.
+class BitReader
+{
+public:
+    BitReader(const Uint8* pData, size_t Size) :
+        m_pCurr{pData},
+        m_pEnd{pData + Size}
+    {}
+
+    void Refill()
+    {
+        if (m_pEnd - m_pCurr >= 8)
+        {
+            Uint64 Word;
+            memcpy(&Word, m_pCurr, sizeof(Word));
+            m_Bits |= Word << m_NumBits;
+            m_pCurr += (63 - m_NumBits) >> 3;
+            m_NumBits |= 56;
+        }
+        else
+        {
+            for (; m_NumBits <= 56; m_NumBits += 8)
+            {
+                // Past the end, zeros are shifted in. Valid streams never consume them.
+                if (m_pCurr < m_pEnd)
+                    m_Bits |= Uint64{*m_pCurr++} << m_NumBits;
+                else
+                    ++m_NumPadBytes;
+            }
+        }
+    }
+
+    Uint32 Peek(Uint32 NumBits) const { return static_cast<Uint32>(m_Bits & ((Uint64{1} << NumBits) - 1)); }
+
+    void Consume(Uint32 NumBits)
+    {
+        m_Bits >>= NumBits;
+        m_NumBits -= NumBits;
+    }
+
+    Uint32 Read(Uint32 NumBits)
+    {
+        const Uint32 Value = Peek(NumBits);
+        Consume(NumBits);
+        return Value;
+    }
+
+    Uint32 GetNumBits() const { return m_NumBits; }
+
+    bool IsOverrun() const { return m_NumPadBytes * 8 > m_NumBits; }
+
+    // Copies whole bytes of a stored block. The buffer must be byte-aligned.
+    bool CopyBytes(Uint8* pDst, size_t Size)
+    {
+        for (; Size > 0 && m_NumBits >= 8; --Size)
+            *pDst++ = static_cast<Uint8>(Read(8));
+        if (Size == 0)
+            return true;
+        // The bits above m_NumBits are a copy of the input that is about to be skipped
+        m_Bits = 0;
+        if (static_cast<size_t>(m_pEnd - m_pCurr) < Size)
+            return false;
+        memcpy(pDst, m_pCurr, Size);
+        m_pCurr += Size;
+        return true;
+    }
+
+private:
+    const Uint8* m_pCurr       = nullptr;
+    const Uint8* m_pEnd        = nullptr;
+    Uint64       m_Bits        = 0;
+    Uint32       m_NumBits     = 0;
+    Uint32       m_NumPadBytes = 0;
+};
+
+// The buffer must hold at least 15 bits. Returns -1 for invalid codes.
+int DecodeSymbol(BitReader& Bits, const HuffmanTable& Table)
+{
+    const Uint32 Entry = Table.Fast[Bits.Peek(HuffmanFastBits)];
+    if (Entry != 0)
+    {
+        Bits.Consume(Entry >> 9);
+        return static_cast<int>(Entry & 511);
+    }
+
+    const Uint32 Code = ReverseBits(Bits.Peek(16), 16);
+    Uint32       Len  = HuffmanFastBits + 1;
+    while (Code >= Table.MaxCode[Len])
+        ++Len;
+    if (Len >= 16)
+        return -1;
+    const Uint32 Pos = (Code >> (16 - Len)) - Table.FirstCode[Len] + Table.FirstSymbol[Len];
+    if (Pos >= 288 || Table.Length[Pos] != Len)
+        return -1;
+    Bits.Consume(Len);
+    return Table.Symbol[Pos];
+}
+
+// clang-format off
+constexpr Uint16 LengthBase[29]  = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr Uint8  LengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr Uint16 DistBase[30]    = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr Uint8  DistExtra[30]   = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+// clang-format on
+
+bool ReadDynamicTables(BitReader& Bits, HuffmanTable& LitLen, HuffmanTable& Dist)
+{
+    static constexpr Uint8 CodeLengthOrder[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+    Bits.Refill();
+    const Uint32 NumLitLen = Bits.Read(5) + 257;
+    const Uint32 NumDist   = Bits.Read(5) + 1;
+    const Uint32 NumCLen   = Bits.Read(4) + 4;
+
+    Uint8 CodeLengths[19] = {};
+    for (Uint32 i = 0; i < NumCLen; ++i)
+    {
+        Bits.Refill();
+        CodeLengths[CodeLengthOrder[i]] = static_cast<Uint8>(Bits.Read(3));
+    }
+    HuffmanTable CodeLengthTable;
+    if (!CodeLengthTable.Build(CodeLengths, 19))
+        return false;
+
+    Uint8        Lengths[288 + 32] = {};
+    const Uint32 NumLengths        = NumLitLen + NumDist;
+    for (Uint32 n = 0; n < NumLengths;)
+    {
+        Bits.Refill();
+        const int Sym = DecodeSymbol(Bits, CodeLengthTable);
+        if (Sym < 0)
+            return false;
+        if (Sym < 16)
+        {
+            Lengths[n++] = static_cast<Uint8>(Sym);
+            continue;
+        }
+
+        Uint32 Repeat = 0;
+        Uint8  Value  = 0;
+        if (Sym == 16)
+        {
+            if (n == 0)
+                return false;
+            Repeat = 3 + Bits.Read(2);
+            Value  = Lengths[n - 1];
+        }
+        else if (Sym == 17)
+        {
+            Repeat = 3 + Bits.Read(3);
+        }
+        else
+        {
+            Repeat = 11 + Bits.Read(7);
+        }
+        if (n + Repeat > NumLengths)
+            return false;
+        memset(Lengths + n, Value, Repeat);
+        n += Repeat;
+    }
+    if (Lengths[256] == 0)
+        return false; // No end-of-block code
+
+    return LitLen.Build(Lengths, NumLitLen) && Dist.Build(Lengths + NumLitLen, NumDist);
+}
+
+void BuildFixedTables(HuffmanTable& LitLen, HuffmanTable& Dist)
+{
+    Uint8 Lengths[288];
+    memset(Lengths + 0, 8, 144);
+    memset(Lengths + 144, 9, 112);
+    memset(Lengths + 256, 7, 24);
+    memset(Lengths + 280, 8, 8);
+    LitLen.Build(Lengths, 288);
+
+    memset(Lengths, 5, 30);
+    Dist.Build(Lengths, 30);
+}
+
+// Decompresses a zlib stream into pDst. Returns the number of bytes written, or ~size_t{0} if
+// the stream is invalid or does not fit.
+size_t InflateZlib(const Uint8* pSrc, size_t SrcSize, Uint8* pDst, size_t DstSize)
+{
+    constexpr size_t Error = ~size_t{0};
+    if (SrcSize < 2 || (pSrc[0] & 0x0F) != 8 || (pSrc[0] >> 4) > 7 || ((pSrc[0] << 8) | pSrc[1]) % 31 != 0 || (pSrc[1] & 0x20) != 0)
+        return Error; // Not deflate, or a preset dictionary is required
+
+    BitReader    Bits{pSrc + 2, SrcSize - 2};
+    Uint8*       pOut    = pDst;
+    Uint8* const pOutEnd = pDst + DstSize;
+    HuffmanTable LitLen;
+    HuffmanTable Dist;
+    for (bool IsFinal = false; !IsFinal;)
+    {
+        Bits.Refill();
+        IsFinal           = Bits.Read(1) != 0;
+        const Uint32 Type = Bits.Read(2);
+        if (Type == 0)
+        {
+            // Stored block, starts at the next byte boundary
+            Bits.Consume(Bits.GetNumBits() & 7);
+            Bits.Refill();
+            const Uint32 Len  = Bits.Read(16);
+            const Uint32 NLen = Bits.Read(16);
+            if ((Len ^ 0xFFFFu) != NLen || static_cast<size_t>(pOutEnd - pOut) < Len || !Bits.CopyBytes(pOut, Len))
+                return Error;
+            pOut += Len;
+            // The block may have been copied from the zeros shifted in past the end
+            if (Bits.IsOverrun())
+                return Error;
+            continue;
+        }
+
+        if (Type == 1)
+            BuildFixedTables(LitLen, Dist);
+        else if (Type != 2 || !ReadDynamicTables(Bits, LitLen, Dist))
+            return Error;
+
+        for (;;)
+        {
+            Bits.Refill();
+            int Sym = DecodeSymbol(Bits, LitLen);
+            if (Sym < 0)
+                return Error;
+            if (Sym < 256)
+            {
+                if (pOut == pOutEnd)
+                    return Error;
+                *pOut++ = static_cast<Uint8>(Sym);
+                continue;
+            }
+            if (Sym == 256)
+                break;
+
+            Sym -= 257;
+            if (Sym >= 29)
+                return Error;
+            const size_t Len     = LengthBase[Sym] + Bits.Read(LengthExtra[Sym]);
+            const int    DistSym = DecodeSymbol(Bits, Dist);
+            if (DistSym < 0 || DistSym >= 30)
+                return Error;
+            const size_t Distance = DistBase[DistSym] + Bits.Read(DistExtra[DistSym]);
+            if (Distance > static_cast<size_t>(pOut - pDst) || Len > static_cast<size_t>(pOutEnd - pOut))
+                return Error;
+
+            const Uint8* pMatch = pOut - Distance;
+            if (Distance >= 8 && static_cast<size_t>(pOutEnd - pOut) >= Len + 8)
+            {
+                // 8-byte copies may write past the match; the extra bytes are overwritten later
+                Uint8* const pCopyEnd = pOut + Len;
+                do
+                {
+                    memcpy(pOut, pMatch, 8);
+                    pOut += 8;
+                    pMatch += 8;
+                } while (pOut < pCopyEnd);
+                pOut = pCopyEnd;
+            }
+            else if (Distance == 1)
+            {
+                memset(pOut, *pMatch, Len);
+                pOut += Len;
+            }
+            else
+            {
+                for (size_t i = 0; i < Len; ++i)
+                    pOut[i] = pMatch[i];
+                pOut += Len;
+            }
+        }
+        if (Bits.IsOverrun())
+            return Error;
+    }
+    return static_cast<size_t>(pOut - pDst);
+}
+
+// PNG row filters
+
+Uint8 PaethPredictor(int a, int b, int c)
+{
+    const int pa = std::abs(b - c);
+    const int pb = std::abs(a - c);
+    const int pc = std::abs(a + b - 2 * c);
+    return static_cast<Uint8>((pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c));
+}
+
+#if PNG_DECODER_SSE2
+
+__m128i LoadPixel(const Uint8* p)
+{
+    int Pixel;
+    memcpy(&Pixel, p, 4);
+    return _mm_cvtsi32_si128(Pixel);
+}
+
+void StorePixel(Uint8* p, __m128i Pixel)
+{
+    const int Value = _mm_cvtsi128_si32(Pixel);
+    memcpy(p, &Value, 4);
+}
+
+// Four-channel rows are reconstructed a pixel at a time, all channels in parallel
+void UnfilterSub4(const Uint8* pSrc, Uint8* pDst, size_t RowBytes)
+{
+    __m128i a = _mm_setzero_si128();
+    for (size_t i = 0; i < RowBytes; i += 4)
+    {
+        a = _mm_add_epi8(a, LoadPixel(pSrc + i));
+        StorePixel(pDst + i, a);
+    }
+}
+
+void UnfilterAvg4(const Uint8* pSrc, const Uint8* pPrev, Uint8* pDst, size_t RowBytes)
+{
+    const __m128i One = _mm_set1_epi8(1);
+
+    __m128i a = _mm_setzero_si128();
+    for (size_t i = 0; i < RowBytes; i += 4)
+    {
+        const __m128i b = LoadPixel(pPrev + i);
+        // _mm_avg_epu8 rounds up, the filter rounds down
+        const __m128i Avg = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), One));
+        a                 = _mm_add_epi8(Avg, LoadPixel(pSrc + i));
+        StorePixel(pDst + i, a);
+    }
+}
+
+__m128i Abs16(__m128i x)
+{
+    return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+__m128i Select(__m128i Mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(Mask, a), _mm_andnot_si128(Mask, b));
+}
+
+void UnfilterPaeth4(const Uint8* pSrc, const Uint8* pPrev, Uint8* pDst, size_t RowBytes)
+{
+    const __m128i Zero = _mm_setzero_si128();
+
+    // Channels are widened to 16 bits, so that the predictor distances do not overflow
+    __m128i a = Zero;
+    __m128i c = Zero;
+    for (size_t i = 0; i < RowBytes; i += 4)
+    {
+        const __m128i b = _mm_unpacklo_epi8(LoadPixel(pPrev + i), Zero);
+
+        const __m128i p  = _mm_sub_epi16(b, c);
+        const __m128i q  = _mm_sub_epi16(a, c);
+        const __m128i pa = Abs16(p);
+        const __m128i pb = Abs16(q);
+        const __m128i pc = Abs16(_mm_add_epi16(p, q));
+
+        // Ties favor a over b over c
+        const __m128i Smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+        const __m128i Nearest  = Select(_mm_cmpeq_epi16(Smallest, pa), a, Select(_mm_cmpeq_epi16(Smallest, pb), b, c));
+
+        const __m128i d = _mm_add_epi8(_mm_packus_epi16(Nearest, Nearest), LoadPixel(pSrc + i));
+        StorePixel(pDst + i, d);
+
+        a = _mm_unpacklo_epi8(d, Zero);
+        c = b;
+    }
+}
+
+#endif
+
+// Reconstructs a row from its filtered bytes and the previous reconstructed row
+bool UnfilterRow(Uint8 Filter, const Uint8* pSrc, const Uint8* pPrev, Uint8* pDst, size_t RowBytes, size_t Bpp)
+{
+    switch (Filter)
+    {
+        case 0: // None
+            memcpy(pDst, pSrc, RowBytes);
+            return true;
+
+        case 1: // Sub
+#if PNG_DECODER_SSE2
+            if (Bpp == 4)
+            {
+                UnfilterSub4(pSrc, pDst, RowBytes);
+                return true;
+            }
+#endif
+            memcpy(pDst, pSrc, Bpp);
+            for (size_t i = Bpp; i < RowBytes; ++i)
+                pDst[i] = static_cast<Uint8>(pSrc[i] + pDst[i - Bpp]);
+            return true;
+
+        case 2: // Up
+        {
+            size_t i = 0;
+#if PNG_DECODER_SSE2
+            for (; i + 16 <= RowBytes; i += 16)
+            {
+                const __m128i Sum = _mm_add_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i)),
+                                                 _mm_loadu_si128(reinterpret_cast<const __m128i*>(pPrev + i)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), Sum);
+            }
+#endif
+            for (; i < RowBytes; ++i)
+                pDst[i] = static_cast<Uint8>(pSrc[i] + pPrev[i]);
+            return true;
+        }
+
+        case 3: // Average
+#if PNG_DECODER_SSE2
+            if (Bpp == 4)
+            {
+                UnfilterAvg4(pSrc, pPrev, pDst, RowBytes);
+                return true;
+            }
+#endif
+            for (size_t i = 0; i < Bpp; ++i)
+                pDst[i] = static_cast<Uint8>(pSrc[i] + (pPrev[i] >> 1));
+            for (size_t i = Bpp; i < RowBytes; ++i)
+                pDst[i] = static_cast<Uint8>(pSrc[i] + ((pDst[i - Bpp] + pPrev[i]) >> 1));
+            return true;
+
+        case 4: // Paeth
+#if PNG_DECODER_SSE2
+            if (Bpp == 4)
+            {
+                UnfilterPaeth4(pSrc, pPrev, pDst, RowBytes);
+                return true;
+            }
+#endif
+            for (size_t i = 0; i < Bpp; ++i)
+                pDst[i] = static_cast<Uint8>(pSrc[i] + pPrev[i]);
+            for (size_t i = Bpp; i < RowBytes; ++i)
+                pDst[i] = static_cast<Uint8>(pSrc[i] + PaethPredictor(pDst[i - Bpp], pPrev[i], pPrev[i - Bpp]));
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+// Mip generation
+
+struct SRGBTables
+{
+    float LinearFromSRGB[256];
+    Uint8 SRGBFromLinear[4096];
+
+    SRGBTables()
+    {
+        for (Uint32 i = 0; i < 256; ++i)
+        {
+            const float c     = static_cast<float>(i) / 255.f;
+            LinearFromSRGB[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        for (Uint32 i = 0; i < 4096; ++i)
+        {
+            const float l     = static_cast<float>(i) / 4095.f;
+            const float c     = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.f / 2.4f) - 0.055f;
+            SRGBFromLinear[i] = static_cast<Uint8>(std::min(c * 255.f + 0.5f, 255.f));
+        }
+    }
+};
+
+// 2x2 box filter. Odd source dimensions clamp the last row and column.
+void ComputeMipLevel(const Uint8* pSrc, Uint32 SrcWidth, Uint32 SrcHeight, size_t SrcStride,
+                     Uint8* pDst, Uint32 DstWidth, Uint32 DstHeight, size_t DstStride, bool IsSRGB)
+{
+    static const SRGBTables Tables;
+    for (Uint32 y = 0; y < DstHeight; ++y)
+    {
+        const Uint8* pRow0 = pSrc + std::min(y * 2, SrcHeight - 1) * SrcStride;
+        const Uint8* pRow1 = pSrc + std::min(y * 2 + 1, SrcHeight - 1) * SrcStride;
+        Uint8*       pOut  = pDst + y * DstStride;
+        for (Uint32 x = 0; x < DstWidth; ++x, pOut += 4)
+        {
+            const size_t x0 = std::min(x * 2, SrcWidth - 1) * 4;
+            const size_t x1 = std::min(x * 2 + 1, SrcWidth - 1) * 4;
+            for (size_t c = 0; c < 3; ++c)
+            {
+                if (IsSRGB)
+                {
+                    const float Linear = Tables.LinearFromSRGB[pRow0[x0 + c]] + Tables.LinearFromSRGB[pRow0[x1 + c]] +
+                        Tables.LinearFromSRGB[pRow1[x0 + c]] + Tables.LinearFromSRGB[pRow1[x1 + c]];
+                    pOut[c] = Tables.SRGBFromLinear[static_cast<Uint32>(Linear * (4095.f / 4.f) + 0.5f)];
+                }
+                else
+                {
+                    pOut[c] = static_cast<Uint8>((pRow0[x0 + c] + pRow0[x1 + c] + pRow1[x0 + c] + pRow1[x1 + c] + 2) >> 2);
+                }
+            }
+            pOut[3] = static_cast<Uint8>((pRow0[x0 + 3] + pRow0[x1 + 3] + pRow1[x0 + 3] + pRow1[x1 + 3] + 2) >> 2);
+        }
+    }
+}
+
+Uint32 ReadBE32(const Uint8* p)
+{
+    return (Uint32{p[0]} << 24) | (Uint32{p[1]} << 16) | (Uint32{p[2]} << 8) | Uint32{p[3]};
+}
+
+enum PNG_COLOR_TYPE : Uint8
+{
+    PNG_COLOR_TYPE_GRAY       = 0,
+    PNG_COLOR_TYPE_RGB        = 2,
+    PNG_COLOR_TYPE_PALETTE    = 3,
+    PNG_COLOR_TYPE_GRAY_ALPHA = 4,
+    PNG_COLOR_TYPE_RGBA       = 6
+};
+
+constexpr Uint8  PngSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+constexpr Uint32 MaxDimension    = 16384;
+
+} // namespace
+
+bool DecodePngTexture(const void* pData, size_t Size, bool IsSRGB, DecodedPngTexture& Texture)
+{
+    const Uint8* pSrc = static_cast<const Uint8*>(pData);
+    if (Size < sizeof(PngSignature) || memcmp(pSrc, PngSignature, sizeof(PngSignature)) != 0)
+        return false;
+
+    Uint32 Width     = 0;
+    Uint32 Height    = 0;
+    Uint8  ColorType = 0;
+    Uint8  Palette[256][4];
+    for (auto& Entry : Palette)
+    {
+        Entry[0] = Entry[1] = Entry[2] = 0;
+        Entry[3]                       = 255;
+    }
+    bool   HasColorKey = false;
+    Uint32 ColorKey[3] = {};
+
+    // The zlib stream may be split between several IDAT chunks
+    const Uint8*       pCompressed    = nullptr;
+    size_t             CompressedSize = 0;
+    std::vector<Uint8> JoinedIDAT;
+    for (size_t Pos = sizeof(PngSignature); Pos + 12 <= Size;)
+    {
+        const Uint32 Len = ReadBE32(pSrc + Pos);
+        if (Len > Size - Pos - 12)
+            return false;
+        const Uint8* pType  = pSrc + Pos + 4;
+        const Uint8* pChunk = pSrc + Pos + 8;
+        Pos += size_t{12} + Len;
+
+        if (memcmp(pType, "IHDR", 4) == 0)
+        {
+            if (Len < 13)
+                return false;
+            Width     = ReadBE32(pChunk);
+            Height    = ReadBE32(pChunk + 4);
+            ColorType = pChunk[9];
+            // Bit depth, compression, filter method and interlacing
+            if (pChunk[8] != 8 || pChunk[10] != 0 || pChunk[11] != 0 || pChunk[12] != 0)
+                return false;
+            if (ColorType != PNG_COLOR_TYPE_GRAY && ColorType != PNG_COLOR_TYPE_RGB && ColorType != PNG_COLOR_TYPE_PALETTE &&
+                ColorType != PNG_COLOR_TYPE_GRAY_ALPHA && ColorType != PNG_COLOR_TYPE_RGBA)
+                return false;
+            if (Width == 0 || Height == 0 || Width > MaxDimension || Height > MaxDimension)
+                return false;
+        }
+        else if (memcmp(pType, "PLTE", 4) == 0)
+        {
+            for (Uint32 i = 0; i < std::min(Len / 3, 256u); ++i)
+                memcpy(Palette[i], pChunk + i * 3, 3);
+        }
+        else if (memcmp(pType, "tRNS", 4) == 0)
+        {
+            if (ColorType == PNG_COLOR_TYPE_PALETTE)
+            {
+                for (Uint32 i = 0; i < std::min(Len, 256u); ++i)
+                    Palette[i][3] = pChunk[i];
+            }
+            else if ((ColorType == PNG_COLOR_TYPE_GRAY && Len >= 2) || (ColorType == PNG_COLOR_TYPE_RGB && Len >= 6))
+            {
+                HasColorKey = true;
+                for (Uint32 c = 0; c < Len / 2 && c < 3; ++c)
+                    ColorKey[c] = (Uint32{pChunk[c * 2]} << 8) | pChunk[c * 2 + 1];
+            }
+        }
+        else if (memcmp(pType, "IDAT", 4) == 0)
+        {
+            if (pCompressed == nullptr)
+            {
+                pCompressed    = pChunk;
+                CompressedSize = Len;
+            }
+            else
+            {
+                if (JoinedIDAT.empty())
+                    JoinedIDAT.assign(pCompressed, pCompressed + CompressedSize);
+                JoinedIDAT.insert(JoinedIDAT.end(), pChunk, pChunk + Len);
+                pCompressed    = JoinedIDAT.data();
+                CompressedSize = JoinedIDAT.size();
+            }
+        }
+        else if (memcmp(pType, "IEND", 4) == 0)
+        {
+            break;
+        }
+        else if ((pType[0] & 0x20) == 0)
+        {
+            return false; // Unknown critical chunk
+        }
+    }
+    if (Width == 0 || pCompressed == nullptr)
+        return false;
+
+    static constexpr Uint32 ChannelsPerType[] = {1, 0, 3, 1, 2, 0, 4};
+
+    const size_t Bpp      = ChannelsPerType[ColorType];
+    const size_t RowBytes = Width * Bpp;
+
+    // Filtered rows, each preceded by the filter type. The buffer is released after the
+    // decode, so a single large image does not pin its size on a pool thread.
+    std::vector<Uint8> Filtered((RowBytes + 1) * Height);
+    if (InflateZlib(pCompressed, CompressedSize, Filtered.data(), Filtered.size()) != Filtered.size())
+        return false;
+
+    auto& Desc     = Texture.Desc;
+    Desc           = TextureDesc{};
+    Desc.Type      = RESOURCE_DIM_TEX_2D;
+    Desc.Width     = Width;
+    Desc.Height    = Height;
+    Desc.Format    = IsSRGB ? TEX_FORMAT_RGBA8_UNORM_SRGB : TEX_FORMAT_RGBA8_UNORM;
+    Desc.MipLevels = ComputeMipLevelsCount(Width, Height);
+    Desc.Usage     = USAGE_IMMUTABLE;
+    Desc.BindFlags = BIND_SHADER_RESOURCE;
+
+    size_t DataSize = 0;
+    for (Uint32 mip = 0; mip < Desc.MipLevels; ++mip)
+        DataSize += static_cast<size_t>(GetMipLevelProperties(Desc, mip).MipSize);
+    Texture.Data.resize(DataSize);
+    Texture.Mips.resize(Desc.MipLevels);
+
+    // RGBA rows are reconstructed in place. Other formats go through a pair of rows and are expanded.
+    Uint8* const       pLevel0   = Texture.Data.data();
+    const size_t       DstStride = size_t{Width} * 4;
+    const bool         IsRGBA    = ColorType == PNG_COLOR_TYPE_RGBA;
+    std::vector<Uint8> Rows(IsRGBA ? RowBytes : RowBytes * 3);
+    Uint8* const       pZeroRow = Rows.data();
+    memset(pZeroRow, 0, RowBytes);
+    for (Uint32 y = 0; y < Height; ++y)
+    {
+        const Uint8* pFiltered = Filtered.data() + y * (RowBytes + 1);
+        Uint8* const pDst      = pLevel0 + y * DstStride;
+        Uint8* const pRow      = IsRGBA ? pDst : Rows.data() + RowBytes * (1 + (y & 1));
+        const Uint8* pPrev     = pZeroRow;
+        if (y > 0)
+            pPrev = IsRGBA ? pDst - DstStride : Rows.data() + RowBytes * (1 + ((y + 1) & 1));
+        if (!UnfilterRow(pFiltered[0], pFiltered + 1, pPrev, pRow, RowBytes, Bpp))
+            return false;
+
+        switch (ColorType)
+        {
+            case PNG_COLOR_TYPE_GRAY:
+                for (Uint32 x = 0; x < Width; ++x)
+                {
+                    const Uint8 g   = pRow[x];
+                    pDst[x * 4 + 0] = g;
+                    pDst[x * 4 + 1] = g;
+                    pDst[x * 4 + 2] = g;
+                    pDst[x * 4 + 3] = HasColorKey && g == ColorKey[0] ? 0 : 255;
+                }
+                break;
+
+            case PNG_COLOR_TYPE_RGB:
+                for (Uint32 x = 0; x < Width; ++x)
+                {
+                    const Uint8* pRGB = pRow + x * 3;
+                    pDst[x * 4 + 0]   = pRGB[0];
+                    pDst[x * 4 + 1]   = pRGB[1];
+                    pDst[x * 4 + 2]   = pRGB[2];
+                    pDst[x * 4 + 3]   = HasColorKey && pRGB[0] == ColorKey[0] && pRGB[1] == ColorKey[1] && pRGB[2] == ColorKey[2] ? 0 : 255;
+                }
+                break;
+
+            case PNG_COLOR_TYPE_PALETTE:
+                for (Uint32 x = 0; x < Width; ++x)
+                    memcpy(pDst + x * 4, Palette[pRow[x]], 4);
+                break;
+
+            case PNG_COLOR_TYPE_GRAY_ALPHA:
+                for (Uint32 x = 0; x < Width; ++x)
+                {
+                    const Uint8 g   = pRow[x * 2];
+                    pDst[x * 4 + 0] = g;
+                    pDst[x * 4 + 1] = g;
+                    pDst[x * 4 + 2] = g;
+                    pDst[x * 4 + 3] = pRow[x * 2 + 1];
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    size_t Offset = 0;
+    for (Uint32 mip = 0; mip < Desc.MipLevels; ++mip)
+    {
+        const auto MipProps = GetMipLevelProperties(Desc, mip);
+        Uint8*     pMip     = Texture.Data.data() + Offset;
+        if (mip > 0)
+        {
+            const auto PrevProps = GetMipLevelProperties(Desc, mip - 1);
+            ComputeMipLevel(static_cast<const Uint8*>(Texture.Mips[mip - 1].pData),
+                            PrevProps.LogicalWidth, PrevProps.LogicalHeight, static_cast<size_t>(PrevProps.RowSize),
+                            pMip, MipProps.LogicalWidth, MipProps.LogicalHeight, static_cast<size_t>(MipProps.RowSize), IsSRGB);
+        }
+        Texture.Mips[mip] = TextureSubResData{pMip, MipProps.RowSize};
+        Offset += static_cast<size_t>(MipProps.MipSize);
+    }
+    return true;
+}
+
+} // namespace Diligent
@@ -0,0 +1,53 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "Texture.h"
+
+namespace Diligent
+{
+
+// RGBA8 texture with the full mip chain, decoded by DecodePngTexture()
+struct DecodedPngTexture
+{
+    TextureDesc                    Desc;
+    std::vector<Uint8>             Data; // All mip levels, tightly packed in the upload layout
+    std::vector<TextureSubResData> Mips;
+};
+
+// Fast path for the PNG files used by the sample: 8-bit, non-interlaced gray, gray-alpha,
+// RGB, RGBA and palette images. The image is inflated and unfiltered straight into the
+// level 0 of the texture data, which is then passed to the upload as is, and the mip chain
+// is generated with a box filter (in linear space for sRGB textures). Chunk CRCs and the
+// zlib checksum are not verified.
+// Returns false for other files, which must go through the texture loader.
+bool DecodePngTexture(const void* pData, size_t Size, bool IsSRGB, DecodedPngTexture& Texture);
+
+} // namespace Diligent
@@ -0,0 +1,321 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "RenderGraph.hpp"
+
+#include <algorithm>
+
+namespace Diligent
+{
+
+namespace
+{
+
+bool IsCompatible(const TextureDesc& Desc1, const TextureDesc& Desc2)
+{
+    // clang-format off
+    return Desc1.Type        == Desc2.Type        &&
+           Desc1.Width       == Desc2.Width       &&
+           Desc1.Height      == Desc2.Height      &&
+           Desc1.ArraySize   == Desc2.ArraySize   &&
+           Desc1.Format      == Desc2.Format      &&
+           Desc1.MipLevels   == Desc2.MipLevels   &&
+           Desc1.SampleCount == Desc2.SampleCount &&
+           Desc1.Usage       == Desc2.Usage       &&
+           Desc1.BindFlags   == Desc2.BindFlags;
+    // clang-format on
+}
+
+} // namespace
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Read(RGResourceId Id, RESOURCE_STATE State)
+{
+    m_Graph.AddAccess(m_PassIdx, Id, State, false);
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Write(RGResourceId Id, RESOURCE_STATE State)
+{
+    m_Graph.AddAccess(m_PassIdx, Id, State, true);
+    return *this;
+}
+
+RGResourceId RenderGraph::ImportTexture(ITexture* pTexture)
+{
+    Resource Res;
+    Res.pTexture = pTexture;
+    m_Resources.emplace_back(std::move(Res));
+    m_IsCompiled = false;
+    return static_cast<RGResourceId>(m_Resources.size() - 1);
+}
+
+RGResourceId RenderGraph::ImportBuffer(IBuffer* pBuffer)
+{
+    Resource Res;
+    Res.pBuffer = pBuffer;
+    m_Resources.emplace_back(std::move(Res));
+    m_IsCompiled = false;
+    return static_cast<RGResourceId>(m_Resources.size() - 1);
+}
+
+void RenderGraph::SetImportedTexture(RGResourceId Id, ITexture* pTexture)
+{
+    VERIFY_EXPR(Id < m_Resources.size() && !m_Resources[Id].IsTransient);
+    m_Resources[Id].pTexture = pTexture;
+}
+
+RGResourceId RenderGraph::CreateTransientTexture(const TextureDesc& Desc)
+{
+    Resource Res;
+    Res.IsTransient = true;
+    Res.Desc        = Desc;
+    Res.Name        = Desc.Name != nullptr ? Desc.Name : "Transient texture";
+    Res.Desc.Name   = nullptr;
+    m_Resources.emplace_back(std::move(Res));
+    m_IsCompiled = false;
+    return static_cast<RGResourceId>(m_Resources.size() - 1);
+}
+
+RenderGraph::PassBuilder RenderGraph::AddPass(const char* Name, ExecuteFunc Execute)
+{
+    Pass NewPass;
+    NewPass.Name    = Name;
+    NewPass.Execute = std::move(Execute);
+    m_Passes.emplace_back(std::move(NewPass));
+    m_IsCompiled = false;
+    return PassBuilder{*this, m_Passes.size() - 1};
+}
+
+void RenderGraph::AddAccess(size_t PassIdx, RGResourceId Id, RESOURCE_STATE State, bool IsWrite)
+{
+    VERIFY_EXPR(Id < m_Resources.size());
+    auto& Accesses = m_Passes[PassIdx].Accesses;
+    for (auto& Acc : Accesses)
+    {
+        if (Acc.Id == Id)
+        {
+            // A resource may be bound in several read states by the same pass
+            VERIFY(!IsWrite && !Acc.IsWrite, "A resource that is written by a pass can't be accessed by the same pass in another state");
+            Acc.State = static_cast<RESOURCE_STATE>(Acc.State | State);
+            return;
+        }
+    }
+    Accesses.push_back({Id, State, IsWrite});
+}
+
+void RenderGraph::Reset()
+{
+    m_Resources.clear();
+    m_Passes.clear();
+    m_IsCompiled = false;
+}
+
+void RenderGraph::Compile(IRenderDevice* pDevice)
+{
+    // Lifetimes of transient textures
+    for (auto& Res : m_Resources)
+    {
+        Res.FirstPass = ~size_t{0};
+        Res.LastPass  = 0;
+    }
+    for (size_t p = 0; p < m_Passes.size(); ++p)
+    {
+        for (const auto& Acc : m_Passes[p].Accesses)
+        {
+            auto& Res     = m_Resources[Acc.Id];
+            Res.FirstPass = std::min(Res.FirstPass, p);
+            Res.LastPass  = std::max(Res.LastPass, p);
+        }
+    }
+
+    AllocateTransients(pDevice);
+
+    // A barrier is only required where the state of a resource changes. The state a resource
+    // is in when the graph starts is not known, so the first access of every resource is
+    // transitioned from the state recorded by the engine.
+    std::vector<RESOURCE_STATE> States(m_Resources.size(), RESOURCE_STATE_UNKNOWN);
+    m_NumBarriers = 0;
+    for (auto& CurrPass : m_Passes)
+    {
+        CurrPass.Barriers.clear();
+        for (const auto& Acc : CurrPass.Accesses)
+        {
+            auto& State = States[Acc.Id];
+            if (State == Acc.State)
+                continue;
+
+            // The previous contents of a transient texture are never needed
+            const bool Discard = m_Resources[Acc.Id].IsTransient && State == RESOURCE_STATE_UNKNOWN;
+            CurrPass.Barriers.push_back({Acc.Id, Acc.State, Discard});
+            State = Acc.State;
+        }
+        m_NumBarriers += static_cast<Uint32>(CurrPass.Barriers.size());
+    }
+
+    m_IsCompiled = true;
+}
+
+std::vector<Uint32> RenderGraph::AssignPhysicalTextures(const std::vector<TransientLifetime>& Transients,
+                                                        std::vector<TextureDesc>&             PhysicalDescs)
+{
+    std::vector<Uint32> Order(Transients.size());
+    for (Uint32 i = 0; i < Order.size(); ++i)
+        Order[i] = i;
+    std::stable_sort(Order.begin(), Order.end(), [&Transients](Uint32 Idx1, Uint32 Idx2) {
+        return Transients[Idx1].FirstPass < Transients[Idx2].FirstPass;
+    });
+
+    // Index of the last pass that uses each physical texture in the current graph
+    std::vector<size_t> LastPass(PhysicalDescs.size(), 0);
+    std::vector<bool>   InUse(PhysicalDescs.size(), false);
+    std::vector<Uint32> Assignment(Transients.size(), ~0u);
+
+    // Greedy interval assignment: a physical texture is reused once the last pass of
+    // the texture it currently holds precedes the first pass of the new one.
+    for (Uint32 Idx : Order)
+    {
+        const auto& Transient = Transients[Idx];
+
+        Uint32 PhysIdx = 0;
+        for (; PhysIdx < PhysicalDescs.size(); ++PhysIdx)
+        {
+            if ((!InUse[PhysIdx] || LastPass[PhysIdx] < Transient.FirstPass) && IsCompatible(PhysicalDescs[PhysIdx], Transient.Desc))
+                break;
+        }
+        if (PhysIdx == PhysicalDescs.size())
+        {
+            PhysicalDescs.push_back(Transient.Desc);
+            LastPass.push_back(0);
+            InUse.push_back(false);
+        }
+
+        InUse[PhysIdx]    = true;
+        LastPass[PhysIdx] = Transient.LastPass;
+        Assignment[Idx]   = PhysIdx;
+    }
+    return Assignment;
+}
+
+void RenderGraph::AllocateTransients(IRenderDevice* pDevice)
+{
+    std::vector<RGResourceId>      Transients;
+    std::vector<TransientLifetime> Lifetimes;
+    for (RGResourceId Id = 0; Id < m_Resources.size(); ++Id)
+    {
+        auto& Res       = m_Resources[Id];
+        Res.PhysicalIdx = ~0u;
+        // Transient textures that no pass uses are never allocated
+        if (Res.IsTransient && Res.FirstPass != ~size_t{0})
+        {
+            Transients.push_back(Id);
+            Lifetimes.push_back({Res.Desc, Res.FirstPass, Res.LastPass});
+        }
+    }
+    m_NumTransients = static_cast<Uint32>(Transients.size());
+
+    std::vector<TextureDesc> PhysicalDescs;
+    PhysicalDescs.reserve(m_PhysicalTextures.size());
+    for (const auto& pPhysTexture : m_PhysicalTextures)
+        PhysicalDescs.push_back(pPhysTexture->GetDesc());
+    const auto Assignment = AssignPhysicalTextures(Lifetimes, PhysicalDescs);
+
+    for (size_t i = m_PhysicalTextures.size(); i < PhysicalDescs.size(); ++i)
+    {
+        const std::string Name = "Render graph texture " + std::to_string(i);
+
+        TextureDesc Desc = PhysicalDescs[i];
+        Desc.Name        = Name.c_str();
+
+        RefCntAutoPtr<ITexture> pPhysTexture;
+        pDevice->CreateTexture(Desc, nullptr, &pPhysTexture);
+        m_PhysicalTextures.emplace_back(std::move(pPhysTexture));
+    }
+
+    // Release the textures that are not needed by the new graph
+    std::vector<bool> InUse(m_PhysicalTextures.size(), false);
+    for (Uint32 PhysIdx : Assignment)
+        InUse[PhysIdx] = true;
+
+    std::vector<Uint32> Remap(m_PhysicalTextures.size(), ~0u);
+    Uint32              NumUsed = 0;
+    for (Uint32 i = 0; i < m_PhysicalTextures.size(); ++i)
+    {
+        if (!InUse[i])
+            continue;
+        Remap[i] = NumUsed;
+        if (i != NumUsed)
+            m_PhysicalTextures[NumUsed] = std::move(m_PhysicalTextures[i]);
+        ++NumUsed;
+    }
+    m_PhysicalTextures.resize(NumUsed);
+    for (size_t i = 0; i < Transients.size(); ++i)
+        m_Resources[Transients[i]].PhysicalIdx = Remap[Assignment[i]];
+}
+
+void RenderGraph::Execute(IDeviceContext* pContext)
+{
+    VERIFY(m_IsCompiled, "The graph must be compiled before it is executed");
+
+    for (const auto& CurrPass : m_Passes)
+    {
+        if (!CurrPass.Barriers.empty())
+        {
+            m_BarrierScratch.clear();
+            for (const auto& Barrier : CurrPass.Barriers)
+            {
+                STATE_TRANSITION_FLAGS Flags = STATE_TRANSITION_FLAG_UPDATE_STATE;
+                if (Barrier.DiscardContent)
+                    Flags |= STATE_TRANSITION_FLAG_DISCARD_CONTENT;
+
+                const auto& Res = m_Resources[Barrier.Id];
+                if (Res.pBuffer)
+                    m_BarrierScratch.emplace_back(Res.pBuffer, RESOURCE_STATE_UNKNOWN, Barrier.NewState, Flags);
+                else
+                    m_BarrierScratch.emplace_back(GetTexture(Barrier.Id), RESOURCE_STATE_UNKNOWN, Barrier.NewState, Flags);
+            }
+            pContext->TransitionResourceStates(static_cast<Uint32>(m_BarrierScratch.size()), m_BarrierScratch.data());
+        }
+
+        if (CurrPass.Execute)
+            CurrPass.Execute(pContext, *this);
+    }
+}
+
+ITexture* RenderGraph::GetTexture(RGResourceId Id) const
+{
+    VERIFY_EXPR(Id < m_Resources.size());
+    const auto& Res = m_Resources[Id];
+    return Res.IsTransient ? m_PhysicalTextures[Res.PhysicalIdx].RawPtr() : Res.pTexture.RawPtr();
+}
+
+IBuffer* RenderGraph::GetBuffer(RGResourceId Id) const
+{
+    VERIFY_EXPR(Id < m_Resources.size());
+    return m_Resources[Id].pBuffer;
+}
+
+} // namespace Diligent
@@ -0,0 +1,163 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+using RGResourceId = Uint32;
+
+static constexpr RGResourceId InvalidRGResource = ~0u;
+
+// Minimal render graph. Passes declare the resources they read and write together with the
+// required states. Compile() computes the barriers between passes once, so pass callbacks can
+// bind resources with RESOURCE_STATE_TRANSITION_MODE_VERIFY. Transient textures are created by
+// the graph, and textures whose lifetimes do not overlap share the same physical texture.
+class RenderGraph
+{
+public:
+    using ExecuteFunc = std::function<void(IDeviceContext* pContext, const RenderGraph& Graph)>;
+
+    class PassBuilder
+    {
+    public:
+        PassBuilder& Read(RGResourceId Id, RESOURCE_STATE State);
+        PassBuilder& Write(RGResourceId Id, RESOURCE_STATE State);
+
+    private:
+        friend RenderGraph;
+        PassBuilder(RenderGraph& Graph, size_t PassIdx) :
+            m_Graph{Graph},
+            m_PassIdx{PassIdx}
+        {}
+
+        RenderGraph& m_Graph;
+        const size_t m_PassIdx;
+    };
+
+    // Resources owned outside of the graph. The object may be replaced between frames with
+    // SetImportedTexture() without recompiling the graph (e.g. the current back buffer).
+    RGResourceId ImportTexture(ITexture* pTexture);
+    RGResourceId ImportBuffer(IBuffer* pBuffer);
+    void         SetImportedTexture(RGResourceId Id, ITexture* pTexture);
+
+    // Texture that only lives within the frame. Its contents are undefined at the first access.
+    RGResourceId CreateTransientTexture(const TextureDesc& Desc);
+
+    PassBuilder AddPass(const char* Name, ExecuteFunc Execute);
+
+    // Removes all passes and resources. Physical transient textures are kept for reuse.
+    void Reset();
+
+    // Computes resource lifetimes, assigns physical textures and precomputes the barriers.
+    void Compile(IRenderDevice* pDevice);
+
+    void Execute(IDeviceContext* pContext);
+
+    ITexture* GetTexture(RGResourceId Id) const;
+    IBuffer*  GetBuffer(RGResourceId Id) const;
+
+    Uint32 GetNumPasses() const { return static_cast<Uint32>(m_Passes.size()); }
+    Uint32 GetNumTransientTextures() const { return m_NumTransients; }
+    Uint32 GetNumPhysicalTextures() const { return static_cast<Uint32>(m_PhysicalTextures.size()); }
+    Uint32 GetNumBarriers() const { return m_NumBarriers; }
+
+    struct TransientLifetime
+    {
+        TextureDesc Desc;
+        size_t      FirstPass = 0;
+        size_t      LastPass  = 0;
+    };
+
+    // Assigns a physical texture to every transient texture. Textures with compatible descriptions
+    // share a physical texture if their lifetimes do not overlap; the physical textures given in
+    // PhysicalDescs are reused first. The descriptions of the physical textures that must be created
+    // are appended to PhysicalDescs. Returns the physical texture index of every transient texture.
+    static std::vector<Uint32> AssignPhysicalTextures(const std::vector<TransientLifetime>& Transients,
+                                                      std::vector<TextureDesc>&             PhysicalDescs);
+
+private:
+    struct Resource
+    {
+        RefCntAutoPtr<ITexture> pTexture;
+        RefCntAutoPtr<IBuffer>  pBuffer;
+
+        // Transient textures only
+        bool        IsTransient = false;
+        TextureDesc Desc;
+        std::string Name;
+        size_t      FirstPass   = ~size_t{0};
+        size_t      LastPass    = 0;
+        Uint32      PhysicalIdx = ~0u;
+    };
+
+    struct Access
+    {
+        RGResourceId   Id;
+        RESOURCE_STATE State;
+        bool           IsWrite;
+    };
+
+    struct Barrier
+    {
+        RGResourceId   Id;
+        RESOURCE_STATE NewState;
+        bool           DiscardContent;
+    };
+
+    struct Pass
+    {
+        std::string          Name;
+        ExecuteFunc          Execute;
+        std::vector<Access>  Accesses;
+        std::vector<Barrier> Barriers;
+    };
+
+    void AddAccess(size_t PassIdx, RGResourceId Id, RESOURCE_STATE State, bool IsWrite);
+    void AllocateTransients(IRenderDevice* pDevice);
+
+    std::vector<Resource>                m_Resources;
+    std::vector<Pass>                    m_Passes;
+    std::vector<RefCntAutoPtr<ITexture>> m_PhysicalTextures;
+
+    std::vector<StateTransitionDesc> m_BarrierScratch;
+
+    Uint32 m_NumTransients = 0;
+    Uint32 m_NumBarriers   = 0;
+    bool   m_IsCompiled    = false;
+};
+
+} // namespace Diligent
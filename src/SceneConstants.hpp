@@ -0,0 +1,87 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include "BasicMath.hpp"
+
+namespace Diligent
+{
+
+// Layout of the 'Constants' buffer of cube_inst.vsh
+struct VSConstants
+{
+    float4x4 ViewProj;
+    float4x4 Rotation;
+    float4   Time; // x - time in seconds, y - cross-fade flag
+};
+
+// Maximum number of texture indices that can be remapped to array slices
+static constexpr Uint32 MaxTextureSlices = 16;
+
+// Layout of the 'TextureSlices' buffer of cube_inst.vsh: the array slice of every texture
+// index, four per element. Texture indices of instances and flipbooks refer to the source
+// images, and duplicate images are loaded into a single slice.
+struct TextureSliceRemap
+{
+    float4 Slices[MaxTextureSlices / 4];
+};
+
+// Builds the view matrix of a camera orbiting the target point.
+inline float4x4 ComputeOrbitViewMatrix(float Yaw, float Pitch, float Distance, const float3& Target)
+{
+    float3 Offset;
+    Offset.x = Distance * cosf(Pitch) * sinf(Yaw);
+    Offset.y = Distance * sinf(Pitch);
+    Offset.z = Distance * cosf(Pitch) * cosf(Yaw);
+
+    const float3 CameraPos = Target + Offset;
+    const float3 Forward   = normalize(Target - CameraPos);
+    const float3 Right     = normalize(cross(float3(0.0f, 1.0f, 0.0f), Forward));
+    const float3 CamUp     = cross(Forward, Right);
+
+    float4x4 View;
+    View._11 = Right.x;
+    View._12 = CamUp.x;
+    View._13 = Forward.x;
+    View._14 = 0.0f;
+    View._21 = Right.y;
+    View._22 = CamUp.y;
+    View._23 = Forward.y;
+    View._24 = 0.0f;
+    View._31 = Right.z;
+    View._32 = CamUp.z;
+    View._33 = Forward.z;
+    View._34 = 0.0f;
+    View._41 = -dot(Right, CameraPos);
+    View._42 = -dot(CamUp, CameraPos);
+    View._43 = -dot(Forward, CameraPos);
+    View._44 = 1.0f;
+    return View;
+}
+
+} // namespace Diligent
@@ -0,0 +1,308 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "SharedSceneFeed.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Align.hpp"
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+constexpr Uint32 FeedMagic   = 0x44464354; // 'TCFD'
+constexpr Uint32 FeedVersion = 2;
+
+static_assert(std::atomic<Uint32>::is_always_lock_free, "Shared atomics must be lock-free to work across processes");
+
+struct SlotHeader
+{
+    // Odd while the producer is writing the slot
+    std::atomic<Uint32> SeqLock;
+    Uint32              NumInstances;
+    Uint64              FrameId;
+};
+
+std::string GetShmName(const char* Name)
+{
+    return Name[0] == '/' ? std::string{Name} : std::string{"/"} + Name;
+}
+
+bool IsProcessAlive(pid_t Pid)
+{
+    return kill(Pid, 0) == 0 || errno != ESRCH;
+}
+
+} // namespace
+
+struct SharedSceneFeed::Header
+{
+    Uint32 Magic;
+    Uint32 Version;
+    Uint32 MaxInstances;
+    Uint32 InstanceSize;
+    // Process that created the object. A producer that crashed does not unlink it.
+    pid_t ProducerPid;
+
+    // Slot holding the most recent complete snapshot
+    std::atomic<Uint32> LatestSlot;
+    // Number of published frames
+    std::atomic<Uint32> FrameCounter;
+
+    static size_t GetSlotSize(Uint32 MaxInstances)
+    {
+        return AlignUp(sizeof(SlotHeader) + sizeof(InstanceData) * MaxInstances, size_t{64});
+    }
+
+    static size_t GetHeaderSize()
+    {
+        return AlignUp(sizeof(Header), size_t{64});
+    }
+
+    static size_t GetMappingSize(Uint32 MaxInstances)
+    {
+        return GetHeaderSize() + GetSlotSize(MaxInstances) * NumSlots;
+    }
+
+    SlotHeader* GetSlot(Uint32 Slot)
+    {
+        return reinterpret_cast<SlotHeader*>(reinterpret_cast<Uint8*>(this) + GetHeaderSize() + GetSlotSize(MaxInstances) * Slot);
+    }
+
+    InstanceData* GetSlotInstances(Uint32 Slot)
+    {
+        return reinterpret_cast<InstanceData*>(GetSlot(Slot) + 1);
+    }
+};
+
+SharedSceneFeed::SharedSceneFeed(std::string Name, int Fd, void* pMapping, size_t MappingSize, bool IsProducer) :
+    m_Name{std::move(Name)},
+    m_Fd{Fd},
+    m_pMapping{pMapping},
+    m_MappingSize{MappingSize},
+    m_IsProducer{IsProducer}
+{
+}
+
+SharedSceneFeed::~SharedSceneFeed()
+{
+    munmap(m_pMapping, m_MappingSize);
+    close(m_Fd);
+    if (m_IsProducer)
+        shm_unlink(m_Name.c_str());
+}
+
+std::unique_ptr<SharedSceneFeed> SharedSceneFeed::Create(const char* Name, Uint32 MaxInstances)
+{
+    const auto ShmName = GetShmName(Name);
+    shm_unlink(ShmName.c_str());
+
+    const int Fd = shm_open(ShmName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (Fd < 0)
+    {
+        LOG_ERROR_MESSAGE("Failed to create shared memory object '", ShmName, "': ", strerror(errno));
+        return {};
+    }
+
+    const size_t MappingSize = Header::GetMappingSize(MaxInstances);
+    if (ftruncate(Fd, static_cast<off_t>(MappingSize)) != 0)
+    {
+        LOG_ERROR_MESSAGE("Failed to resize shared memory object '", ShmName, "': ", strerror(errno));
+        close(Fd);
+        shm_unlink(ShmName.c_str());
+        return {};
+    }
+
+    void* pMapping = mmap(nullptr, MappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+    if (pMapping == MAP_FAILED)
+    {
+        LOG_ERROR_MESSAGE("Failed to map shared memory object '", ShmName, "': ", strerror(errno));
+        close(Fd);
+        shm_unlink(ShmName.c_str());
+        return {};
+    }
+
+    // The object is zero-initialized by ftruncate, so all slots start unlocked and empty
+    auto* pHeader         = static_cast<Header*>(pMapping);
+    pHeader->Version      = FeedVersion;
+    pHeader->MaxInstances = MaxInstances;
+    pHeader->InstanceSize = sizeof(InstanceData);
+    pHeader->ProducerPid  = getpid();
+    // Publish the magic last so that a consumer never sees a partially initialized header
+    std::atomic_thread_fence(std::memory_order_release);
+    pHeader->Magic = FeedMagic;
+
+    return std::unique_ptr<SharedSceneFeed>{new SharedSceneFeed{ShmName, Fd, pMapping, MappingSize, true}};
+}
+
+std::unique_ptr<SharedSceneFeed> SharedSceneFeed::Open(const char* Name)
+{
+    const auto ShmName = GetShmName(Name);
+
+    const int Fd = shm_open(ShmName.c_str(), O_RDWR, 0);
+    if (Fd < 0)
+    {
+        // The producer may simply not have started yet
+        if (errno != ENOENT)
+            LOG_ERROR_MESSAGE("Failed to open shared memory object '", ShmName, "': ", strerror(errno));
+        return {};
+    }
+
+    struct stat Stat = {};
+    if (fstat(Fd, &Stat) != 0 || static_cast<size_t>(Stat.st_size) < sizeof(Header))
+    {
+        LOG_ERROR_MESSAGE("Shared memory object '", ShmName, "' is not a scene feed");
+        close(Fd);
+        return {};
+    }
+
+    const size_t MappingSize = static_cast<size_t>(Stat.st_size);
+    void*        pMapping    = mmap(nullptr, MappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+    if (pMapping == MAP_FAILED)
+    {
+        LOG_ERROR_MESSAGE("Failed to map shared memory object '", ShmName, "': ", strerror(errno));
+        close(Fd);
+        return {};
+    }
+
+    const auto* pHeader = static_cast<const Header*>(pMapping);
+    if (pHeader->Magic != FeedMagic ||
+        pHeader->Version != FeedVersion ||
+        pHeader->InstanceSize != sizeof(InstanceData) ||
+        pHeader->MaxInstances == 0 ||
+        Header::GetMappingSize(pHeader->MaxInstances) > MappingSize)
+    {
+        LOG_ERROR_MESSAGE("Shared memory object '", ShmName, "' has incompatible layout");
+        munmap(pMapping, MappingSize);
+        close(Fd);
+        return {};
+    }
+
+    // The object of a crashed producer is left behind until the producer is restarted
+    if (!IsProcessAlive(pHeader->ProducerPid))
+    {
+        munmap(pMapping, MappingSize);
+        close(Fd);
+        return {};
+    }
+
+    return std::unique_ptr<SharedSceneFeed>{new SharedSceneFeed{ShmName, Fd, pMapping, MappingSize, false}};
+}
+
+bool SharedSceneFeed::IsStale() const
+{
+    VERIFY(!m_IsProducer, "Only the consumer may check the feed");
+
+    // A restarted producer unlinks the object and creates a new one with the same name
+    const int Fd = shm_open(m_Name.c_str(), O_RDONLY, 0);
+    if (Fd < 0)
+        return errno == ENOENT;
+
+    struct stat Current = {};
+    struct stat Mapped  = {};
+    const bool  IsSame  = fstat(Fd, &Current) == 0 && fstat(m_Fd, &Mapped) == 0 &&
+        Current.st_dev == Mapped.st_dev && Current.st_ino == Mapped.st_ino;
+    close(Fd);
+    if (!IsSame)
+        return true;
+
+    return !IsProcessAlive(GetHeader()->ProducerPid);
+}
+
+Uint32 SharedSceneFeed::GetMaxInstances() const
+{
+    return GetHeader()->MaxInstances;
+}
+
+InstanceData* SharedSceneFeed::BeginWrite()
+{
+    VERIFY(m_IsProducer, "Only the producer may write the feed");
+
+    auto* pHeader = GetHeader();
+    // Never write the slot that was published last: the consumer is most likely reading it
+    m_WriteSlot = (pHeader->LatestSlot.load(std::memory_order_relaxed) + 1) % NumSlots;
+
+    auto* pSlot = pHeader->GetSlot(m_WriteSlot);
+    pSlot->SeqLock.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return pHeader->GetSlotInstances(m_WriteSlot);
+}
+
+void SharedSceneFeed::EndWrite(Uint32 NumInstances)
+{
+    auto* pHeader = GetHeader();
+    auto* pSlot   = pHeader->GetSlot(m_WriteSlot);
+
+    pSlot->NumInstances = std::min(NumInstances, pHeader->MaxInstances);
+    pSlot->FrameId      = pHeader->FrameCounter.load(std::memory_order_relaxed) + 1;
+    pSlot->SeqLock.fetch_add(1, std::memory_order_release);
+
+    pHeader->LatestSlot.store(m_WriteSlot, std::memory_order_release);
+    pHeader->FrameCounter.fetch_add(1, std::memory_order_release);
+}
+
+bool SharedSceneFeed::ReadLatest(InstanceData* pDst, Uint32& NumInstances, Uint64& FrameId) const
+{
+    auto* pHeader = GetHeader();
+
+    // The producer has to lap the ring to overwrite the slot being read, so a few
+    // attempts are enough unless the producer is much faster than the consumer.
+    constexpr int MaxAttempts = 4;
+    for (int Attempt = 0; Attempt < MaxAttempts; ++Attempt)
+    {
+        const Uint32 Slot  = pHeader->LatestSlot.load(std::memory_order_acquire);
+        auto*        pSlot = pHeader->GetSlot(Slot);
+
+        const Uint32 Seq0 = pSlot->SeqLock.load(std::memory_order_acquire);
+        if (Seq0 & 1u)
+            continue;
+
+        NumInstances = std::min(pSlot->NumInstances, pHeader->MaxInstances);
+        FrameId      = pSlot->FrameId;
+        memcpy(pDst, pHeader->GetSlotInstances(Slot), sizeof(InstanceData) * NumInstances);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (pSlot->SeqLock.load(std::memory_order_relaxed) == Seq0)
+            return true;
+    }
+
+    return false;
+}
+
+} // namespace Diligent
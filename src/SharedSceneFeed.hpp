@@ -0,0 +1,87 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "InstanceData.hpp"
+
+namespace Diligent
+{
+
+// Instance transforms shared between processes through a POSIX shared memory object.
+// The producer writes complete snapshots into a ring of slots, each protected by a
+// sequence lock, and publishes the latest slot; the consumer copies the latest complete
+// snapshot without ever blocking the producer. The consumer polls the feed once per
+// frame, so publishing does not signal it.
+class SharedSceneFeed
+{
+public:
+    static constexpr Uint32 NumSlots = 3;
+
+    // Producer side: creates the shared memory object, replacing an existing one with the same name.
+    static std::unique_ptr<SharedSceneFeed> Create(const char* Name, Uint32 MaxInstances);
+
+    // Consumer side: opens the shared memory object created by the producer.
+    // Returns null without reporting an error if the object does not exist or its producer has exited.
+    static std::unique_ptr<SharedSceneFeed> Open(const char* Name);
+
+    ~SharedSceneFeed();
+
+    // Producer side. Returns storage for the next snapshot; call EndWrite() to publish it.
+    InstanceData* BeginWrite();
+    void          EndWrite(Uint32 NumInstances);
+
+    // Consumer side. Copies the latest complete snapshot to pDst, which must have space
+    // for GetMaxInstances() elements. Returns false if no consistent snapshot could be read,
+    // in which case the contents of pDst are undefined.
+    bool ReadLatest(InstanceData* pDst, Uint32& NumInstances, Uint64& FrameId) const;
+
+    // Consumer side. Returns true if the producer has exited or replaced the shared memory object
+    // after a restart, in which case the feed must be opened again.
+    bool IsStale() const;
+
+    Uint32 GetMaxInstances() const;
+
+private:
+    struct Header;
+
+    SharedSceneFeed(std::string Name, int Fd, void* pMapping, size_t MappingSize, bool IsProducer);
+
+    Header* GetHeader() const { return static_cast<Header*>(m_pMapping); }
+
+    const std::string m_Name;
+    const int         m_Fd;
+    void* const       m_pMapping;
+    const size_t      m_MappingSize;
+    const bool        m_IsProducer;
+    Uint32            m_WriteSlot = 0;
+};
+
+} // namespace Diligent
@@ -0,0 +1,130 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "StartupGraph.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "ThreadPool.hpp"
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+StartupGraph::TaskId StartupGraph::AddTask(const char* Name, std::function<void()> Handler, std::initializer_list<TaskId> Prerequisites)
+{
+    const auto Id = static_cast<TaskId>(m_Tasks.size());
+
+    Task T;
+    T.Name    = Name;
+    T.Handler = std::move(Handler);
+    for (TaskId Prerequisite : Prerequisites)
+    {
+        VERIFY(Prerequisite < Id, "Prerequisites must be added before the task");
+        T.Prerequisites.push_back(Prerequisite);
+    }
+    m_Tasks.emplace_back(std::move(T));
+    return Id;
+}
+
+void StartupGraph::RunTask(Task& T, Uint32 ThreadId)
+{
+    using Ms       = std::chrono::duration<double, std::milli>;
+    const auto Now = []() { return std::chrono::high_resolution_clock::now(); };
+
+    T.ThreadId = ThreadId;
+    T.StartMs  = Ms{Now() - m_StartTime}.count();
+    T.Handler();
+    T.EndMs = Ms{Now() - m_StartTime}.count();
+}
+
+void StartupGraph::Execute(bool Parallel)
+{
+    m_Parallel  = Parallel;
+    m_StartTime = std::chrono::high_resolution_clock::now();
+    if (Parallel && m_Tasks.size() > 1)
+    {
+        // Tasks are enqueued in the order they were added, so the prerequisites of a task are
+        // always in the pool before the task itself
+        ThreadPoolCreateInfo ThreadPoolCI;
+        ThreadPoolCI.NumThreads = static_cast<Uint32>(m_Tasks.size());
+        auto pThreadPool        = CreateThreadPool(ThreadPoolCI);
+
+        std::vector<RefCntAutoPtr<IAsyncTask>> AsyncTasks(m_Tasks.size());
+        for (size_t i = 0; i < m_Tasks.size(); ++i)
+        {
+            std::vector<IAsyncTask*> Prerequisites;
+            for (TaskId Prerequisite : m_Tasks[i].Prerequisites)
+                Prerequisites.push_back(AsyncTasks[Prerequisite]);
+
+            AsyncTasks[i] = EnqueueAsyncWork(pThreadPool, Prerequisites.data(), static_cast<Uint32>(Prerequisites.size()),
+                                             [this, i](Uint32 ThreadId) {
+                                                 RunTask(m_Tasks[i], ThreadId + 1);
+                                                 return ASYNC_TASK_STATUS_COMPLETE;
+                                             });
+        }
+        for (auto& pTask : AsyncTasks)
+            pTask->WaitForCompletion();
+    }
+    else
+    {
+        for (auto& T : m_Tasks)
+            RunTask(T, 0);
+    }
+    m_TotalMs = std::chrono::duration<double, std::milli>{std::chrono::high_resolution_clock::now() - m_StartTime}.count();
+}
+
+void StartupGraph::LogTimeline() const
+{
+    // Every task is drawn as a bar on a common time axis
+    constexpr int BarWidth = 40;
+
+    std::string Timeline;
+    double      SumMs     = 0;
+    double      LongestMs = 0;
+    for (const auto& T : m_Tasks)
+    {
+        const double DurationMs = T.EndMs - T.StartMs;
+        SumMs += DurationMs;
+        LongestMs = std::max(LongestMs, DurationMs);
+
+        char      Bar[BarWidth + 1] = {};
+        const int First             = m_TotalMs > 0 ? static_cast<int>(T.StartMs / m_TotalMs * BarWidth) : 0;
+        const int Last              = m_TotalMs > 0 ? static_cast<int>(T.EndMs / m_TotalMs * BarWidth) : 0;
+        for (int c = 0; c < BarWidth; ++c)
+            Bar[c] = (c >= First && c <= std::min(Last, BarWidth - 1)) ? '#' : '.';
+
+        char Line[256];
+        snprintf(Line, sizeof(Line), "\n  %-16s %8.2f - %8.2f ms  thread %u  |%s|", T.Name.c_str(), T.StartMs, T.EndMs, T.ThreadId, Bar);
+        Timeline += Line;
+    }
+    LOG_INFO_MESSAGE("Startup took ", m_TotalMs, " ms (", m_Parallel ? "parallel" : "sequential", "; sum of tasks ", SumMs,
+                     " ms, longest task ", LongestMs, " ms):", Timeline);
+}
+
+} // namespace Diligent
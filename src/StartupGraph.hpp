@@ -0,0 +1,81 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#include "BasicTypes.h"
+
+namespace Diligent
+{
+
+// Initialization steps expressed as a dependency graph. Every task starts as soon as all of its
+// prerequisites have completed, so the startup time is bounded by the longest chain of tasks
+// rather than by the sum of all of them. Start and end times of every task are recorded for
+// the startup timeline.
+class StartupGraph
+{
+public:
+    using TaskId = Uint32;
+
+    // Prerequisites must have been added before the task
+    TaskId AddTask(const char* Name, std::function<void()> Handler, std::initializer_list<TaskId> Prerequisites = {});
+
+    // Runs all tasks and returns when they have completed. Parallel tasks run on a dedicated
+    // pool with a thread per task, as they block on the work they submit to other pools.
+    // Otherwise, tasks run on the calling thread in the order they were added.
+    void Execute(bool Parallel);
+
+    // Logs the start and end of every task relative to the start of Execute()
+    void LogTimeline() const;
+
+private:
+    struct Task
+    {
+        std::string           Name;
+        std::function<void()> Handler;
+        std::vector<TaskId>   Prerequisites;
+
+        double StartMs  = 0;
+        double EndMs    = 0;
+        Uint32 ThreadId = 0;
+    };
+
+    void RunTask(Task& T, Uint32 ThreadId);
+
+    std::vector<Task>                              m_Tasks;
+    std::chrono::high_resolution_clock::time_point m_StartTime;
+    double                                         m_TotalMs  = 0;
+    bool                                           m_Parallel = false;
+};
+
+} // namespace Diligent
@@ -0,0 +1,78 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "StaticDrawList.hpp"
+
+#include <cstring>
+
+namespace Diligent
+{
+
+void StaticDrawList::Begin()
+{
+    m_Packets.clear();
+    m_IsValid = false;
+}
+
+void StaticDrawList::AddDraw(const DrawPacket& Packet)
+{
+    VERIFY_EXPR(Packet.NumVertexBuffers <= _countof(Packet.pVertexBuffers));
+    m_Packets.push_back(Packet);
+    // Resources are transitioned by the owner of the list before it is replayed
+    m_Packets.back().Attribs.Flags = DRAW_FLAG_NONE;
+}
+
+void StaticDrawList::Replay(IDeviceContext* pContext) const
+{
+    VERIFY(m_IsValid, "Replaying a list that is being built or was invalidated");
+
+    // The first draw always binds everything, as the context state is not known
+    const DrawPacket* pPrev = nullptr;
+    for (const auto& Packet : m_Packets)
+    {
+        if (pPrev == nullptr || pPrev->pPSO != Packet.pPSO)
+            pContext->SetPipelineState(Packet.pPSO);
+
+        if (pPrev == nullptr || pPrev->pSRB != Packet.pSRB || pPrev->pPSO != Packet.pPSO)
+            pContext->CommitShaderResources(Packet.pSRB, RESOURCE_STATE_TRANSITION_MODE_NONE);
+
+        if (pPrev == nullptr || pPrev->NumVertexBuffers != Packet.NumVertexBuffers ||
+            memcmp(pPrev->pVertexBuffers, Packet.pVertexBuffers, sizeof(IBuffer*) * Packet.NumVertexBuffers) != 0)
+        {
+            const Uint64 Offsets[_countof(Packet.pVertexBuffers)] = {};
+            pContext->SetVertexBuffers(0, Packet.NumVertexBuffers, Packet.pVertexBuffers, Offsets, RESOURCE_STATE_TRANSITION_MODE_NONE, SET_VERTEX_BUFFERS_FLAG_NONE);
+        }
+
+        if (pPrev == nullptr || pPrev->pIndexBuffer != Packet.pIndexBuffer)
+            pContext->SetIndexBuffer(Packet.pIndexBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_NONE);
+
+        pContext->DrawIndexed(Packet.Attribs);
+        pPrev = &Packet;
+    }
+}
+
+} // namespace Diligent
@@ -0,0 +1,74 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "DeviceContext.h"
+#include "PipelineState.h"
+#include "ShaderResourceBinding.h"
+
+namespace Diligent
+{
+
+// Draw commands for static content, built once and replayed every frame until invalidated.
+// Diligent command lists can only be executed once, so rather than a recorded command list the
+// list stores the resolved bindings and draw arguments. Replay binds resources without state
+// transitions or verification and skips bindings that are identical to the previous draw.
+class StaticDrawList
+{
+public:
+    struct DrawPacket
+    {
+        IPipelineState*         pPSO              = nullptr;
+        IShaderResourceBinding* pSRB              = nullptr;
+        IBuffer*                pVertexBuffers[2] = {};
+        Uint32                  NumVertexBuffers  = 0;
+        IBuffer*                pIndexBuffer      = nullptr;
+        DrawIndexedAttribs      Attribs;
+    };
+
+    // Starts a new list. The previous packets are discarded.
+    void Begin();
+    void AddDraw(const DrawPacket& Packet);
+    void End() { m_IsValid = true; }
+
+    void Invalidate() { m_IsValid = false; }
+    bool IsValid() const { return m_IsValid; }
+
+    // All resources must already be in the states required by the draws.
+    void Replay(IDeviceContext* pContext) const;
+
+    Uint32 GetNumDraws() const { return static_cast<Uint32>(m_Packets.size()); }
+
+private:
+    std::vector<DrawPacket> m_Packets;
+    bool                    m_IsValid = false;
+};
+
+} // namespace Diligent
@@ -0,0 +1,78 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "TextureReadback.hpp"
+
+namespace Diligent
+{
+
+TextureReadback::TextureReadback(IRenderDevice* pDevice, Uint32 Width, Uint32 Height, TEXTURE_FORMAT Format, Uint32 MaxInFlight)
+{
+    m_StagingDesc.Name           = "Readback staging texture";
+    m_StagingDesc.Type           = RESOURCE_DIM_TEX_2D;
+    m_StagingDesc.Width          = Width;
+    m_StagingDesc.Height         = Height;
+    m_StagingDesc.MipLevels      = 1;
+    m_StagingDesc.Format         = Format;
+    m_StagingDesc.Usage          = USAGE_STAGING;
+    m_StagingDesc.BindFlags      = BIND_NONE;
+    m_StagingDesc.CPUAccessFlags = CPU_ACCESS_READ;
+
+    m_FreeStaging.resize(MaxInFlight);
+    for (auto& pStaging : m_FreeStaging)
+        pDevice->CreateTexture(m_StagingDesc, nullptr, &pStaging);
+
+    FenceDesc FenceCI;
+    FenceCI.Name = "Readback fence";
+    FenceCI.Type = FENCE_TYPE_CPU_WAIT_ONLY;
+    pDevice->CreateFence(FenceCI, &m_pFence);
+}
+
+bool TextureReadback::Enqueue(IDeviceContext*                pContext,
+                              ITexture*                      pSrcTexture,
+                              Uint64                         UserId,
+                              RESOURCE_STATE_TRANSITION_MODE SrcTransitionMode)
+{
+    if (m_FreeStaging.empty())
+        return false;
+
+    PendingReadback Readback;
+    Readback.pStaging = std::move(m_FreeStaging.back());
+    m_FreeStaging.pop_back();
+
+    CopyTextureAttribs CopyAttribs{pSrcTexture, SrcTransitionMode, Readback.pStaging, RESOURCE_STATE_TRANSITION_MODE_TRANSITION};
+    pContext->CopyTexture(CopyAttribs);
+
+    Readback.FenceValue = m_NextFenceValue++;
+    Readback.UserId     = UserId;
+    pContext->EnqueueSignal(m_pFence, Readback.FenceValue);
+
+    m_Pending.emplace_back(std::move(Readback));
+    return true;
+}
+
+} // namespace Diligent
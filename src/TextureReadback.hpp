@@ -0,0 +1,107 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "Fence.h"
+#include "RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+// Asynchronous texture readback through a pool of staging textures. A copy is recorded
+// together with a fence signal, and the staging texture is mapped only after the fence
+// has completed, so the CPU never stalls on the GPU unless it asks to.
+class TextureReadback
+{
+public:
+    TextureReadback(IRenderDevice* pDevice, Uint32 Width, Uint32 Height, TEXTURE_FORMAT Format, Uint32 MaxInFlight);
+
+    // Records a copy of mip 0, slice 0 of pSrcTexture into a free staging texture.
+    // Returns false if all staging textures are in flight.
+    bool Enqueue(IDeviceContext*                pContext,
+                 ITexture*                      pSrcTexture,
+                 Uint64                         UserId,
+                 RESOURCE_STATE_TRANSITION_MODE SrcTransitionMode = RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    // Calls Handler(UserId, const MappedTextureSubresource&) for every completed readback in
+    // submission order. The mapped data is only valid during the call. If WaitForOldest is true,
+    // blocks until the oldest readback is complete. Returns the number of processed readbacks.
+    template <typename HandlerType>
+    Uint32 Poll(IDeviceContext* pContext, HandlerType&& Handler, bool WaitForOldest = false)
+    {
+        if (WaitForOldest && !m_Pending.empty())
+        {
+            pContext->Flush();
+            m_pFence->Wait(m_Pending.front().FenceValue);
+        }
+
+        Uint32       NumProcessed   = 0;
+        const Uint64 CompletedValue = m_pFence->GetCompletedValue();
+        while (!m_Pending.empty() && m_Pending.front().FenceValue <= CompletedValue)
+        {
+            auto Readback = std::move(m_Pending.front());
+            m_Pending.pop_front();
+
+            MappedTextureSubresource MappedData;
+            pContext->MapTextureSubresource(Readback.pStaging, 0, 0, MAP_READ, MAP_FLAG_DO_NOT_WAIT, nullptr, MappedData);
+            if (MappedData.pData != nullptr)
+            {
+                Handler(Readback.UserId, static_cast<const MappedTextureSubresource&>(MappedData));
+                pContext->UnmapTextureSubresource(Readback.pStaging, 0, 0);
+            }
+            m_FreeStaging.emplace_back(std::move(Readback.pStaging));
+            ++NumProcessed;
+        }
+        return NumProcessed;
+    }
+
+    Uint32 GetNumPending() const { return static_cast<Uint32>(m_Pending.size()); }
+
+    const TextureDesc& GetStagingDesc() const { return m_StagingDesc; }
+
+private:
+    struct PendingReadback
+    {
+        RefCntAutoPtr<ITexture> pStaging;
+        Uint64                  FenceValue = 0;
+        Uint64                  UserId     = 0;
+    };
+
+    TextureDesc                          m_StagingDesc;
+    RefCntAutoPtr<IFence>                m_pFence;
+    Uint64                               m_NextFenceValue = 1;
+    std::vector<RefCntAutoPtr<ITexture>> m_FreeStaging;
+    std::deque<PendingReadback>          m_Pending;
+};
+
+} // namespace Diligent
@@ -25,12 +25,29 @@
  *  of the possibility of such damages.
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <random>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
 #include "Tutorial05_TextureArray.hpp"
+#include "SceneConstants.hpp"
+#include "BatchRender.hpp"
+#include "AssetArchiveLoaders.hpp"
+#include "ShaderSourceFactoryUtils.h"
+#include "PngDecoder.hpp"
+#include "StartupGraph.hpp"
+#include "CompiledShaders.hpp"
+#include "Image.h"
 #include "MapHelper.hpp"
 #include "GraphicsUtilities.h"
+#include "GraphicsAccessories.hpp"
 #include "TextureUtilities.h"
 #include "ColorConversion.h"
 #include "../../Common/src/TexturedCube.hpp"
@@ -47,15 +64,273 @@ SampleBase* CreateSample()
 namespace
 {
 
-struct InstanceData
+constexpr const char* CubeShaderFiles[] = {"cube_inst.vsh", "cube_inst.psh"};
+
+std::string GetTextureFileName(Uint32 Slice)
+{
+    std::stringstream FileNameSS;
+    FileNameSS << "DGLogo" << Slice << ".png";
+    return FileNameSS.str();
+}
+
+// Modification times of the shader files, used to detect edits (--hot_reload)
+std::vector<Int64> GetShaderFileTimes()
 {
-    float4x4 Matrix;
-    float    TextureInd = 0;
-};
+    std::vector<Int64> Times;
+    for (const char* File : CubeShaderFiles)
+    {
+        std::error_code Error;
+        const auto      Time = std::filesystem::last_write_time(File, Error);
+        Times.push_back(!Error ? static_cast<Int64>(Time.time_since_epoch().count()) : 0);
+    }
+    return Times;
+}
 
 } // namespace
 
-void Tutorial05_TextureArray::CreatePipelineState()
+Tutorial05_TextureArray::~Tutorial05_TextureArray()
+{
+    StopWorkers();
+}
+
+void Tutorial05_TextureArray::StopWorkers()
+{
+    StopSimulation();
+    StopCapture();
+    // The reload task writes to the sample
+    if (m_ShaderReloadTask)
+    {
+        m_ShaderReloadTask->WaitForCompletion();
+        m_ShaderReloadTask.Release();
+    }
+}
+
+// SampleBase has no way to leave the main loop from Initialize(), so command line modes stop
+// every worker the sample owns and drain the GPU before the process exits
+void Tutorial05_TextureArray::ExitCommandLineMode(bool Succeeded)
+{
+    StopWorkers();
+    m_FileReader.reset();
+    m_pThreadPool.Release();
+    m_pImmediateContext->Flush();
+    m_pImmediateContext->WaitForIdle();
+    std::exit(Succeeded ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+void Tutorial05_TextureArray::ModifyEngineInitInfo(const ModifyEngineInitInfoAttribs& Attribs)
+{
+    SampleBase::ModifyEngineInitInfo(Attribs);
+
+    // Deferred contexts are used to record offscreen scenes in parallel
+    Attribs.EngineCI.NumDeferredContexts = std::max(std::thread::hardware_concurrency(), 3u) - 1;
+
+    // Mip feedback is written by the pixel shader
+    Attribs.EngineCI.Features.PixelUAVWritesAndAtomics = DEVICE_FEATURE_STATE_OPTIONAL;
+
+    // Render to an sRGB back buffer where the backend supports it, so that the output of the pixel
+    // shader is converted to gamma space by the hardware rather than by the shader
+    if (Attribs.DeviceType != RENDER_DEVICE_TYPE_GL && Attribs.DeviceType != RENDER_DEVICE_TYPE_GLES)
+    {
+        auto& ColorFormat = Attribs.SCDesc.ColorBufferFormat;
+        if (ColorFormat == TEX_FORMAT_RGBA8_UNORM)
+            ColorFormat = TEX_FORMAT_RGBA8_UNORM_SRGB;
+        else if (ColorFormat == TEX_FORMAT_BGRA8_UNORM)
+            ColorFormat = TEX_FORMAT_BGRA8_UNORM_SRGB;
+    }
+
+    // Texture uploads use a second immediate context on a transfer queue when the adapter
+    // has one. Only D3D12 and Vulkan expose multiple queues.
+    if (!m_UseTransferQueue || (Attribs.DeviceType != RENDER_DEVICE_TYPE_D3D12 && Attribs.DeviceType != RENDER_DEVICE_TYPE_VULKAN))
+        return;
+
+    auto&  EngineCI    = Attribs.EngineCI;
+    Uint32 NumAdapters = 0;
+    Attribs.pFactory->EnumerateAdapters(EngineCI.GraphicsAPIVersion, NumAdapters, nullptr);
+    if (NumAdapters == 0)
+        return;
+    std::vector<GraphicsAdapterInfo> Adapters(NumAdapters);
+    Attribs.pFactory->EnumerateAdapters(EngineCI.GraphicsAPIVersion, NumAdapters, Adapters.data());
+
+    if (EngineCI.AdapterId == DEFAULT_ADAPTER_ID)
+    {
+        // Queue indices are only valid for a specific adapter, so pick it explicitly:
+        // the first discrete adapter, or the first one if there is none
+        EngineCI.AdapterId = 0;
+        for (Uint32 i = 0; i < NumAdapters; ++i)
+        {
+            if (Adapters[i].Type == ADAPTER_TYPE_DISCRETE)
+            {
+                EngineCI.AdapterId = i;
+                break;
+            }
+        }
+    }
+    if (EngineCI.AdapterId >= NumAdapters)
+        return;
+
+    const auto& AdapterInfo     = Adapters[EngineCI.AdapterId];
+    Uint32      GraphicsQueueId = DEFAULT_QUEUE_ID;
+    Uint32      TransferQueueId = DEFAULT_QUEUE_ID;
+    for (Uint32 q = 0; q < AdapterInfo.NumQueues; ++q)
+    {
+        const auto QueueType = AdapterInfo.Queues[q].QueueType & COMMAND_QUEUE_TYPE_PRIMARY_MASK;
+        if (QueueType == COMMAND_QUEUE_TYPE_GRAPHICS && GraphicsQueueId == DEFAULT_QUEUE_ID)
+            GraphicsQueueId = q;
+        else if (QueueType == COMMAND_QUEUE_TYPE_TRANSFER && TransferQueueId == DEFAULT_QUEUE_ID)
+            TransferQueueId = q;
+    }
+    // Software rasterizers and some integrated adapters only have a graphics queue
+    if (GraphicsQueueId == DEFAULT_QUEUE_ID || TransferQueueId == DEFAULT_QUEUE_ID)
+    {
+        LOG_INFO_MESSAGE("The adapter has no transfer queue; textures are uploaded on the graphics queue");
+        return;
+    }
+
+    m_ImmediateContextCI[0].Name     = "Graphics";
+    m_ImmediateContextCI[0].QueueId  = static_cast<Uint8>(GraphicsQueueId);
+    m_ImmediateContextCI[0].Priority = QUEUE_PRIORITY_HIGH;
+    m_ImmediateContextCI[1].Name     = "Transfer";
+    m_ImmediateContextCI[1].QueueId  = static_cast<Uint8>(TransferQueueId);
+    m_ImmediateContextCI[1].Priority = QUEUE_PRIORITY_MEDIUM;
+
+    EngineCI.NumImmediateContexts  = _countof(m_ImmediateContextCI);
+    EngineCI.pImmediateContextInfo = m_ImmediateContextCI;
+}
+
+SampleBase::CommandLineStatus Tutorial05_TextureArray::ProcessCommandLine(int argc, const char* const* argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--scenes") == 0 && i + 1 < argc)
+        {
+            m_NumScenes = std::max(atoi(argv[++i]), 0);
+            continue;
+        }
+        if (strcmp(argv[i], "--batch_views") == 0 && i + 1 < argc)
+        {
+            m_BatchViewsPath = argv[++i];
+            continue;
+        }
+        if (strcmp(argv[i], "--batch_out") == 0 && i + 1 < argc)
+        {
+            m_BatchOutputDir = argv[++i];
+            continue;
+        }
+        if (strcmp(argv[i], "--batch_size") == 0 && i + 1 < argc)
+        {
+            unsigned int Width = 0, Height = 0;
+            if (sscanf(argv[++i], "%ux%u", &Width, &Height) != 2 || Width == 0 || Height == 0)
+            {
+                LOG_ERROR_MESSAGE("Invalid batch size '", argv[i], "'. Expected <width>x<height>.");
+                return CommandLineStatus::Error;
+            }
+            m_BatchWidth  = Width;
+            m_BatchHeight = Height;
+            continue;
+        }
+        if (strcmp(argv[i], "--scene_feed") == 0 && i + 1 < argc)
+        {
+#if PLATFORM_LINUX
+            m_SceneFeedName = argv[++i];
+#else
+            LOG_WARNING_MESSAGE("Shared-memory scene feed is only supported on Linux");
+            ++i;
+#endif
+            continue;
+        }
+        if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc)
+        {
+            m_CapturePath = argv[++i];
+            continue;
+        }
+        if (strcmp(argv[i], "--validation") == 0 && i + 1 < argc)
+        {
+            m_ValidationMode = atoi(argv[++i]) != 0;
+            continue;
+        }
+        if (strcmp(argv[i], "--static_draws") == 0 && i + 1 < argc)
+        {
+            m_UseStaticDraws = atoi(argv[++i]) != 0;
+            continue;
+        }
+        if (strcmp(argv[i], "--draw_benchmark") == 0 && i + 1 < argc)
+        {
+            m_DrawBenchmarkDraws = static_cast<Uint32>(std::max(atoi(argv[++i]), 1));
+            continue;
+        }
+        if (strcmp(argv[i], "--upload_budget") == 0 && i + 1 < argc)
+        {
+            m_UploadBudget = Uint64{static_cast<Uint32>(std::max(atoi(argv[++i]), 1))} << 10;
+            continue;
+        }
+        if (strcmp(argv[i], "--transfer_queue") == 0 && i + 1 < argc)
+        {
+            m_UseTransferQueue = atoi(argv[++i]) != 0;
+            continue;
+        }
+        if (strcmp(argv[i], "--texture_window") == 0 && i + 1 < argc)
+        {
+            m_TextureLoadWindow = static_cast<Uint32>(std::max(atoi(argv[++i]), 0));
+            continue;
+        }
+        if (strcmp(argv[i], "--fast_png") == 0 && i + 1 < argc)
+        {
+            m_UseFastPngDecoder = atoi(argv[++i]) != 0;
+            continue;
+        }
+        if (strcmp(argv[i], "--decode_benchmark") == 0 && i + 1 < argc)
+        {
+            m_DecodeBenchmarkIterations = static_cast<Uint32>(std::max(atoi(argv[++i]), 1));
+            continue;
+        }
+        if (strcmp(argv[i], "--half_precision") == 0 && i + 1 < argc)
+        {
+            m_UseHalfPrecision = atoi(argv[++i]) != 0;
+            continue;
+        }
+        if (strcmp(argv[i], "--hot_reload") == 0 && i + 1 < argc)
+        {
+            m_HotReload = atoi(argv[++i]) != 0;
+            continue;
+        }
+        if (strcmp(argv[i], "--mip_feedback") == 0 && i + 1 < argc)
+        {
+            const float Window    = static_cast<float>(atof(argv[++i]));
+            m_Variant.MipFeedback = Window > 0;
+            if (Window > 0)
+                m_MipFeedbackWindow = Window;
+            continue;
+        }
+        if (strcmp(argv[i], "--parallel_init") == 0 && i + 1 < argc)
+        {
+            m_ParallelInit = atoi(argv[++i]) != 0;
+            continue;
+        }
+        if (strcmp(argv[i], "--archive") == 0 && i + 1 < argc)
+        {
+            m_ArchivePath = argv[++i];
+            continue;
+        }
+        if (strcmp(argv[i], "--capture_format") == 0 && i + 1 < argc)
+        {
+            const char* Format = argv[++i];
+            if (strcmp(Format, "y4m") == 0)
+                m_CaptureFormat = FrameCapture::FILE_FORMAT::Y4M;
+            else if (strcmp(Format, "raw") == 0)
+                m_CaptureFormat = FrameCapture::FILE_FORMAT::Raw;
+            else if (strcmp(Format, "png") == 0)
+                m_CaptureFormat = FrameCapture::FILE_FORMAT::PNG;
+            else
+            {
+                LOG_ERROR_MESSAGE("Unknown capture format '", Format, "'. Expected y4m, raw or png.");
+                return CommandLineStatus::Error;
+            }
+        }
+    }
+    return CommandLineStatus::OK;
+}
+
+RefCntAutoPtr<IPipelineState> Tutorial05_TextureArray::CreateCubePSO(IShaderSourceInputStreamFactory* pShaderSourceFactory, bool UseCompiledShaders, const CubePipelineVariant& Variant)
 {
     // clang-format off
     // Define vertex shader input layout
@@ -80,37 +355,300 @@ void Tutorial05_TextureArray::CreatePipelineState()
         LayoutElement{5, 1, 4, VT_FLOAT32, False, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
         // Attribute 6 - texture array index
         LayoutElement{6, 1, 1, VT_FLOAT32, False, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+        // Attribute 7 - flipbook parameters
+        LayoutElement{7, 1, 4, VT_FLOAT32, False, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
     };
     // clang-format on
 
-    // Create a shader source stream factory to load shaders from files.
+    // Pipeline state object encompasses configuration of all GPU stages
+    GraphicsPipelineStateCreateInfo PSOCreateInfo;
+
+    PSOCreateInfo.PSODesc.Name         = "Cube PSO";
+    PSOCreateInfo.PSODesc.PipelineType = PIPELINE_TYPE_GRAPHICS;
+
+    // clang-format off
+    PSOCreateInfo.GraphicsPipeline.NumRenderTargets             = 1;
+    PSOCreateInfo.GraphicsPipeline.RTVFormats[0]                = m_pSwapChain->GetDesc().ColorBufferFormat;
+    PSOCreateInfo.GraphicsPipeline.DSVFormat                    = m_pSwapChain->GetDesc().DepthBufferFormat;
+    PSOCreateInfo.GraphicsPipeline.PrimitiveTopology            = PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    PSOCreateInfo.GraphicsPipeline.RasterizerDesc.CullMode      = CULL_MODE_BACK;
+    PSOCreateInfo.GraphicsPipeline.DepthStencilDesc.DepthEnable = True;
+    // clang-format on
+
+    // Overdraw view counts the fragments that pass the depth test by adding a constant color
+    if (Variant.DebugView == DEBUG_VIEW::Overdraw)
+    {
+        auto& RT0          = PSOCreateInfo.GraphicsPipeline.BlendDesc.RenderTargets[0];
+        RT0.BlendEnable    = True;
+        RT0.SrcBlend       = BLEND_FACTOR_ONE;
+        RT0.DestBlend      = BLEND_FACTOR_ONE;
+        RT0.BlendOp        = BLEND_OPERATION_ADD;
+        RT0.SrcBlendAlpha  = BLEND_FACTOR_ONE;
+        RT0.DestBlendAlpha = BLEND_FACTOR_ZERO;
+        RT0.BlendOpAlpha   = BLEND_OPERATION_ADD;
+    }
+
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.SourceLanguage                  = SHADER_SOURCE_LANGUAGE_HLSL;
+    ShaderCI.Desc.UseCombinedTextureSamplers = true;
+    ShaderCI.pShaderSourceStreamFactory      = pShaderSourceFactory;
+
+    // Presentation engine always expects input in gamma space. Normally, pixel shader output is
+    // converted from linear to gamma space by the GPU. However, some platforms (e.g. Android in GLES mode,
+    // or Emscripten in WebGL mode) do not support gamma-correction. In this case the application
+    // has to do the conversion manually.
+    const std::string MaxTextureSlicesStr = std::to_string(MaxTextureSlices);
+    const std::string DebugViewStr        = std::to_string(static_cast<int>(Variant.DebugView));
+
+    // clang-format off
+    ShaderMacro Macros[] =
+    {
+        {"CONVERT_PS_OUTPUT_TO_GAMMA", m_ConvertPSOutputToGamma ? "1" : "0"},
+        {"MAX_TEXTURE_SLICES",         MaxTextureSlicesStr.c_str()},
+        {"SPLAT_HALF_PRECISION",       UseSplatHalfPrecision() ? "1" : "0"},
+        {"DEBUG_VIEW",                 DebugViewStr.c_str()},
+        {"MIP_FEEDBACK",               Variant.MipFeedback ? "1" : "0"}
+    };
+    // clang-format on
+    ShaderCI.Macros = {Macros, _countof(Macros)};
+
+    // Bytecode compiled at build time is used if it exists for the device type and the macros.
+    // Otherwise, the shader is compiled from source.
+    Uint32 NumPrecompiled = 0;
+    auto   CreateShader   = [&](const ShaderCreateInfo& CI, IShader** ppShader) {
+        ShaderCreateInfo ByteCodeCI = CI;
+        if (UseCompiledShaders && FindCompiledShader(m_pDevice->GetDeviceInfo().Type, CI.FilePath, CI.Macros, ByteCodeCI.ByteCode, ByteCodeCI.ByteCodeSize))
+        {
+            ByteCodeCI.FilePath                   = nullptr;
+            ByteCodeCI.pShaderSourceStreamFactory = nullptr;
+            ByteCodeCI.Macros                     = {};
+            ++NumPrecompiled;
+            m_pDevice->CreateShader(ByteCodeCI, ppShader);
+        }
+        else
+            m_pDevice->CreateShader(CI, ppShader);
+    };
+
+    RefCntAutoPtr<IShader> pVS;
+    {
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_VERTEX;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.Desc.Name       = "Cube VS";
+        ShaderCI.FilePath        = "cube_inst.vsh";
+        CreateShader(ShaderCI, &pVS);
+    }
+
+    RefCntAutoPtr<IShader> pPS;
+    {
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_PIXEL;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.Desc.Name       = "Cube PS";
+        ShaderCI.FilePath        = "cube_inst.psh";
+        CreateShader(ShaderCI, &pPS);
+    }
+
+    if (!pVS || !pPS)
+        return {};
+    if (NumPrecompiled > 0)
+        LOG_INFO_MESSAGE("Created ", NumPrecompiled, " of 2 cube shaders from bytecode compiled at build time");
+    // Variants without debug views and mip feedback are always compiled at build time, so a miss
+    // means that the permutations in CMakeLists.txt are out of date
+    if (UseCompiledShaders && NumPrecompiled < 2 && Variant.DebugView == DEBUG_VIEW::None && !Variant.MipFeedback &&
+        HasCompiledShaders(m_pDevice->GetDeviceInfo().Type))
+        LOG_ERROR_MESSAGE("No bytecode compiled at build time matches the cube shader macros. Update SHADER_PERMUTATIONS in CMakeLists.txt.");
+
+    PSOCreateInfo.pVS = pVS;
+    PSOCreateInfo.pPS = pPS;
+
+    PSOCreateInfo.GraphicsPipeline.InputLayout.LayoutElements = LayoutElems;
+    PSOCreateInfo.GraphicsPipeline.InputLayout.NumElements    = _countof(LayoutElems);
+
+    PSOCreateInfo.PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_STATIC;
+
+    // Constant blocks of all draws live in one dynamic buffer and are selected with
+    // SetBufferOffset(), which requires a mutable or dynamic variable.
+    // clang-format off
+    ShaderResourceVariableDesc Vars[] =
+    {
+        {SHADER_TYPE_VERTEX, "Constants",     SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {SHADER_TYPE_VERTEX, "TextureSlices", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {SHADER_TYPE_PIXEL,  "g_Texture",     SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {SHADER_TYPE_PIXEL,  "g_MipFeedback", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}
+    };
+    // clang-format on
+    PSOCreateInfo.PSODesc.ResourceLayout.Variables    = Vars;
+    PSOCreateInfo.PSODesc.ResourceLayout.NumVariables = _countof(Vars);
+
+    // clang-format off
+    SamplerDesc SamLinearClampDesc
+    {
+        FILTER_TYPE_LINEAR, FILTER_TYPE_LINEAR, FILTER_TYPE_LINEAR,
+        TEXTURE_ADDRESS_CLAMP, TEXTURE_ADDRESS_CLAMP, TEXTURE_ADDRESS_CLAMP
+    };
+    ImmutableSamplerDesc ImtblSamplers[] =
+    {
+        {SHADER_TYPE_PIXEL, "g_Texture", SamLinearClampDesc}
+    };
+    // clang-format on
+    PSOCreateInfo.PSODesc.ResourceLayout.ImmutableSamplers    = ImtblSamplers;
+    PSOCreateInfo.PSODesc.ResourceLayout.NumImmutableSamplers = _countof(ImtblSamplers);
+
+    RefCntAutoPtr<IPipelineState> pPSO;
+    m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &pPSO);
+    return pPSO;
+}
+
+void Tutorial05_TextureArray::CreatePipelineState()
+{
+    // Create a shader source stream factory to load shaders from the asset archive or from files.
     RefCntAutoPtr<IShaderSourceInputStreamFactory> pShaderSourceFactory;
-    m_pEngineFactory->CreateDefaultShaderSourceStreamFactory(nullptr, &pShaderSourceFactory);
+    if (m_Archive)
+        CreateArchiveShaderSourceFactory(*m_Archive, &pShaderSourceFactory);
+    else if (m_FileReader)
+    {
+        // The shader files were read at startup together with the textures
+        std::vector<MemoryShaderSourceFileInfo> Sources;
+        for (Uint32 i = 0; i < _countof(CubeShaderFiles); ++i)
+        {
+            if (!m_FileReader->Wait(i))
+                continue;
+            const auto& Data = m_FileReader->GetData(i);
+            Sources.emplace_back();
+            Sources.back().Name   = m_FileReader->GetPath(i).c_str();
+            Sources.back().pData  = reinterpret_cast<const Char*>(Data.data());
+            Sources.back().Length = static_cast<Uint32>(Data.size());
+        }
+        MemoryShaderSourceFactoryCreateInfo FactoryCI;
+        FactoryCI.pSources    = Sources.data();
+        FactoryCI.NumSources  = static_cast<Uint32>(Sources.size());
+        FactoryCI.CopySources = true;
+        CreateMemoryShaderSourceFactory(FactoryCI, &pShaderSourceFactory);
+        for (Uint32 i = 0; i < _countof(CubeShaderFiles); ++i)
+            m_FileReader->Release(i);
+    }
+    else
+        m_pEngineFactory->CreateDefaultShaderSourceStreamFactory(nullptr, &pShaderSourceFactory);
+
+    m_pPSO            = CreateCubePSO(pShaderSourceFactory, true, m_Variant);
+    m_PipelineVariant = m_Variant;
+    LOG_INFO_MESSAGE("Cube pixel shader: ", UseSplatHalfPrecision() ? "16-bit" : "32-bit", " splat blending, ",
+                     m_ConvertPSOutputToGamma ? "gamma conversion in the shader" : "sRGB render target");
+
+    // Dynamic buffer that holds the constant blocks of every draw of a frame. Each context
+    // suballocates its blocks from its own mapping of the buffer.
+    CreateUniformBuffer(m_pDevice, ConstantsRingSize, "VS constants ring", &m_VSConstants);
+
+    m_ConstantsRing = DynamicUniformRing{m_pDevice, m_VSConstants};
+    m_DeferredConstantsRings.clear();
+    for (size_t i = 0; i < m_pDeferredContexts.size(); ++i)
+        m_DeferredConstantsRings.emplace_back(m_pDevice, m_VSConstants);
+
+    // The main SRB is used on the immediate context. Workers that record scenes in parallel
+    // get their own SRBs, as setting the buffer offset modifies the SRB.
+    m_SRB          = CreateCubeSRB(m_pPSO);
+    m_ConstantsVar = m_SRB->GetVariableByName(SHADER_TYPE_VERTEX, "Constants");
+    m_WorkerSRBs.clear();
+    for (size_t i = 0; i < m_pDeferredContexts.size(); ++i)
+        m_WorkerSRBs.emplace_back(CreateCubeSRB(m_pPSO));
+}
 
-    TexturedCube::CreatePSOInfo CubePsoCI;
-    CubePsoCI.pDevice                = m_pDevice;
-    CubePsoCI.RTVFormat              = m_pSwapChain->GetDesc().ColorBufferFormat;
-    CubePsoCI.DSVFormat              = m_pSwapChain->GetDesc().DepthBufferFormat;
-    CubePsoCI.pShaderSourceFactory   = pShaderSourceFactory;
-    CubePsoCI.VSFilePath             = "cube_inst.vsh";
-    CubePsoCI.PSFilePath             = "cube_inst.psh";
-    CubePsoCI.ExtraLayoutElements    = LayoutElems;
-    CubePsoCI.NumExtraLayoutElements = _countof(LayoutElems);
+RefCntAutoPtr<IShaderResourceBinding> Tutorial05_TextureArray::CreateCubeSRB(IPipelineState* pPSO)
+{
+    RefCntAutoPtr<IShaderResourceBinding> pSRB;
+    pPSO->CreateShaderResourceBinding(&pSRB, true);
+    // Only one constant block is visible to a draw; its offset is set before the draw
+    pSRB->GetVariableByName(SHADER_TYPE_VERTEX, "Constants")->SetBufferRange(m_VSConstants, 0, sizeof(VSConstants));
+    return pSRB;
+}
 
-    m_pPSO = TexturedCube::CreatePipelineState(CubePsoCI, m_ConvertPSOutputToGamma);
+void Tutorial05_TextureArray::StartShaderReload()
+{
+    // Shaders are always compiled from source, even if the pipeline was created from bytecode
+    RefCntAutoPtr<IShaderSourceInputStreamFactory> pShaderSourceFactory;
+    if (m_Archive)
+        CreateArchiveShaderSourceFactory(*m_Archive, &pShaderSourceFactory);
+    else
+        m_pEngineFactory->CreateDefaultShaderSourceStreamFactory(nullptr, &pShaderSourceFactory);
+
+    // The new pipeline and its SRBs are not visible to rendering until they are swapped in
+    auto ReloadHandler = [this, pShaderSourceFactory, Variant = m_Variant](Uint32) {
+        auto& Reload   = m_ShaderReload;
+        Reload.Variant = Variant;
+        Reload.pPSO    = CreateCubePSO(pShaderSourceFactory, false, Variant);
+        if (Reload.pPSO)
+        {
+            Reload.pSRB = CreateCubeSRB(Reload.pPSO);
+            BindTextures(Reload.pSRB);
+            for (size_t i = 0; i < m_pDeferredContexts.size(); ++i)
+            {
+                Reload.WorkerSRBs.emplace_back(CreateCubeSRB(Reload.pPSO));
+                BindTextures(Reload.WorkerSRBs.back());
+            }
+        }
+        return ASYNC_TASK_STATUS_COMPLETE;
+    };
+    m_ShaderReloadStartTime = m_CurrTime;
+    m_ShaderReloadTask      = EnqueueAsyncWork(m_pThreadPool, std::move(ReloadHandler));
+}
 
-    // Create dynamic uniform buffer that will store our transformation matrix
-    // Dynamic buffers can be frequently updated by the CPU
-    CreateUniformBuffer(m_pDevice, sizeof(float4x4) * 2, "VS constants CB", &m_VSConstants);
+void Tutorial05_TextureArray::UpdateShaderHotReload()
+{
+    if (m_ShaderReloadTask && m_ShaderReloadTask->IsFinished())
+    {
+        m_ShaderReloadTask.Release();
+        const double ReloadTime = m_CurrTime - m_ShaderReloadStartTime;
+        if (m_ShaderReload.pPSO)
+        {
+            // Nothing is being rendered between frames, so the pipeline can be swapped. The state
+            // caches are invalidated every frame; draws baked with the previous pipeline are rebuilt.
+            // Levels collected before feedback was enabled are outdated
+            if (m_ShaderReload.Variant.MipFeedback && !m_PipelineVariant.MipFeedback)
+            {
+                m_MipFeedback->Reset(m_pImmediateContext);
+                m_MipFeedbackWindowStart = m_CurrTime;
+            }
+            m_pPSO            = m_ShaderReload.pPSO;
+            m_SRB             = m_ShaderReload.pSRB;
+            m_ConstantsVar    = m_SRB->GetVariableByName(SHADER_TYPE_VERTEX, "Constants");
+            m_WorkerSRBs      = std::move(m_ShaderReload.WorkerSRBs);
+            m_PipelineVariant = m_ShaderReload.Variant;
+            m_StaticDraws.Invalidate();
+            m_RenderGraphDirty   = true;
+            m_ShaderReloadFailed = false;
+            LOG_INFO_MESSAGE("Rebuilt the cube pipeline in ", ReloadTime * 1000.0, " ms");
+        }
+        else
+        {
+            m_ShaderReloadFailed = true;
+            LOG_ERROR_MESSAGE("Failed to rebuild the cube pipeline. The previous pipeline is kept.");
+        }
+        m_ShaderReload = {};
+    }
 
-    // Since we did not explicitly specify the type for 'Constants' variable, default
-    // type (SHADER_RESOURCE_VARIABLE_TYPE_STATIC) will be used. Static variables
-    // never change and are bound directly to the pipeline state object.
-    m_pPSO->GetStaticVariableByName(SHADER_TYPE_VERTEX, "Constants")->Set(m_VSConstants);
+    // Files are polled, as edits are rare and a check costs two file system queries
+    if (m_HotReload && m_CurrTime - m_LastShaderCheckTime >= 0.5)
+    {
+        m_LastShaderCheckTime = m_CurrTime;
 
-    // Since we are using mutable variable, we must create a shader resource binding object
-    // http://diligentgraphics.com/2016/03/23/resource-binding-model-in-diligent-engine-2-0/
-    m_pPSO->CreateShaderResourceBinding(&m_SRB, true);
+        auto FileTimes = GetShaderFileTimes();
+        if (FileTimes != m_ShaderFileTimes)
+        {
+            m_ShaderFileTimes     = std::move(FileTimes);
+            m_ShaderReloadPending = true;
+            // An edit may fix the source that failed to compile, so a pending variant is retried too
+            m_ShaderReloadFailed = false;
+        }
+    }
+    // Debug views and mip feedback are compiled into the pipeline
+    if (m_Variant != m_PipelineVariant && !m_ShaderReloadFailed)
+        m_ShaderReloadPending = true;
+
+    // Changes made while a rebuild is running are picked up by the next one
+    if (m_ShaderReloadPending && !m_ShaderReloadTask)
+    {
+        m_ShaderReloadPending = false;
+        StartShaderReload();
+    }
 }
 
 void Tutorial05_TextureArray::CreateInstanceBuffer()
@@ -126,60 +664,521 @@ void Tutorial05_TextureArray::CreateInstanceBuffer()
     PopulateInstanceBuffer();
 }
 
-void Tutorial05_TextureArray::LoadTextures()
+void Tutorial05_TextureArray::LoadTextures(bool OnWorkerThread)
 {
-    std::vector<RefCntAutoPtr<ITextureLoader>> TexLoaders(NumTextures);
-    // Load textures
-    for (int tex = 0; tex < NumTextures; ++tex)
+    // Slices are decoded either by the fast PNG decoder or by a texture loader
+    struct DecodedSlice
     {
-        // Create loader for the current texture
-        std::stringstream FileNameSS;
-        FileNameSS << "DGLogo" << tex << ".png";
-        const auto      FileName = FileNameSS.str();
+        RefCntAutoPtr<ITextureLoader> pLoader;
+        DecodedPngTexture             Png;
+
+        const TextureDesc& GetTextureDesc() const { return pLoader ? pLoader->GetTextureDesc() : Png.Desc; }
+        TextureSubResData  GetSubresourceData(Uint32 Mip) const { return pLoader ? pLoader->GetSubresourceData(Mip, 0) : Png.Mips[Mip]; }
+    };
+
+    // Returns the encoded file of a texture, or null if the file is only accessible to the texture loader
+    auto GetSourceData = [this](Uint32 Texture, std::vector<Uint8>& Storage, size_t& Size) -> const void* {
+        if (m_Archive)
+        {
+            const auto* pEntry = m_Archive->Find(GetTextureFileName(Texture).c_str());
+            if (pEntry == nullptr)
+                return nullptr;
+            Size = static_cast<size_t>(pEntry->Size);
+            if (const void* pData = m_Archive->GetData(*pEntry))
+                return pData;
+            return m_Archive->Read(*pEntry, Storage) ? Storage.data() : nullptr;
+        }
+        if (m_FileReader)
+        {
+            const auto& Data = m_FileReader->GetData(m_FirstTextureRequest + Texture);
+            Size             = Data.size();
+            return !Data.empty() ? Data.data() : nullptr;
+        }
+        return nullptr;
+    };
+
+    auto LoadSlice = [&](Uint32 Texture, DecodedSlice& Dst) {
+        const auto      FileName = GetTextureFileName(Texture);
         TextureLoadInfo LoadInfo;
         LoadInfo.IsSRGB = true;
 
-        CreateTextureLoaderFromFile(FileName.c_str(), IMAGE_FILE_FORMAT_UNKNOWN, LoadInfo, &TexLoaders[tex]);
-        VERIFY_EXPR(TexLoaders[tex]);
-        VERIFY(tex == 0 || TexLoaders[tex]->GetTextureDesc() == TexLoaders[0]->GetTextureDesc(), "All textures must be same size");
-    }
+        if (m_UseFastPngDecoder)
+        {
+            std::vector<Uint8> Storage;
+            size_t             Size  = 0;
+            const void*        pData = GetSourceData(Texture, Storage, Size);
+            if (pData != nullptr && DecodePngTexture(pData, Size, LoadInfo.IsSRGB, Dst.Png))
+                return;
+        }
+
+        // Create loader for the current texture
+        RefCntAutoPtr<ITextureLoader>& pLoader = Dst.pLoader;
+        if (m_Archive)
+            CreateArchiveTextureLoader(*m_Archive, FileName.c_str(), LoadInfo, &pLoader);
+        else if (m_FileReader)
+        {
+            // The file has already been read (see the duplicate search below), so the decode task does not block
+            const auto& Data = m_FileReader->GetData(m_FirstTextureRequest + Texture);
+            if (!Data.empty())
+                CreateTextureLoaderFromMemory(Data.data(), Data.size(), false, LoadInfo, &pLoader);
+        }
+        else
+            CreateTextureLoaderFromFile(FileName.c_str(), IMAGE_FILE_FORMAT_UNKNOWN, LoadInfo, &pLoader);
+        VERIFY_EXPR(pLoader);
+    };
+
+    auto GetDecodedSize = [](const TextureDesc& Desc) {
+        Uint64 Size = 0;
+        for (Uint32 mip = 0; mip < Desc.MipLevels; ++mip)
+            Size += GetMipLevelProperties(Desc, mip).MipSize;
+        return Size;
+    };
 
-    auto TexArrDesc      = TexLoaders[0]->GetTextureDesc();
-    TexArrDesc.ArraySize = NumTextures;
-    TexArrDesc.Type      = RESOURCE_DIM_TEX_2D_ARRAY;
-    TexArrDesc.Usage     = USAGE_DEFAULT;
-    TexArrDesc.BindFlags = BIND_SHADER_RESOURCE;
+    // Slices are decoded a window at a time and released as soon as their data has been copied
+    // into the staging arena, so the peak host memory does not grow with the number of slices.
+    // A window of 0 decodes all slices before uploading any of them.
+    const Uint32 MaxWindow = m_TextureLoadWindow > 0 ? m_TextureLoadWindow : static_cast<Uint32>(NumTextures);
 
-    // Prepare initialization data
-    std::vector<TextureSubResData> SubresData(TexArrDesc.ArraySize * TexArrDesc.MipLevels);
-    for (Uint32 slice = 0; slice < TexArrDesc.ArraySize; ++slice)
+    std::vector<DecodedSlice>              Slices(MaxWindow); // Decoded slices of the current window
+    std::vector<RefCntAutoPtr<IAsyncTask>> Tasks(MaxWindow);
+
+    auto StartDecode = [&](Uint32 Texture, Uint32 WindowIdx) {
+        Tasks[WindowIdx] = EnqueueAsyncWork(m_pThreadPool,
+                                            [&, Texture, WindowIdx](Uint32) {
+                                                LoadSlice(Texture, Slices[WindowIdx]);
+                                                return ASYNC_TASK_STATUS_COMPLETE;
+                                            });
+    };
+
+    // Identical images are loaded into a single array slice, and the shader maps texture indices
+    // to array slices. Duplicates are found by hashing the encoded files, so they are neither
+    // decoded nor uploaded. The files are hashed in the order their reads complete, so a slow file
+    // does not hold back those that have already arrived, and the slices of the first window start
+    // decoding right away, so decoding overlaps with the remaining reads. The array slices follow
+    // the same order; the remap below maps the textures to them. Waiting on this thread rather
+    // than in the decode tasks keeps the thread pool free for the reads on the fallback path.
+    static_assert(static_cast<Uint32>(NumTextures) <= MaxTextureSlices, "Increase MaxTextureSlices");
+    std::vector<Uint32> ArraySliceTextures;         // Texture loaded into each array slice
+    std::vector<Uint32> TextureSlices(NumTextures); // Array slice of each texture
     {
-        for (Uint32 mip = 0; mip < TexArrDesc.MipLevels; ++mip)
+        std::vector<std::vector<Uint8>>             Storage(NumTextures);
+        std::vector<std::pair<const void*, size_t>> Sources(NumTextures, {nullptr, 0});
+        std::unordered_multimap<size_t, Uint32>     SliceHashes; // Hash of the file -> array slice
+        for (Uint32 i = 0; i < NumTextures; ++i)
         {
-            SubresData[slice * TexArrDesc.MipLevels + mip] = TexLoaders[slice]->GetSubresourceData(mip, 0);
+            Uint32 Tex = i;
+            if (m_FileReader)
+                Tex = m_FileReader->WaitAny(m_FirstTextureRequest, NumTextures) - m_FirstTextureRequest;
+            auto& Src  = Sources[Tex];
+            Src.first  = GetSourceData(Tex, Storage[Tex], Src.second);
+            auto Slice = static_cast<Uint32>(ArraySliceTextures.size());
+            if (Src.first != nullptr)
+            {
+                const size_t Hash  = std::hash<std::string_view>{}(std::string_view{static_cast<const char*>(Src.first), Src.second});
+                const auto   Range = SliceHashes.equal_range(Hash);
+                for (auto It = Range.first; It != Range.second; ++It)
+                {
+                    // Different files may have the same hash
+                    const auto& Other = Sources[ArraySliceTextures[It->second]];
+                    if (Other.second == Src.second && memcmp(Other.first, Src.first, Src.second) == 0)
+                    {
+                        Slice = It->second;
+                        break;
+                    }
+                }
+                if (Slice == ArraySliceTextures.size())
+                    SliceHashes.emplace(Hash, Slice);
+            }
+
+            if (Slice == ArraySliceTextures.size())
+            {
+                ArraySliceTextures.push_back(Tex);
+                if (Slice < MaxWindow)
+                    StartDecode(Tex, Slice);
+            }
+            else if (m_FileReader)
+                m_FileReader->Release(m_FirstTextureRequest + Tex);
+            TextureSlices[Tex] = Slice;
         }
     }
-    TextureData InitData{SubresData.data(), TexArrDesc.MipLevels * TexArrDesc.ArraySize};
 
-    // Create the texture array
+    const Uint32 NumSlicesTotal = static_cast<Uint32>(ArraySliceTextures.size());
+    const Uint32 Window         = std::min(MaxWindow, NumSlicesTotal);
+
+    TextureDesc             TexArrDesc;
     RefCntAutoPtr<ITexture> pTexArray;
-    m_pDevice->CreateTexture(TexArrDesc, &InitData, &pTexArray);
+    Uint64                  PeakBytes      = 0;
+    Uint64                  TotalBytes     = 0;
+    Uint64                  DeferredBytes  = 0;
+    Uint32                  NumFastDecoded = 0;
+    for (Uint32 FirstSlice = 0; FirstSlice < NumSlicesTotal; FirstSlice += Window)
+    {
+        const Uint32 NumSlices = std::min(Window, NumSlicesTotal - FirstSlice);
+
+        // Decode the slices of the window in parallel. The first window was started by the duplicate search.
+        if (FirstSlice > 0)
+        {
+            for (Uint32 i = 0; i < NumSlices; ++i)
+                StartDecode(ArraySliceTextures[FirstSlice + i], i);
+        }
+        for (Uint32 i = 0; i < NumSlices; ++i)
+            Tasks[i]->WaitForCompletion();
+
+        if (!pTexArray)
+        {
+            // The array is created empty from the description of the first slice
+            TexArrDesc           = Slices[0].GetTextureDesc();
+            TexArrDesc.ArraySize = NumSlicesTotal;
+            TexArrDesc.Type      = RESOURCE_DIM_TEX_2D_ARRAY;
+            TexArrDesc.Usage     = USAGE_DEFAULT;
+            TexArrDesc.BindFlags = BIND_SHADER_RESOURCE;
+            // The texture is written on the transfer queue and sampled on the graphics queue
+            if (IDeviceContext* pTransferContext = m_Uploads->GetTransferContext())
+                TexArrDesc.ImmediateContextMask = (Uint64{1} << m_pImmediateContext->GetDesc().ContextId) | (Uint64{1} << pTransferContext->GetDesc().ContextId);
+
+            m_pDevice->CreateTexture(TexArrDesc, nullptr, &pTexArray);
+        }
+
+        Uint64 DecodedBytes = 0;
+        for (Uint32 i = 0; i < NumSlices; ++i)
+        {
+            const auto& SliceDesc = Slices[i].GetTextureDesc();
+            DecodedBytes += GetDecodedSize(SliceDesc);
+            if (!Slices[i].pLoader)
+                ++NumFastDecoded;
+            if (SliceDesc.Width != TexArrDesc.Width || SliceDesc.Height != TexArrDesc.Height ||
+                SliceDesc.Format != TexArrDesc.Format || SliceDesc.MipLevels != TexArrDesc.MipLevels)
+            {
+                LOG_ERROR_MESSAGE("Texture ", ArraySliceTextures[FirstSlice + i], " does not match the size and format of the array");
+                continue;
+            }
+
+            const Uint32 Slice = FirstSlice + i;
+            for (Uint32 mip = 0; mip < TexArrDesc.MipLevels; ++mip)
+            {
+                const auto MipProps   = GetMipLevelProperties(TexArrDesc, mip);
+                const Box  DstBox     = {0, MipProps.StorageWidth, 0, MipProps.StorageHeight};
+                const auto SubresData = Slices[i].GetSubresourceData(mip);
+                if (m_Uploads->EnqueueTextureUpdate(pTexArray, mip, Slice, DstBox, SubresData))
+                    continue;
+
+                if (OnWorkerThread)
+                {
+                    // The level is kept until the main thread can flush the uploads
+                    DeferredTextureLevel Deferred;
+                    Deferred.pTexture = pTexArray;
+                    Deferred.Mip      = mip;
+                    Deferred.Slice    = Slice;
+                    Deferred.DstBox   = DstBox;
+                    Deferred.Stride   = MipProps.RowSize;
+                    Deferred.Data.resize(static_cast<size_t>(MipProps.MipSize));
+                    const size_t NumRows = static_cast<size_t>(MipProps.MipSize / MipProps.RowSize);
+                    for (size_t Row = 0; Row < NumRows; ++Row)
+                    {
+                        memcpy(&Deferred.Data[Row * MipProps.RowSize], static_cast<const Uint8*>(SubresData.pData) + Row * SubresData.Stride,
+                               static_cast<size_t>(MipProps.RowSize));
+                    }
+                    DeferredBytes += MipProps.MipSize;
+                    m_DeferredTextureLevels.emplace_back(std::move(Deferred));
+                    continue;
+                }
+
+                // Make room in the staging arena
+                PeakBytes = std::max(PeakBytes, DecodedBytes + DeferredBytes + m_Uploads->GetStats().QueuedBytes);
+                FlushAndUploadTextureLevel(pTexArray, mip, Slice, DstBox, SubresData);
+            }
+        }
+        // Decoded data of the whole window and its staging copy are alive at this point
+        PeakBytes = std::max(PeakBytes, DecodedBytes + DeferredBytes + m_Uploads->GetStats().QueuedBytes);
+        TotalBytes += DecodedBytes;
+
+        for (Uint32 i = 0; i < NumSlices; ++i)
+        {
+            Slices[i] = {};
+            Tasks[i].Release();
+        }
+        if (m_FileReader)
+        {
+            for (Uint32 i = 0; i < NumSlices; ++i)
+                m_FileReader->Release(m_FirstTextureRequest + ArraySliceTextures[FirstSlice + i]);
+        }
+    }
+    LOG_INFO_MESSAGE("Loaded ", NumTextures, " textures into ", NumSlicesTotal, " array slices (", TotalBytes >> 10, " KB decoded, ",
+                     NumFastDecoded, " slices by the fast PNG decoder) with a peak of ", PeakBytes >> 10,
+                     " KB of host memory in decoded and staged data");
+
+    // Texture index to array slice table of the vertex shader
+    TextureSliceRemap SliceRemap;
+    for (Uint32 Tex = 0; Tex < NumTextures; ++Tex)
+        SliceRemap.Slices[Tex / 4][Tex % 4] = static_cast<float>(TextureSlices[Tex]);
+
+    BufferDesc RemapBuffDesc;
+    RemapBuffDesc.Name      = "Texture slice remap";
+    RemapBuffDesc.Usage     = USAGE_IMMUTABLE;
+    RemapBuffDesc.BindFlags = BIND_UNIFORM_BUFFER;
+    RemapBuffDesc.Size      = sizeof(SliceRemap);
+    BufferData RemapData{&SliceRemap, sizeof(SliceRemap)};
+    m_pDevice->CreateBuffer(RemapBuffDesc, &RemapData, &m_TextureSliceRemap);
 
     // Get shader resource view from the texture array
     m_TextureSRV = pTexArray->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
-    // Set texture SRV in the SRB
-    m_SRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_Texture")->Set(m_TextureSRV);
+}
+
+void Tutorial05_TextureArray::FlushAndUploadTextureLevel(ITexture* pTexArray, Uint32 Mip, Uint32 Slice, const Box& DstBox, const TextureSubResData& SubresData)
+{
+    m_Uploads->Flush(m_pImmediateContext, true);
+    if (!m_Uploads->EnqueueTextureUpdate(pTexArray, Mip, Slice, DstBox, SubresData))
+    {
+        // The level is larger than the whole arena, so it is copied directly
+        m_pImmediateContext->UpdateTexture(pTexArray, Mip, Slice, DstBox, SubresData,
+                                           RESOURCE_STATE_TRANSITION_MODE_NONE, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    }
+}
+
+void Tutorial05_TextureArray::UploadDeferredTextureLevels()
+{
+    if (m_DeferredTextureLevels.empty())
+        return;
+
+    Uint64 DeferredBytes = 0;
+    for (const auto& Deferred : m_DeferredTextureLevels)
+    {
+        const TextureSubResData SubresData{Deferred.Data.data(), Deferred.Stride};
+        if (!m_Uploads->EnqueueTextureUpdate(Deferred.pTexture, Deferred.Mip, Deferred.Slice, Deferred.DstBox, SubresData))
+            FlushAndUploadTextureLevel(Deferred.pTexture, Deferred.Mip, Deferred.Slice, Deferred.DstBox, SubresData);
+        DeferredBytes += Deferred.Data.size();
+    }
+    LOG_INFO_MESSAGE("Uploaded ", m_DeferredTextureLevels.size(), " texture levels (", DeferredBytes >> 10,
+                     " KB) that did not fit into the staging arena during the startup");
+    m_DeferredTextureLevels.clear();
+}
+
+void Tutorial05_TextureArray::BindTextures(IShaderResourceBinding* pSRB) const
+{
+    // Set texture SRV and the slice table in the SRB. Some debug views do not sample the texture.
+    if (IShaderResourceVariable* pTextureVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_Texture"))
+        pTextureVar->Set(m_TextureSRV);
+    pSRB->GetVariableByName(SHADER_TYPE_VERTEX, "TextureSlices")->Set(m_TextureSliceRemap);
+    // Only pipelines with mip feedback have the buffer
+    if (IShaderResourceVariable* pFeedbackVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_MipFeedback"))
+        pFeedbackVar->Set(m_MipFeedback->GetUAV());
+}
+
+void Tutorial05_TextureArray::UpdateMipFeedback()
+{
+    // Windows are read back a few frames after they end, so the CPU does not wait for the GPU
+    if (m_MipFeedback->Poll(m_pImmediateContext, m_FinestSampledMips))
+    {
+        // All slices of the array share the mip chain, so only the levels that no slice
+        // sampled can be dropped. Slices that were not visible do not keep any levels.
+        Uint32 FinestMip = MipFeedback::NotSampled;
+        for (Uint32 Mip : m_FinestSampledMips)
+            FinestMip = std::min(FinestMip, Mip);
+
+        // Dropped levels are restored once the top of the array has been magnified for several
+        // windows in a row, so a camera that briefly moves close does not cause a reload
+        m_MagnifiedMipWindows = FinestMip == 0 && m_NumDroppedMips > 0 ? m_MagnifiedMipWindows + 1 : 0;
+
+        const Uint32 NumMips = m_TextureSRV->GetTexture()->GetDesc().MipLevels;
+        // The reload task binds the current texture array to the new SRBs
+        if (!m_ShaderReloadTask)
+        {
+            if (FinestMip != MipFeedback::NotSampled && FinestMip > MipFeedback::LevelBias && NumMips > 1)
+                DropTopMips(std::min(FinestMip - MipFeedback::LevelBias, NumMips - 1));
+            else if (m_MagnifiedMipWindows >= MipRestoreWindows)
+                RestoreTopMips();
+        }
+    }
+    m_MipFeedbackWindowDue = m_CurrTime - m_MipFeedbackWindowStart >= m_MipFeedbackWindow;
+}
+
+void Tutorial05_TextureArray::DropTopMips(Uint32 NumMips)
+{
+    ITexture*         pOldArray = m_TextureSRV->GetTexture();
+    const TextureDesc OldDesc   = pOldArray->GetDesc();
+
+    auto GetArraySize = [](const TextureDesc& Desc) {
+        Uint64 Size = 0;
+        for (Uint32 mip = 0; mip < Desc.MipLevels; ++mip)
+            Size += GetMipLevelProperties(Desc, mip).MipSize;
+        return Size * Desc.ArraySize;
+    };
+
+    const auto  TopMipProps = GetMipLevelProperties(OldDesc, NumMips);
+    TextureDesc NewDesc     = OldDesc;
+    NewDesc.Width           = TopMipProps.LogicalWidth;
+    NewDesc.Height          = TopMipProps.LogicalHeight;
+    NewDesc.MipLevels       = OldDesc.MipLevels - NumMips;
+
+    // The smaller array is only accessed on the graphics queue
+    NewDesc.ImmediateContextMask = Uint64{1} << m_pImmediateContext->GetDesc().ContextId;
+
+    RefCntAutoPtr<ITexture> pNewArray;
+    m_pDevice->CreateTexture(NewDesc, nullptr, &pNewArray);
+    if (!pNewArray)
+        return;
+
+    for (Uint32 Slice = 0; Slice < NewDesc.ArraySize; ++Slice)
+    {
+        for (Uint32 mip = 0; mip < NewDesc.MipLevels; ++mip)
+        {
+            CopyTextureAttribs CopyAttribs{pOldArray, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, pNewArray, RESOURCE_STATE_TRANSITION_MODE_TRANSITION};
+            CopyAttribs.SrcMipLevel = mip + NumMips;
+            CopyAttribs.SrcSlice    = Slice;
+            CopyAttribs.DstMipLevel = mip;
+            CopyAttribs.DstSlice    = Slice;
+            m_pImmediateContext->CopyTexture(CopyAttribs);
+        }
+    }
+
+    const Uint64 FreedBytes = GetArraySize(OldDesc) - GetArraySize(NewDesc);
+    m_NumDroppedMips += NumMips;
+    m_DroppedMipBytes += FreedBytes;
+    LOG_INFO_MESSAGE("Dropped ", NumMips, " unused top mip level(s) of the texture array (", OldDesc.Width, "x", OldDesc.Height, " -> ",
+                     NewDesc.Width, "x", NewDesc.Height, ", ", FreedBytes >> 10, " KB freed)");
+
+    // The previous array is released once the GPU is done with it
+    m_TextureSRV = pNewArray->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
+    RebindTextureArray();
+}
+
+void Tutorial05_TextureArray::RestoreTopMips()
+{
+    // The array is loaded again from the source files at full resolution. This stalls the frame,
+    // like a reload of any other asset, but only happens after the camera stayed close.
+    if (!m_Archive)
+    {
+        m_FileReader          = std::make_unique<AsyncFileReader>(m_pThreadPool);
+        m_FirstTextureRequest = 0;
+        for (Uint32 Slice = 0; Slice < NumTextures; ++Slice)
+            m_FileReader->AddRequest(GetTextureFileName(Slice).c_str());
+        m_FileReader->Submit();
+    }
+    m_TextureSliceRemap.Release();
+    LoadTextures(false);
+    m_FileReader.reset();
+    m_Uploads->Flush(m_pImmediateContext, true);
+
+    const auto& Desc = m_TextureSRV->GetTexture()->GetDesc();
+    LOG_INFO_MESSAGE("Restored ", m_NumDroppedMips, " top mip level(s) of the texture array (", Desc.Width, "x", Desc.Height, ")");
+    m_NumDroppedMips  = 0;
+    m_DroppedMipBytes = 0;
+    RebindTextureArray();
+}
+
+void Tutorial05_TextureArray::RebindTextureArray()
+{
+    // Mutable variables that are already bound cannot be changed, so the SRBs are recreated
+    m_SRB          = CreateCubeSRB(m_pPSO);
+    m_ConstantsVar = m_SRB->GetVariableByName(SHADER_TYPE_VERTEX, "Constants");
+    BindTextures(m_SRB);
+    for (auto& pSRB : m_WorkerSRBs)
+    {
+        pSRB = CreateCubeSRB(m_pPSO);
+        BindTextures(pSRB);
+    }
+    m_StaticDraws.Invalidate();
+    m_RenderGraphDirty = true;
+
+    // Levels are relative to the top mip of the array
+    m_MipFeedback->Reset(m_pImmediateContext);
+    m_MipFeedbackWindowStart = m_CurrTime;
+    m_FinestSampledMips.clear();
+    m_MagnifiedMipWindows = 0;
 }
 
 void Tutorial05_TextureArray::UpdateUI()
 {
-    ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowPos(ImVec2(10, 120), ImGuiCond_FirstUseEver);
     if (ImGui::Begin("Settings", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
     {
-        if (ImGui::SliderInt("Grid Size", &m_GridSize, 1, 32))
+        ImGui::Text("Instances: %u / %u", m_Instances.GetCount(), m_Instances.GetCapacity());
+        if (ImGui::Checkbox("Simulation thread", &m_SimEnabled))
+        {
+            if (m_SimEnabled)
+                StartSimulation();
+            else
+                StopSimulation();
+        }
+        ImGui::Checkbox("Animate textures", &m_AnimateTextures);
+        ImGui::SliderFloat("Frames per second", &m_FlipbookRate, 0.1f, 10.f);
+        ImGui::Checkbox("Cross-fade frames", &m_FlipbookCrossFade);
+
+        bool Capture = m_Capture != nullptr;
+        if (ImGui::Checkbox("Capture frames", &Capture))
         {
-            PopulateInstanceBuffer();
+            if (Capture)
+                StartCapture();
+            else
+                StopCapture();
         }
+        if (m_Capture)
+        {
+            const auto Stats = m_Capture->GetStats();
+            ImGui::Text("Captured: %u, written: %u, dropped: %u", Stats.NumCaptured, Stats.NumWritten, Stats.NumDropped);
+        }
+        ImGui::Checkbox("Validate draws", &m_ValidationMode);
+        ImGui::Checkbox("Static draw list", &m_UseStaticDraws);
+        {
+            // Heatmaps of the shading cost. Changing the view rebuilds the pipeline.
+            int View = static_cast<int>(m_Variant.DebugView);
+            if (ImGui::Combo("Debug view", &View, "None\0Overdraw\0Quad utilization\0Mip level\0"))
+            {
+                m_Variant.DebugView  = static_cast<DEBUG_VIEW>(View);
+                m_ShaderReloadFailed = false;
+            }
+            switch (m_Variant.DebugView)
+            {
+                case DEBUG_VIEW::Overdraw: ImGui::TextDisabled("Fragments: red 8, yellow 24, white 64"); break;
+                case DEBUG_VIEW::QuadUtilization: ImGui::TextDisabled("Covered pixels per quad: red 1, yellow 2-3, green 4"); break;
+                case DEBUG_VIEW::MipLevel: ImGui::TextDisabled("Blue magnified, green 0, yellow 1, orange 2, red 3, magenta 4+"); break;
+                default: break;
+            }
+        }
+        if (m_MipFeedback)
+        {
+            if (ImGui::Checkbox("Mip feedback", &m_Variant.MipFeedback))
+                m_ShaderReloadFailed = false;
+            if (m_PipelineVariant.MipFeedback)
+            {
+                // Levels of the array slices, '-' if a slice was not visible and '+' if it was magnified
+                const Uint32 NumSlices = std::min(static_cast<Uint32>(m_FinestSampledMips.size()), m_TextureSRV->GetTexture()->GetDesc().ArraySize);
+                std::string  Levels;
+                for (Uint32 Slice = 0; Slice < NumSlices; ++Slice)
+                {
+                    const Uint32 Mip = m_FinestSampledMips[Slice];
+                    if (Mip == MipFeedback::NotSampled)
+                        Levels += "- ";
+                    else
+                        Levels += Mip >= MipFeedback::LevelBias ? std::to_string(Mip - MipFeedback::LevelBias) + " " : "+ ";
+                }
+                ImGui::Text("Finest sampled mips: %s", !Levels.empty() ? Levels.c_str() : "collecting");
+            }
+            ImGui::Text("Texture mips: %u (%u dropped, %.1f KB freed)", m_TextureSRV->GetTexture()->GetDesc().MipLevels, m_NumDroppedMips,
+                        static_cast<double>(m_DroppedMipBytes) / 1024.0);
+        }
+        if (m_HotReload)
+            ImGui::Text("Shader hot reload: %s", m_ShaderReloadTask ? "compiling" : (m_ShaderReloadFailed ? "failed, using the previous pipeline" : "watching"));
+        ImGui::Text("Bindings: %u issued, %u filtered", m_StateCacheStats.NumIssued, m_StateCacheStats.NumFiltered);
+        ImGui::Text("Constant blocks: %u (%u bytes)", m_NumConstantBlocks, m_ConstantBytes);
+        {
+            const auto UploadStats = m_Uploads->GetStats();
+            ImGui::Text("Uploads: %u copies for %u updates", UploadStats.NumCopies, UploadStats.NumUpdates);
+            ImGui::Text("Texture uploads: %s queue (%u copies)", m_Uploads->GetTransferContext() ? "transfer" : "graphics", UploadStats.NumTransferCopies);
+            ImGui::Text("Upload KB: %.1f queued, %.1f in flight, %.1f completed",
+                        static_cast<double>(UploadStats.QueuedBytes) / 1024.0,
+                        static_cast<double>(UploadStats.InFlightBytes) / 1024.0,
+                        static_cast<double>(UploadStats.CompletedBytes) / 1024.0);
+            int BudgetKB = static_cast<int>(m_UploadBudget >> 10);
+            if (ImGui::SliderInt("Upload budget (KB)", &BudgetKB, 64, 16384))
+            {
+                m_UploadBudget = Uint64{static_cast<Uint32>(BudgetKB)} << 10;
+                m_Uploads->SetFrameBudget(m_UploadBudget);
+            }
+        }
+        ImGui::Text("Render graph: %u passes, %u barriers", m_RenderGraph.GetNumPasses(), m_RenderGraph.GetNumBarriers());
+        if (m_RenderGraph.GetNumTransientTextures() > 0)
+            ImGui::Text("Transient textures: %u (%u allocated)", m_RenderGraph.GetNumTransientTextures(), m_RenderGraph.GetNumPhysicalTextures());
     }
     ImGui::End();
 }
@@ -188,14 +1187,450 @@ void Tutorial05_TextureArray::Initialize(const SampleInitInfo& InitInfo)
 {
     SampleBase::Initialize(InitInfo);
 
-    CreatePipelineState();
+    m_StateCache.SetContext(m_pImmediateContext);
+    m_DeferredStateCaches.resize(m_pDeferredContexts.size());
+    for (size_t i = 0; i < m_pDeferredContexts.size(); ++i)
+        m_DeferredStateCaches[i].SetContext(m_pDeferredContexts[i]);
+
+    // The first immediate context is the graphics context used by the sample
+    IDeviceContext* pTransferContext = InitInfo.NumImmediateCtx > 1 ? InitInfo.ppContexts[1] : nullptr;
+    m_Uploads                        = std::make_unique<UploadManager>(m_pDevice, UploadStagingSize, m_UploadBudget, pTransferContext);
+
+    ThreadPoolCreateInfo ThreadPoolCI;
+    ThreadPoolCI.NumThreads = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    m_pThreadPool           = CreateThreadPool(ThreadPoolCI);
+
+    if (!m_ArchivePath.empty())
+    {
+        m_Archive = AssetArchive::Open(m_ArchivePath.c_str());
+        if (m_Archive)
+            LOG_INFO_MESSAGE("Loading assets from archive '", m_ArchivePath, "' (", m_Archive->GetNumEntries(), " entries)");
+        else
+            LOG_WARNING_MESSAGE("Falling back to loose asset files");
+    }
+    if (!m_Archive)
+    {
+        // Submit the reads of all loose asset files at once, so that the disk latency
+        // overlaps with the shader compilation and texture decoding
+        m_FileReader = std::make_unique<AsyncFileReader>(m_pThreadPool);
+        for (const char* ShaderFile : CubeShaderFiles)
+            m_FileReader->AddRequest(ShaderFile);
+        m_FirstTextureRequest = m_FileReader->GetNumRequests();
+        for (Uint32 Slice = 0; Slice < NumTextures; ++Slice)
+            m_FileReader->AddRequest(GetTextureFileName(Slice).c_str());
+        m_FileReader->Submit();
+    }
+
+    // The feedback buffer has an entry for every slice the array may have
+    if (m_pDevice->GetDeviceInfo().Features.PixelUAVWritesAndAtomics)
+        m_MipFeedback = std::make_unique<MipFeedback>(m_pDevice, MaxTextureSlices, 2u);
+    else if (m_Variant.MipFeedback)
+    {
+        LOG_WARNING_MESSAGE("Mip feedback requires pixel shader UAV writes, which the device does not support");
+        m_Variant.MipFeedback = false;
+    }
+
+    // Independent startup steps run in parallel (--parallel_init 0 runs them one after another).
+    // Shader compilation does not need the textures, and texture decoding does not need the pipeline.
+    // GL resources can only be created on the thread that owns the context.
+    const bool ParallelInit = m_ParallelInit && !m_pDevice->GetDeviceInfo().IsGLDevice();
+    if (m_ParallelInit && !ParallelInit)
+        LOG_INFO_MESSAGE("Parallel initialization is not supported by GL; the startup steps run on the main thread");
+    StartupGraph Startup;
+
+    const auto PSO = Startup.AddTask("Pipeline state", [this]() { CreatePipelineState(); });
+    Startup.AddTask("Cube geometry", [this]() {
+        // Load cube vertex and index buffers
+        m_CubeVertexBuffer = TexturedCube::CreateVertexBuffer(m_pDevice, GEOMETRY_PRIMITIVE_VERTEX_FLAG_POS_TEX);
+        m_CubeIndexBuffer  = TexturedCube::CreateIndexBuffer(m_pDevice);
+    });
+    // Both steps enqueue their data in the upload manager, which is not thread-safe.
+    // The instance data is small, so it goes first.
+    const auto Instances = Startup.AddTask("Instance buffer", [this]() { CreateInstanceBuffer(); });
+    const auto Textures  = Startup.AddTask("Textures", [this, ParallelInit]() { LoadTextures(ParallelInit); }, {Instances});
+    // The SRBs are created with the pipeline, so the textures are bound once both are ready
+    Startup.AddTask(
+        "Bind textures", [this]() {
+            BindTextures(m_SRB);
+            for (auto& pSRB : m_WorkerSRBs)
+                BindTextures(pSRB);
+        },
+        {PSO, Textures});
+
+    Startup.Execute(ParallelInit);
+    Startup.LogTimeline();
+    UploadDeferredTextureLevels();
+
+    if (m_FileReader)
+    {
+        LOG_INFO_MESSAGE("Read ", m_FileReader->GetNumRequests(), " asset files (", m_FileReader->GetBytesRead() >> 10, " KB) ",
+                         m_FileReader->IsUsingIoUring() ? "through io_uring" : "on the thread pool");
+        m_FileReader.reset();
+    }
+
+    if (m_HotReload)
+    {
+        if (m_Archive)
+        {
+            LOG_WARNING_MESSAGE("Shader hot reload is not available when assets are loaded from an archive");
+            m_HotReload = false;
+        }
+        else
+            m_ShaderFileTimes = GetShaderFileTimes();
+    }
+
+    ConnectSceneFeed();
+    CreateScenes();
+    // Startup data is uploaded at once
+    m_Uploads->Flush(m_pImmediateContext, true);
+
+    if (!m_BatchViewsPath.empty())
+    {
+        ExitCommandLineMode(RunBatchRender());
+        return;
+    }
+
+    if (m_DrawBenchmarkDraws > 0)
+    {
+        ExitCommandLineMode(RunDrawBenchmark());
+        return;
+    }
+
+    if (m_DecodeBenchmarkIterations > 0)
+        RunDecodeBenchmark();
+
+    if (!m_CapturePath.empty())
+        StartCapture();
+}
+
+bool Tutorial05_TextureArray::RunBatchRender()
+{
+    std::vector<BatchCameraPose> Poses;
+    if (!LoadBatchCameraPoses(m_BatchViewsPath.c_str(), Poses))
+        return false;
+
+    const auto& SCDesc = m_pSwapChain->GetDesc();
+
+    BatchRenderInfo BatchInfo;
+    BatchInfo.pDevice     = m_pDevice;
+    BatchInfo.pContext    = m_pImmediateContext;
+    BatchInfo.pThreadPool = m_pThreadPool;
+    BatchInfo.Width       = m_BatchWidth;
+    BatchInfo.Height      = m_BatchHeight;
+    // Targets use the swap chain formats so that the main PSO can be used as is
+    BatchInfo.ColorFormat = SCDesc.ColorBufferFormat;
+    BatchInfo.DepthFormat = SCDesc.DepthBufferFormat;
+    BatchInfo.OutputDir   = m_BatchOutputDir;
+
+    const bool  IsGL   = m_pDevice->GetDeviceInfo().IsGLDevice();
+    const float Aspect = static_cast<float>(m_BatchWidth) / static_cast<float>(m_BatchHeight);
+    const auto  Proj   = float4x4::Projection(PI_F / 4.0f, Aspect, 0.1f, 100.f, IsGL);
+
+    const Uint32 NumWritten = Diligent::RunBatchRender(BatchInfo, Poses, [&](const BatchCameraPose& Pose, ITextureView* pRTV, ITextureView* pDSV) {
+        m_ConstantsRing.Begin(m_pImmediateContext);
+        const Uint32 ConstantsOffset = WriteVSConstants(m_ConstantsRing, ComputeOrbitViewMatrix(Pose.Yaw, Pose.Pitch, Pose.Distance, Pose.Target) * Proj);
+        m_ConstantsRing.End();
+
+        ClearRenderTargets(pRTV, pDSV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        DrawCubes(ConstantsOffset, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    });
+
+    m_pImmediateContext->WaitForIdle();
+    return NumWritten == Poses.size();
+}
+
+void Tutorial05_TextureArray::RunDecodeBenchmark()
+{
+    struct BenchmarkImage
+    {
+        std::string        Name;
+        std::vector<Uint8> Png;
+    };
+    std::vector<BenchmarkImage> Images;
+
+    AsyncFileReader Reader{m_pThreadPool};
+    for (Uint32 Slice = 0; Slice < NumTextures; ++Slice)
+        Reader.AddRequest(GetTextureFileName(Slice).c_str());
+    Reader.Submit();
+    for (Uint32 i = 0; i < Reader.GetNumRequests(); ++i)
+    {
+        if (Reader.Wait(i))
+            Images.push_back({Reader.GetPath(i), Reader.GetData(i)});
+    }
+
+    // Larger synthetic images: smooth gradients with a little noise, which compress like typical textures
+    std::mt19937 Rng{0};
+    for (Uint32 Size : {2048u, 4096u})
+    {
+        std::vector<Uint8> Pixels(size_t{Size} * Size * 4);
+        for (Uint32 y = 0; y < Size; ++y)
+        {
+            for (Uint32 x = 0; x < Size; ++x)
+            {
+                Uint8*       pPixel = &Pixels[(size_t{y} * Size + x) * 4];
+                const Uint32 Noise  = Rng() & 7;
+                pPixel[0]           = static_cast<Uint8>(x * 248 / Size + Noise);
+                pPixel[1]           = static_cast<Uint8>(y * 248 / Size + Noise);
+                pPixel[2]           = static_cast<Uint8>((x + y) * 127 / Size);
+                pPixel[3]           = 255;
+            }
+        }
+
+        Image::EncodeInfo EncodeInfo;
+        EncodeInfo.Width      = Size;
+        EncodeInfo.Height     = Size;
+        EncodeInfo.TexFormat  = TEX_FORMAT_RGBA8_UNORM;
+        EncodeInfo.KeepAlpha  = true;
+        EncodeInfo.pData      = Pixels.data();
+        EncodeInfo.Stride     = Size * 4;
+        EncodeInfo.FileFormat = IMAGE_FILE_FORMAT_PNG;
+
+        RefCntAutoPtr<IDataBlob> pEncodedImage;
+        Image::Encode(EncodeInfo, &pEncodedImage);
+        if (!pEncodedImage)
+            continue;
+        const auto* pData = static_cast<const Uint8*>(pEncodedImage->GetDataPtr());
+        Images.push_back({"synthetic " + std::to_string(Size) + "x" + std::to_string(Size), std::vector<Uint8>(pData, pData + pEncodedImage->GetSize())});
+    }
+
+    const Uint32 NumIterations = m_DecodeBenchmarkIterations;
+    LOG_INFO_MESSAGE("PNG decode benchmark (decode and full mip chain): ", NumIterations, " iterations per image");
+
+    TextureLoadInfo LoadInfo;
+    LoadInfo.IsSRGB = true;
+    for (const auto& Img : Images)
+    {
+        RefCntAutoPtr<ITextureLoader> pLoader;
+        DecodedPngTexture             Png;
+        bool                          FastDecoded = true;
+        double                        LoaderTime  = 0;
+        double                        FastTime    = 0;
+        for (Uint32 Iter = 0; Iter < NumIterations; ++Iter)
+        {
+            pLoader.Release();
+            const auto StartTime = std::chrono::high_resolution_clock::now();
+            CreateTextureLoaderFromMemory(Img.Png.data(), Img.Png.size(), false, LoadInfo, &pLoader);
+            const auto LoaderEndTime = std::chrono::high_resolution_clock::now();
+            FastDecoded              = DecodePngTexture(Img.Png.data(), Img.Png.size(), LoadInfo.IsSRGB, Png) && FastDecoded;
+            const auto FastEndTime   = std::chrono::high_resolution_clock::now();
+
+            LoaderTime += std::chrono::duration<double>(LoaderEndTime - StartTime).count();
+            FastTime += std::chrono::duration<double>(FastEndTime - LoaderEndTime).count();
+        }
+        if (!pLoader || !FastDecoded)
+        {
+            LOG_WARNING_MESSAGE("  ", Img.Name, ": ", !pLoader ? "the texture loader" : "the fast decoder", " failed to decode the image");
+            continue;
+        }
+
+        // Level 0 of both decoders must be identical
+        const auto& LoaderDesc = pLoader->GetTextureDesc();
+        bool        Match      = LoaderDesc.Width == Png.Desc.Width && LoaderDesc.Height == Png.Desc.Height && LoaderDesc.Format == Png.Desc.Format;
+        if (Match)
+        {
+            const auto LoaderData = pLoader->GetSubresourceData(0, 0);
+            for (Uint32 y = 0; y < Png.Desc.Height && Match; ++y)
+            {
+                Match = memcmp(static_cast<const Uint8*>(LoaderData.pData) + y * LoaderData.Stride,
+                               static_cast<const Uint8*>(Png.Mips[0].pData) + y * Png.Mips[0].Stride,
+                               size_t{Png.Desc.Width} * 4) == 0;
+            }
+        }
+
+        const double MPixels = static_cast<double>(Png.Desc.Width) * Png.Desc.Height * NumIterations / 1e6;
+        LOG_INFO_MESSAGE("  ", Img.Name, " (", Png.Desc.Width, "x", Png.Desc.Height, ", ", Img.Png.size() >> 10, " KB): loader ",
+                         LoaderTime * 1000.0 / NumIterations, " ms (", MPixels / LoaderTime, " MP/s), fast ",
+                         FastTime * 1000.0 / NumIterations, " ms (", MPixels / FastTime, " MP/s), ", LoaderTime / FastTime, "x",
+                         Match ? "" : "; level 0 differs from the texture loader");
+    }
+}
+
+bool Tutorial05_TextureArray::RunDrawBenchmark()
+{
+    // Draws go to offscreen targets so that the measurement does not depend on presentation
+    const auto& SCDesc = m_pSwapChain->GetDesc();
+
+    TextureDesc TexDesc;
+    TexDesc.Name      = "Draw benchmark color";
+    TexDesc.Type      = RESOURCE_DIM_TEX_2D;
+    TexDesc.Width     = 256;
+    TexDesc.Height    = 256;
+    TexDesc.Format    = SCDesc.ColorBufferFormat;
+    TexDesc.BindFlags = BIND_RENDER_TARGET;
+    RefCntAutoPtr<ITexture> pColor;
+    m_pDevice->CreateTexture(TexDesc, nullptr, &pColor);
+
+    TexDesc.Name      = "Draw benchmark depth";
+    TexDesc.Format    = SCDesc.DepthBufferFormat;
+    TexDesc.BindFlags = BIND_DEPTH_STENCIL;
+    RefCntAutoPtr<ITexture> pDepth;
+    m_pDevice->CreateTexture(TexDesc, nullptr, &pDepth);
+
+    ITextureView* pRTV = pColor->GetDefaultView(TEXTURE_VIEW_RENDER_TARGET);
+    ITextureView* pDSV = pDepth->GetDefaultView(TEXTURE_VIEW_DEPTH_STENCIL);
+
+    struct BenchmarkMode
+    {
+        const char*                    Name;
+        RESOURCE_STATE_TRANSITION_MODE TransitionMode;
+        bool                           Validate;
+        bool                           StateCache;
+        bool                           StaticList;
+    };
+    // clang-format off
+    const BenchmarkMode Modes[] =
+    {
+        {"transition",  RESOURCE_STATE_TRANSITION_MODE_TRANSITION, true,  false, false},
+        {"validation",  RESOURCE_STATE_TRANSITION_MODE_VERIFY,     true,  false, false},
+        {"production",  RESOURCE_STATE_TRANSITION_MODE_NONE,       false, false, false},
+        {"state cache", RESOURCE_STATE_TRANSITION_MODE_NONE,       false, true,  false},
+        {"static list", RESOURCE_STATE_TRANSITION_MODE_NONE,       false, false, true},
+    };
+    // clang-format on
+
+    constexpr int NumWarmupFrames = 10;
+    constexpr int NumFrames       = 100;
+
+    // Every draw rebinds the full state like the frame loop does, and draws a single instance
+    const Uint32 NumDraws     = m_DrawBenchmarkDraws;
+    const Uint32 NumInstances = std::max(m_Instances.GetCount(), 1u);
+    LOG_INFO_MESSAGE("Draw submission benchmark: ", NumDraws, " draws per frame, ", NumFrames, " frames");
 
-    // Load cube vertex and index buffers
-    m_CubeVertexBuffer = TexturedCube::CreateVertexBuffer(m_pDevice, GEOMETRY_PRIMITIVE_VERTEX_FLAG_POS_TEX);
-    m_CubeIndexBuffer  = TexturedCube::CreateIndexBuffer(m_pDevice);
+    StaticDrawList StaticDraws;
+    StaticDraws.Begin();
+    for (Uint32 draw = 0; draw < NumDraws; ++draw)
+    {
+        StaticDrawList::DrawPacket Packet;
+        Packet.pPSO                          = m_pPSO;
+        Packet.pSRB                          = m_SRB;
+        Packet.pVertexBuffers[0]             = m_CubeVertexBuffer;
+        Packet.pVertexBuffers[1]             = m_InstanceBuffer;
+        Packet.NumVertexBuffers              = 2;
+        Packet.pIndexBuffer                  = m_CubeIndexBuffer;
+        Packet.Attribs.IndexType             = VT_UINT32;
+        Packet.Attribs.NumIndices            = 36;
+        Packet.Attribs.NumInstances          = 1;
+        Packet.Attribs.FirstInstanceLocation = draw % NumInstances;
+        StaticDraws.AddDraw(Packet);
+    }
+    StaticDraws.End();
 
-    CreateInstanceBuffer();
-    LoadTextures();
+    ContextStateCache BenchStateCache{m_pImmediateContext};
+
+    // Ctx is either the device context or the state cache in front of it
+    auto SubmitDraws = [&](auto& Ctx, const BenchmarkMode& Mode) {
+        const Uint64 offsets[] = {0, 0};
+        IBuffer*     pBuffs[]  = {m_CubeVertexBuffer, m_InstanceBuffer};
+        for (Uint32 draw = 0; draw < NumDraws; ++draw)
+        {
+            Ctx.SetVertexBuffers(0, _countof(pBuffs), pBuffs, offsets, Mode.TransitionMode, Mode.Validate ? SET_VERTEX_BUFFERS_FLAG_RESET : SET_VERTEX_BUFFERS_FLAG_NONE);
+            Ctx.SetIndexBuffer(m_CubeIndexBuffer, 0, Mode.TransitionMode);
+            Ctx.SetPipelineState(m_pPSO);
+            Ctx.CommitShaderResources(m_SRB, Mode.TransitionMode);
+
+            DrawIndexedAttribs DrawAttrs;
+            DrawAttrs.IndexType             = VT_UINT32;
+            DrawAttrs.NumIndices            = 36;
+            DrawAttrs.NumInstances          = 1;
+            DrawAttrs.FirstInstanceLocation = draw % NumInstances;
+            DrawAttrs.Flags                 = Mode.Validate ? DRAW_FLAG_VERIFY_ALL : DRAW_FLAG_NONE;
+            m_pImmediateContext->DrawIndexed(DrawAttrs);
+        }
+    };
+
+    for (const auto& Mode : Modes)
+    {
+        double SubmitTime = 0;
+        for (int frame = 0; frame < NumWarmupFrames + NumFrames; ++frame)
+        {
+            ClearRenderTargets(pRTV, pDSV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            BenchStateCache.Invalidate();
+
+            // Pre-transition the resources as the render graph does
+            StateTransitionDesc Barriers[] = {
+                {m_CubeVertexBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_VERTEX_BUFFER, STATE_TRANSITION_FLAG_UPDATE_STATE},
+                {m_CubeIndexBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_INDEX_BUFFER, STATE_TRANSITION_FLAG_UPDATE_STATE},
+                {m_InstanceBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_VERTEX_BUFFER, STATE_TRANSITION_FLAG_UPDATE_STATE},
+                {m_TextureSRV->GetTexture(), RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, STATE_TRANSITION_FLAG_UPDATE_STATE},
+                {m_TextureSliceRemap, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_CONSTANT_BUFFER, STATE_TRANSITION_FLAG_UPDATE_STATE},
+            };
+            m_pImmediateContext->TransitionResourceStates(_countof(Barriers), Barriers);
+            if (m_PipelineVariant.MipFeedback)
+            {
+                StateTransitionDesc FeedbackBarrier{m_MipFeedback->GetBuffer(), RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_UNORDERED_ACCESS, STATE_TRANSITION_FLAG_UPDATE_STATE};
+                m_pImmediateContext->TransitionResourceStates(1, &FeedbackBarrier);
+            }
+
+            m_ConstantsRing.Begin(m_pImmediateContext);
+            const Uint32 ConstantsOffset = WriteVSConstants(m_ConstantsRing, m_ViewProjMatrix);
+            m_ConstantsRing.End();
+            m_ConstantsVar->SetBufferOffset(ConstantsOffset);
+
+            const auto StartTime = std::chrono::high_resolution_clock::now();
+            if (Mode.StaticList)
+                StaticDraws.Replay(m_pImmediateContext);
+            else if (Mode.StateCache)
+                SubmitDraws(BenchStateCache, Mode);
+            else
+                SubmitDraws(*m_pImmediateContext, Mode);
+            const auto EndTime = std::chrono::high_resolution_clock::now();
+            if (frame >= NumWarmupFrames)
+                SubmitTime += std::chrono::duration<double>(EndTime - StartTime).count();
+
+            // Do not let the CPU run ahead; dynamic memory is only recycled once frames complete
+            m_pImmediateContext->Flush();
+            m_pImmediateContext->FinishFrame();
+            m_pImmediateContext->WaitForIdle();
+            m_pDevice->ReleaseStaleResources();
+        }
+
+        const double MsPerFrame = SubmitTime * 1000.0 / NumFrames;
+        LOG_INFO_MESSAGE("  ", Mode.Name, ": ", MsPerFrame, " ms per frame, ", MsPerFrame * 1000000.0 / NumDraws, " ns per draw");
+    }
+
+    return true;
+}
+
+void Tutorial05_TextureArray::StartCapture()
+{
+    if (m_Capture)
+        return;
+
+    if (m_CapturePath.empty())
+    {
+        switch (m_CaptureFormat)
+        {
+            case FrameCapture::FILE_FORMAT::Y4M: m_CapturePath = "capture.y4m"; break;
+            case FrameCapture::FILE_FORMAT::Raw: m_CapturePath = "capture.rgba"; break;
+            case FrameCapture::FILE_FORMAT::PNG: m_CapturePath = "."; break;
+        }
+    }
+
+    const auto& SCDesc = m_pSwapChain->GetDesc();
+
+    FrameCapture::CreateInfo CaptureCI;
+    CaptureCI.pDevice    = m_pDevice;
+    CaptureCI.Width      = SCDesc.Width;
+    CaptureCI.Height     = SCDesc.Height;
+    CaptureCI.Format     = SCDesc.ColorBufferFormat;
+    CaptureCI.FileFormat = m_CaptureFormat;
+    CaptureCI.OutputPath = m_CapturePath;
+    m_Capture            = FrameCapture::Create(CaptureCI);
+    if (m_Capture)
+        LOG_INFO_MESSAGE("Capturing ", SCDesc.Width, "x", SCDesc.Height, " frames to '", m_CapturePath, "'");
+    m_RenderGraphDirty = true;
+}
+
+void Tutorial05_TextureArray::StopCapture()
+{
+    if (!m_Capture)
+        return;
+
+    m_Capture->Finish(m_pImmediateContext);
+    const auto Stats = m_Capture->GetStats();
+    LOG_INFO_MESSAGE("Frame capture finished: ", Stats.NumWritten, " frames written, ", Stats.NumDropped, " dropped");
+    m_Capture.reset();
+    m_RenderGraphDirty = true;
 }
 
 static float angle = (PI_F / 1.0);
@@ -275,62 +1710,613 @@ void Tutorial05_TextureArray::PopulateInstanceBuffer()
         InstanceDataArray[21].Matrix = float4x4::Scale(1, 1, 1) * float4x4::Translation(0.0f, -7.0f, -3.0f) * float4x4::RotationY(angle);
         InstanceDataArray[21].TextureInd = 1;
 
-        Uint32 DataSize = static_cast<Uint32>(sizeof(InstanceData) * InstanceDataArray.size());
-        m_pImmediateContext->UpdateBuffer(m_InstanceBuffer, 0, DataSize, InstanceDataArray.data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        // Cubes cycle through the first three slices of the array. The current frame
+        // is computed in the vertex shader, so the animation costs nothing on the CPU.
+        if (m_AnimateTextures)
+        {
+            for (Uint32 i = 0; i < NumInstances; ++i)
+            {
+                auto& Inst = InstanceDataArray[i];
+                if (Inst.TextureInd < 3)
+                    Inst.Flipbook = float4{0, 3, m_FlipbookRate, Inst.TextureInd};
+            }
+        }
+
+        // The scene instances are created once and then updated in place through their handles
+        m_SceneInstances.resize(NumInstances);
+        for (Uint32 i = 0; i < NumInstances; ++i)
+        {
+            if (!m_Instances.Update(m_SceneInstances[i], InstanceDataArray[i]))
+                m_SceneInstances[i] = m_Instances.Add(InstanceDataArray[i]);
+        }
+        // Apply commands submitted by other threads since the last frame
+        m_InstanceCommands.Drain(m_Instances);
+        m_Instances.FlushDirty(*m_Uploads, m_InstanceBuffer);
+    }
+}
+
+void Tutorial05_TextureArray::StartSimulation()
+{
+    if (m_SimThread.joinable())
+        return;
+
+    // The producer is registered once and reused by subsequent simulation threads
+    if (m_pSimProducer == nullptr)
+        m_pSimProducer = m_InstanceCommands.RegisterProducer(NumSimObjects);
+    if (m_pSimProducer == nullptr)
+        return;
+
+    m_SimRunning.store(true);
+    m_SimFinished.store(false);
+    m_SimThread = std::thread{&Tutorial05_TextureArray::SimulationThreadFunc, this};
+}
+
+void Tutorial05_TextureArray::StopSimulation()
+{
+    if (!m_SimThread.joinable())
+        return;
+
+    m_SimRunning.store(false);
+    // Keep draining the queue while the thread submits its final destroy commands,
+    // otherwise it could wait on a full queue forever
+    while (!m_SimFinished.load())
+    {
+        m_InstanceCommands.Drain(m_Instances);
+        std::this_thread::yield();
     }
+    m_SimThread.join();
+    m_InstanceCommands.Drain(m_Instances);
 }
 
+void Tutorial05_TextureArray::SimulationThreadFunc()
+{
+    // Small cubes orbiting the scene. A fraction of them is despawned and respawned
+    // every step to exercise create/destroy commands.
+    std::mt19937                          Rng{std::random_device{}()};
+    std::uniform_real_distribution<float> Dist{0.f, 1.f};
+
+    std::vector<bool>            Alive(NumSimObjects, false);
+    std::vector<float>           Phase(NumSimObjects);
+    std::vector<InstanceCommand> Commands;
+    Commands.reserve(NumSimObjects * 2);
+
+    const auto StartTime = std::chrono::steady_clock::now();
+    while (m_SimRunning.load())
+    {
+        const float Time = std::chrono::duration<float>(std::chrono::steady_clock::now() - StartTime).count();
 
-// Render a frame
-void Tutorial05_TextureArray::Render()
+        Commands.clear();
+        for (Uint32 i = 0; i < NumSimObjects; ++i)
+        {
+            if (Alive[i] && Dist(Rng) < 0.01f)
+            {
+                Commands.push_back({InstanceCommand::TYPE::Destroy, i, {}});
+                Alive[i] = false;
+                continue;
+            }
+
+            const bool Spawn = !Alive[i] && Dist(Rng) < 0.05f;
+            if (Spawn)
+                Phase[i] = Dist(Rng) * 2.f * PI_F;
+            if (!Alive[i] && !Spawn)
+                continue;
+
+            const float  Angle  = Phase[i] + Time * 0.5f;
+            const float  Radius = 8.f + 2.f * sinf(Phase[i] * 3.f);
+            InstanceData Data;
+            Data.Matrix     = float4x4::Scale(0.2f, 0.2f, 0.2f) * float4x4::Translation(Radius * cosf(Angle), 2.f + sinf(Angle * 2.f + Phase[i]), Radius * sinf(Angle));
+            Data.TextureInd = static_cast<float>(i % 3);
+            Commands.push_back({Spawn ? InstanceCommand::TYPE::Create : InstanceCommand::TYPE::Update, i, Data});
+            Alive[i] = true;
+        }
+
+        // Commands that did not fit into the queue are dropped; the next step resubmits
+        // the state of live objects. Lost creates/destroys are retried below.
+        const Uint32 NumSubmitted = m_pSimProducer->Submit(Commands.data(), static_cast<Uint32>(Commands.size()));
+        for (size_t c = NumSubmitted; c < Commands.size(); ++c)
+        {
+            if (Commands[c].Type != InstanceCommand::TYPE::Update)
+                Alive[Commands[c].LocalId] = Commands[c].Type == InstanceCommand::TYPE::Destroy;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds{2});
+    }
+
+    // Remove all simulated objects before the thread exits
+    for (Uint32 i = 0; i < NumSimObjects; ++i)
+    {
+        while (Alive[i] && !m_pSimProducer->Destroy(i))
+            std::this_thread::yield();
+    }
+    m_SimFinished.store(true);
+}
+
+void Tutorial05_TextureArray::ConnectSceneFeed()
 {
-    auto* pRTV = m_pSwapChain->GetCurrentBackBufferRTV();
-    auto* pDSV = m_pSwapChain->GetDepthBufferDSV();
+#if PLATFORM_LINUX
+    if (m_SceneFeedName.empty() || m_SceneFeed)
+        return;
+
+    m_LastFeedCheckTime = m_CurrTime;
+    m_SceneFeed         = SharedSceneFeed::Open(m_SceneFeedName.c_str());
+    if (!m_SceneFeed)
+        return;
+
+    // The snapshot is copied every frame straight into the memory of a dynamic buffer
+    BufferDesc FeedBuffDesc;
+    FeedBuffDesc.Name           = "Scene feed instance buffer";
+    FeedBuffDesc.Usage          = USAGE_DYNAMIC;
+    FeedBuffDesc.BindFlags      = BIND_VERTEX_BUFFER;
+    FeedBuffDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
+    FeedBuffDesc.Size           = sizeof(InstanceData) * m_SceneFeed->GetMaxInstances();
+    m_FeedInstanceBuffer.Release();
+    m_pDevice->CreateBuffer(FeedBuffDesc, nullptr, &m_FeedInstanceBuffer);
+    m_RenderGraphDirty = true;
+    LOG_INFO_MESSAGE("Connected to scene feed '", m_SceneFeedName, "' (", m_SceneFeed->GetMaxInstances(), " instances)");
+#endif
+}
+
+void Tutorial05_TextureArray::DrawSceneFeed(RESOURCE_STATE_TRANSITION_MODE TransitionMode)
+{
+#if PLATFORM_LINUX
+    if (!m_SceneFeed)
+        return;
+
+    Uint32 NumInstances = 0;
+    Uint64 FrameId      = 0;
+    {
+        MapHelper<InstanceData> FeedInstances(m_pImmediateContext, m_FeedInstanceBuffer, MAP_WRITE, MAP_FLAG_DISCARD);
+        if (!m_SceneFeed->ReadLatest(FeedInstances, NumInstances, FrameId))
+            NumInstances = 0;
+    }
+    if (NumInstances == 0)
+        return;
+
+    const Uint64 offsets[] = {0, 0};
+    IBuffer*     pBuffs[]  = {m_CubeVertexBuffer, m_FeedInstanceBuffer};
+    m_StateCache.SetVertexBuffers(0, _countof(pBuffs), pBuffs, offsets, TransitionMode, SET_VERTEX_BUFFERS_FLAG_NONE);
 
+    DrawIndexedAttribs DrawAttrs;
+    DrawAttrs.IndexType    = VT_UINT32;
+    DrawAttrs.NumIndices   = 36;
+    DrawAttrs.NumInstances = NumInstances;
+    DrawAttrs.Flags        = m_ValidationMode ? DRAW_FLAG_VERIFY_ALL : DRAW_FLAG_NONE;
+    m_pImmediateContext->DrawIndexed(DrawAttrs);
+#endif
+}
+
+void Tutorial05_TextureArray::CreateScenes()
+{
+    const auto& SCDesc = m_pSwapChain->GetDesc();
+    for (int i = 0; i < m_NumScenes; ++i)
+    {
+        const std::string Name = "Scene " + std::to_string(i);
+        // Scene targets use the swap chain formats so that the shared PSO can render into them
+        auto pScene = std::make_unique<OffscreenScene>(m_pDevice, Name.c_str(), 256, 256, SCDesc.ColorBufferFormat, SCDesc.DepthBufferFormat, 4096);
+
+        // Every scene gets its own grid of cubes
+        const int   GridSize = 2 + i % 4;
+        const float Center   = static_cast<float>(GridSize - 1) * 0.5f;
+        for (int x = 0; x < GridSize; ++x)
+        {
+            for (int y = 0; y < GridSize; ++y)
+            {
+                for (int z = 0; z < GridSize; ++z)
+                {
+                    InstanceData Inst;
+                    Inst.Matrix     = float4x4::Translation((static_cast<float>(x) - Center) * 2.5f,
+                                                            (static_cast<float>(y) - Center) * 2.5f,
+                                                            (static_cast<float>(z) - Center) * 2.5f);
+                    Inst.TextureInd = static_cast<float>((x + y + z + i) % NumTextures);
+                    pScene->GetInstances().Add(Inst);
+                }
+            }
+        }
+        m_Scenes.emplace_back(std::move(pScene));
+    }
+}
+
+void Tutorial05_TextureArray::UpdateScenes()
+{
+    const bool IsGL = m_pDevice->GetDeviceInfo().IsGLDevice();
+    const auto Proj = float4x4::Projection(PI_F / 4.0f, 1.f, 0.1f, 100.f, IsGL);
+    for (size_t i = 0; i < m_Scenes.size(); ++i)
+    {
+        const float Yaw  = static_cast<float>(m_CurrTime) * 0.3f + static_cast<float>(i);
+        const auto  View = ComputeOrbitViewMatrix(Yaw, 0.4f, 15.f, float3{0, 0, 0});
+        m_Scenes[i]->SetViewProj(View * Proj);
+    }
+}
+
+void Tutorial05_TextureArray::RenderScenes(const RenderGraph& Graph)
+{
+    SharedSceneResources Shared;
+    Shared.pPSO                   = m_pPSO;
+    Shared.pSRB                   = m_SRB;
+    Shared.pConstantsVar          = m_ConstantsVar;
+    Shared.pCubeVB                = m_CubeVertexBuffer;
+    Shared.pCubeIB                = m_CubeIndexBuffer;
+    Shared.ConvertPSOutputToGamma = m_ConvertPSOutputToGamma;
+    Shared.ValidateDraws          = m_ValidationMode;
+
+    // The graph has transitioned all resources of the pass
+    auto GetDSV = [&](size_t Scene) {
+        return Graph.GetTexture(m_RGSceneDepthBuffers[Scene % m_RGSceneDepthBuffers.size()])->GetDefaultView(TEXTURE_VIEW_DEPTH_STENCIL);
+    };
+
+    if (!RenderScenesInParallel())
+    {
+        // One scene per frame on the immediate context. Its constants were written with the frame constants.
+        m_Scenes[m_RoundRobinScene]->Render(m_StateCache, Shared, GetDSV(m_RoundRobinScene), m_RoundRobinConstantsOffset, GetBindTransitionMode());
+        return;
+    }
+
+    const float  Time       = static_cast<float>(m_CurrTime);
+    const size_t NumWorkers = std::min(m_pDeferredContexts.size(), m_Scenes.size());
+    m_SceneConstantsOffsets.resize(m_Scenes.size());
+
+    std::vector<RefCntAutoPtr<ICommandList>> CmdLists(NumWorkers);
+    std::vector<RefCntAutoPtr<IAsyncTask>>   Tasks(NumWorkers);
+    for (size_t w = 0; w < NumWorkers; ++w)
+    {
+        Tasks[w] = EnqueueAsyncWork(m_pThreadPool,
+                                    [&, w](Uint32) {
+                                        IDeviceContext* pCtx       = m_pDeferredContexts[w];
+                                        auto&           StateCache = m_DeferredStateCaches[w];
+                                        auto&           Ring       = m_DeferredConstantsRings[w];
+                                        pCtx->Begin(0);
+
+                                        // Constants of all scenes of the worker go into a single mapping
+                                        // that is closed before the first draw
+                                        Ring.Begin(pCtx);
+                                        for (size_t s = w; s < m_Scenes.size(); s += NumWorkers)
+                                            m_SceneConstantsOffsets[s] = m_Scenes[s]->WriteConstants(Ring, Time);
+                                        Ring.End();
+
+                                        SharedSceneResources WorkerShared = Shared;
+                                        WorkerShared.pSRB                 = m_WorkerSRBs[w];
+                                        WorkerShared.pConstantsVar        = m_WorkerSRBs[w]->GetVariableByName(SHADER_TYPE_VERTEX, "Constants");
+
+                                        // A new command list starts with no state bound
+                                        StateCache.Invalidate();
+                                        for (size_t s = w; s < m_Scenes.size(); s += NumWorkers)
+                                            m_Scenes[s]->Render(StateCache, WorkerShared, GetDSV(s), m_SceneConstantsOffsets[s], GetBindTransitionMode());
+                                        pCtx->FinishCommandList(&CmdLists[w]);
+                                        return ASYNC_TASK_STATUS_COMPLETE;
+                                    });
+    }
+
+    std::vector<ICommandList*> pCmdLists(NumWorkers);
+    for (size_t w = 0; w < NumWorkers; ++w)
+    {
+        Tasks[w]->WaitForCompletion();
+        pCmdLists[w] = CmdLists[w];
+    }
+    m_pImmediateContext->ExecuteCommandLists(static_cast<Uint32>(NumWorkers), pCmdLists.data());
+
+    for (size_t w = 0; w < NumWorkers; ++w)
+        m_pDeferredContexts[w]->FinishFrame();
+}
+
+void Tutorial05_TextureArray::ShowScenesUI()
+{
+    if (m_Scenes.empty())
+        return;
+
+    ImGui::SetNextWindowPos(ImVec2(10, 350), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("Scenes", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
+    {
+        int Mode = static_cast<int>(m_SceneRenderMode);
+        if (ImGui::Combo("Render mode", &Mode, "Round robin\0Parallel\0"))
+        {
+            m_SceneRenderMode = static_cast<SCENE_RENDER_MODE>(Mode);
+            // Parallel mode needs a depth buffer per scene
+            m_RenderGraphDirty = true;
+        }
+
+        for (size_t i = 0; i < m_Scenes.size(); ++i)
+        {
+            if (i % 4 != 0)
+                ImGui::SameLine();
+            ImGui::Image(reinterpret_cast<ImTextureID>(m_Scenes[i]->GetColorSRV()), ImVec2(128, 128));
+        }
+    }
+    ImGui::End();
+}
+
+void Tutorial05_TextureArray::ClearRenderTargets(ITextureView* pRTV, ITextureView* pDSV, RESOURCE_STATE_TRANSITION_MODE TransitionMode)
+{
+    m_pImmediateContext->SetRenderTargets(1, &pRTV, pDSV, TransitionMode);
 
     // Clear the back buffer
     float4 ClearColor = {0.0f, 0.0f, 0.0f, 1.0f};
-
-    PopulateInstanceBuffer();
     if (m_ConvertPSOutputToGamma)
     {
         // If manual gamma correction is required, we need to clear the render target with sRGB color
         ClearColor = LinearToSRGB(ClearColor);
     }
-    m_pImmediateContext->ClearRenderTarget(pRTV, ClearColor.Data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-    m_pImmediateContext->ClearDepthStencil(pDSV, CLEAR_DEPTH_FLAG, 1.f, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pImmediateContext->ClearRenderTarget(pRTV, ClearColor.Data(), TransitionMode);
+    m_pImmediateContext->ClearDepthStencil(pDSV, CLEAR_DEPTH_FLAG, 1.f, 0, TransitionMode);
+}
 
-    {
-        // Map the buffer and write current world-view-projection matrix
-        MapHelper<float4x4> CBConstants(m_pImmediateContext, m_VSConstants, MAP_WRITE, MAP_FLAG_DISCARD);
-        CBConstants[0] = m_ViewProjMatrix;
-        CBConstants[1] = m_RotationMatrix;
-    }
+Uint32 Tutorial05_TextureArray::WriteVSConstants(DynamicUniformRing& Ring, const float4x4& ViewProj)
+{
+    // Write current world-view-projection matrix into the mapped ring
+    Uint32 Offset     = ~0u;
+    auto*  pConstants = Ring.Allocate<VSConstants>(Offset);
+    if (pConstants == nullptr)
+        return ~0u;
+
+    pConstants->ViewProj = ViewProj;
+    pConstants->Rotation = m_RotationMatrix;
+    pConstants->Time     = float4{static_cast<float>(m_CurrTime), m_FlipbookCrossFade ? 1.f : 0.f, 0, 0};
+    return Offset;
+}
+
+void Tutorial05_TextureArray::DrawCubes(Uint32 ConstantsOffset, RESOURCE_STATE_TRANSITION_MODE TransitionMode)
+{
+    if (ConstantsOffset == ~0u)
+        return;
 
     // Bind vertex, instance and index buffers
     const Uint64 offsets[] = {0, 0};
     IBuffer*     pBuffs[]  = {m_CubeVertexBuffer, m_InstanceBuffer};
-    m_pImmediateContext->SetVertexBuffers(0, _countof(pBuffs), pBuffs, offsets, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, SET_VERTEX_BUFFERS_FLAG_RESET);
-    m_pImmediateContext->SetIndexBuffer(m_CubeIndexBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    // The pipeline only uses the first two slots, so other slots only need to be reset
+    // in validation mode where stale bindings would be reported
+    m_StateCache.SetVertexBuffers(0, _countof(pBuffs), pBuffs, offsets, TransitionMode, m_ValidationMode ? SET_VERTEX_BUFFERS_FLAG_RESET : SET_VERTEX_BUFFERS_FLAG_NONE);
+    m_StateCache.SetIndexBuffer(m_CubeIndexBuffer, 0, TransitionMode);
 
     // Set the pipeline state
-    m_pImmediateContext->SetPipelineState(m_pPSO);
+    m_StateCache.SetPipelineState(m_pPSO);
     // Commit shader resources. RESOURCE_STATE_TRANSITION_MODE_TRANSITION mode
     // makes sure that resources are transitioned to required states.
-    m_pImmediateContext->CommitShaderResources(m_SRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_StateCache.CommitShaderResources(m_SRB, TransitionMode);
+    // Select the constant block. Dynamic offsets are applied at draw time, so the SRB
+    // does not need to be committed again.
+    m_ConstantsVar->SetBufferOffset(ConstantsOffset);
 
     DrawIndexedAttribs DrawAttrs;       // This is an indexed draw call
     DrawAttrs.IndexType    = VT_UINT32; // Index type
     DrawAttrs.NumIndices   = 36;
-    DrawAttrs.NumInstances = m_GridSize * m_GridSize * m_GridSize; // The number of instances
+    DrawAttrs.NumInstances = m_Instances.GetCount(); // The number of instances
     // Verify the state of vertex and index buffers
-    DrawAttrs.Flags = DRAW_FLAG_VERIFY_ALL;
+    DrawAttrs.Flags = m_ValidationMode ? DRAW_FLAG_VERIFY_ALL : DRAW_FLAG_NONE;
     m_pImmediateContext->DrawIndexed(DrawAttrs);
+
+    DrawSceneFeed(TransitionMode);
+}
+
+void Tutorial05_TextureArray::DrawCubesStatic(Uint32 ConstantsOffset)
+{
+    if (ConstantsOffset == ~0u)
+        return;
+
+    // Instances are created and destroyed by the simulation thread and the UI;
+    // the baked draw is only rebuilt when the number of instances changes
+    if (!m_StaticDraws.IsValid() || m_StaticDrawsInstanceCount != m_Instances.GetCount())
+    {
+        StaticDrawList::DrawPacket Packet;
+        Packet.pPSO                 = m_pPSO;
+        Packet.pSRB                 = m_SRB;
+        Packet.pVertexBuffers[0]    = m_CubeVertexBuffer;
+        Packet.pVertexBuffers[1]    = m_InstanceBuffer;
+        Packet.NumVertexBuffers     = 2;
+        Packet.pIndexBuffer         = m_CubeIndexBuffer;
+        Packet.Attribs.IndexType    = VT_UINT32;
+        Packet.Attribs.NumIndices   = 36;
+        Packet.Attribs.NumInstances = m_Instances.GetCount();
+
+        m_StaticDraws.Begin();
+        m_StaticDraws.AddDraw(Packet);
+        m_StaticDraws.End();
+        m_StaticDrawsInstanceCount = m_Instances.GetCount();
+    }
+
+    // Camera and time live in a dynamic buffer, so they stay out of the baked list
+    m_ConstantsVar->SetBufferOffset(ConstantsOffset);
+    m_StaticDraws.Replay(m_pImmediateContext);
+    // The replay binds the state directly
+    m_StateCache.Invalidate();
+
+    // Feed instances change every frame
+    DrawSceneFeed(GetBindTransitionMode());
+}
+
+void Tutorial05_TextureArray::BuildRenderGraph()
+{
+    m_RenderGraph.Reset();
+
+    const auto CubeVB    = m_RenderGraph.ImportBuffer(m_CubeVertexBuffer);
+    const auto CubeIB    = m_RenderGraph.ImportBuffer(m_CubeIndexBuffer);
+    const auto Instances = m_RenderGraph.ImportBuffer(m_InstanceBuffer);
+    const auto TexArray  = m_RenderGraph.ImportTexture(m_TextureSRV->GetTexture());
+    const auto SliceMap  = m_RenderGraph.ImportBuffer(m_TextureSliceRemap);
+    // Every pass that draws with the cube pipeline writes the mip feedback
+    const auto Feedback = m_PipelineVariant.MipFeedback ? m_RenderGraph.ImportBuffer(m_MipFeedback->GetBuffer()) : InvalidRGResource;
+    // Swap chain textures change every frame and are set before the graph is executed
+    m_RGBackBuffer  = m_RenderGraph.ImportTexture(nullptr);
+    m_RGDepthBuffer = m_RenderGraph.ImportTexture(nullptr);
+
+    std::vector<RGResourceId> SceneColors;
+    if (!m_Scenes.empty())
+    {
+        // Depth buffers of offscreen scenes only live during the scene pass. Round-robin
+        // mode renders a single scene per frame and only needs one.
+        const size_t NumDepthBuffers = RenderScenesInParallel() ? m_Scenes.size() : 1;
+        m_RGSceneDepthBuffers.resize(NumDepthBuffers);
+        for (auto& Depth : m_RGSceneDepthBuffers)
+            Depth = m_RenderGraph.CreateTransientTexture(m_Scenes[0]->GetDepthBufferDesc());
+
+        auto Pass = m_RenderGraph.AddPass("Scenes", [this](IDeviceContext*, const RenderGraph& Graph) { RenderScenes(Graph); });
+        Pass.Read(CubeVB, RESOURCE_STATE_VERTEX_BUFFER)
+            .Read(CubeIB, RESOURCE_STATE_INDEX_BUFFER)
+            .Read(TexArray, RESOURCE_STATE_SHADER_RESOURCE)
+            .Read(SliceMap, RESOURCE_STATE_CONSTANT_BUFFER);
+        for (const auto& pScene : m_Scenes)
+        {
+            SceneColors.push_back(m_RenderGraph.ImportTexture(pScene->GetColorTexture()));
+            Pass.Write(SceneColors.back(), RESOURCE_STATE_RENDER_TARGET)
+                .Read(m_RenderGraph.ImportBuffer(pScene->GetInstanceBuffer()), RESOURCE_STATE_VERTEX_BUFFER);
+        }
+        for (auto Depth : m_RGSceneDepthBuffers)
+            Pass.Write(Depth, RESOURCE_STATE_DEPTH_WRITE);
+        if (Feedback != InvalidRGResource)
+            Pass.Write(Feedback, RESOURCE_STATE_UNORDERED_ACCESS);
+    }
+
+    m_RenderGraph
+        .AddPass("Clear", [this](IDeviceContext*, const RenderGraph&) {
+            ClearRenderTargets(m_pFrameRTV, m_pFrameDSV, GetBindTransitionMode());
+        })
+        .Write(m_RGBackBuffer, RESOURCE_STATE_RENDER_TARGET)
+        .Write(m_RGDepthBuffer, RESOURCE_STATE_DEPTH_WRITE);
+
+    auto CubesPass = m_RenderGraph.AddPass("Cubes", [this](IDeviceContext* pContext, const RenderGraph&) {
+        pContext->SetRenderTargets(1, &m_pFrameRTV, m_pFrameDSV, GetBindTransitionMode());
+        if (m_UseStaticDraws)
+            DrawCubesStatic(m_MainConstantsOffset);
+        else
+            DrawCubes(m_MainConstantsOffset, GetBindTransitionMode());
+    });
+    CubesPass.Write(m_RGBackBuffer, RESOURCE_STATE_RENDER_TARGET)
+        .Write(m_RGDepthBuffer, RESOURCE_STATE_DEPTH_WRITE)
+        .Read(CubeVB, RESOURCE_STATE_VERTEX_BUFFER)
+        .Read(CubeIB, RESOURCE_STATE_INDEX_BUFFER)
+        .Read(Instances, RESOURCE_STATE_VERTEX_BUFFER)
+        .Read(TexArray, RESOURCE_STATE_SHADER_RESOURCE)
+        .Read(SliceMap, RESOURCE_STATE_CONSTANT_BUFFER);
+#if PLATFORM_LINUX
+    if (m_FeedInstanceBuffer)
+        CubesPass.Read(m_RenderGraph.ImportBuffer(m_FeedInstanceBuffer), RESOURCE_STATE_VERTEX_BUFFER);
+#endif
+
+    if (Feedback != InvalidRGResource)
+    {
+        CubesPass.Write(Feedback, RESOURCE_STATE_UNORDERED_ACCESS);
+        // The readback clears the buffer, which leaves it in the COPY_DEST state until the
+        // first pass of the next frame
+        m_RenderGraph
+            .AddPass("Mip feedback", [this](IDeviceContext* pContext, const RenderGraph&) {
+                if (m_MipFeedbackWindowDue && m_MipFeedback->EndWindow(pContext, GetBindTransitionMode()))
+                    m_MipFeedbackWindowStart = m_CurrTime;
+            })
+            .Read(Feedback, RESOURCE_STATE_COPY_SOURCE);
+    }
+
+    if (m_Capture)
+    {
+        m_RenderGraph
+            .AddPass("Capture", [this](IDeviceContext* pContext, const RenderGraph& Graph) {
+                m_Capture->CaptureFrame(pContext, Graph.GetTexture(m_RGBackBuffer), GetBindTransitionMode());
+            })
+            .Read(m_RGBackBuffer, RESOURCE_STATE_COPY_SOURCE);
+    }
+
+    // The UI is drawn by the application after Render() returns. The pass leaves the
+    // back buffer bound and makes the scene images available to the UI.
+    auto UIPass = m_RenderGraph.AddPass("UI", [this](IDeviceContext* pContext, const RenderGraph&) {
+        pContext->SetRenderTargets(1, &m_pFrameRTV, m_pFrameDSV, GetBindTransitionMode());
+    });
+    UIPass.Write(m_RGBackBuffer, RESOURCE_STATE_RENDER_TARGET)
+        .Write(m_RGDepthBuffer, RESOURCE_STATE_DEPTH_WRITE);
+    for (auto Color : SceneColors)
+        UIPass.Read(Color, RESOURCE_STATE_SHADER_RESOURCE);
+
+    m_RenderGraph.Compile(m_pDevice);
+    m_RenderGraphDirty = false;
+}
+
+// Render a frame
+void Tutorial05_TextureArray::Render()
+{
+    // The UI and other code bind state between frames
+    m_StateCacheStats = m_StateCache.GetStats();
+    m_StateCache.ResetStats();
+    m_StateCache.Invalidate();
+    for (auto& StateCache : m_DeferredStateCaches)
+    {
+        m_StateCacheStats.NumIssued += StateCache.GetStats().NumIssued;
+        m_StateCacheStats.NumFiltered += StateCache.GetStats().NumFiltered;
+        StateCache.ResetStats();
+    }
+    m_NumConstantBlocks = m_ConstantsRing.GetNumBlocks();
+    m_ConstantBytes     = m_ConstantsRing.GetUsedSize();
+    for (const auto& Ring : m_DeferredConstantsRings)
+    {
+        m_NumConstantBlocks += Ring.GetNumBlocks();
+        m_ConstantBytes += Ring.GetUsedSize();
+    }
+
+    PopulateInstanceBuffer();
+    for (auto& pScene : m_Scenes)
+        pScene->UpdateInstances(*m_Uploads);
+    m_Uploads->Flush(m_pImmediateContext);
+
+    // All constant blocks of the immediate context are written through a single mapping
+    // that is closed before the first draw of the frame
+    m_ConstantsRing.Begin(m_pImmediateContext);
+    m_MainConstantsOffset = WriteVSConstants(m_ConstantsRing, m_ViewProjMatrix);
+    if (!m_Scenes.empty() && !RenderScenesInParallel())
+    {
+        m_RoundRobinScene           = m_NextScene++ % m_Scenes.size();
+        m_RoundRobinConstantsOffset = m_Scenes[m_RoundRobinScene]->WriteConstants(m_ConstantsRing, static_cast<float>(m_CurrTime));
+    }
+    m_ConstantsRing.End();
+
+    m_pFrameRTV = m_pSwapChain->GetCurrentBackBufferRTV();
+    m_pFrameDSV = m_pSwapChain->GetDepthBufferDSV();
+
+    if (m_Capture)
+    {
+        const auto& CaptureCI = m_Capture->GetCreateInfo();
+        const auto& SCDesc    = m_pSwapChain->GetDesc();
+        // A stream cannot change its resolution
+        if (CaptureCI.Width != SCDesc.Width || CaptureCI.Height != SCDesc.Height)
+        {
+            LOG_WARNING_MESSAGE("Swap chain was resized; stopping frame capture");
+            StopCapture();
+        }
+    }
+
+    if (m_PipelineVariant.MipFeedback)
+        UpdateMipFeedback();
+
+    if (m_RenderGraphDirty)
+        BuildRenderGraph();
+
+    m_RenderGraph.SetImportedTexture(m_RGBackBuffer, m_pFrameRTV->GetTexture());
+    m_RenderGraph.SetImportedTexture(m_RGDepthBuffer, m_pFrameDSV->GetTexture());
+    m_RenderGraph.Execute(m_pImmediateContext);
 }
 
 void Tutorial05_TextureArray::Update(double CurrTime, double ElapsedTime)
 {
     SampleBase::Update(CurrTime, ElapsedTime);
+    UpdateUI();
+
+    m_CurrTime = CurrTime;
+
+    UpdateShaderHotReload();
+
+#if PLATFORM_LINUX
+    // Keep trying to connect until the producer process creates the feed, and connect
+    // again after the producer restarts
+    if (!m_SceneFeedName.empty() && m_CurrTime - m_LastFeedCheckTime > 1.0)
+    {
+        m_LastFeedCheckTime = m_CurrTime;
+        if (m_SceneFeed && m_SceneFeed->IsStale())
+        {
+            LOG_INFO_MESSAGE("Scene feed '", m_SceneFeedName, "' was closed by the producer");
+            m_SceneFeed.reset();
+            m_FeedInstanceBuffer.Release();
+            m_RenderGraphDirty = true;
+        }
+        ConnectSceneFeed();
+    }
+#endif
+
+    UpdateScenes();
+    ShowScenesUI();
 
     static float  yaw      = 0.0f;
     static float  pitch    = 0.0f;
@@ -380,25 +2366,7 @@ void Tutorial05_TextureArray::Update(double CurrTime, double ElapsedTime)
     if (ImGui::IsKeyDown(ImGuiKey_LeftArrow))
         target -= right * panSpeed;
 
-    cameraPos = target + offset;
-
-    float4x4 View;
-    View._11 = right.x;
-    View._12 = camUp.x;
-    View._13 = forward.x;
-    View._14 = 0.0f;
-    View._21 = right.y;
-    View._22 = camUp.y;
-    View._23 = forward.y;
-    View._24 = 0.0f;
-    View._31 = right.z;
-    View._32 = camUp.z;
-    View._33 = forward.z;
-    View._34 = 0.0f;
-    View._41 = -dot(right, cameraPos);
-    View._42 = -dot(camUp, cameraPos);
-    View._43 = -dot(forward, cameraPos);
-    View._44 = 1.0f;
+    float4x4 View = ComputeOrbitViewMatrix(yaw, pitch, distance, target);
 
     auto SrfPreTransform = GetSurfacePretransformMatrix(float3{0, 0, 1});
     auto Proj            = GetAdjustedProjectionMatrix(PI_F / 4.0f, 0.1f, 100.f);
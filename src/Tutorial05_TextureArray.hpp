@@ -27,8 +27,31 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "SampleBase.hpp"
 #include "BasicMath.hpp"
+#include "InstanceManager.hpp"
+#include "InstanceCommandQueue.hpp"
+#include "OffscreenScene.hpp"
+#include "FrameCapture.hpp"
+#include "RenderGraph.hpp"
+#include "StaticDrawList.hpp"
+#include "ContextStateCache.hpp"
+#include "DynamicUniformRing.hpp"
+#include "UploadManager.hpp"
+#include "AssetArchive.hpp"
+#include "AsyncFileReader.hpp"
+#include "MipFeedback.hpp"
+#include "ThreadPool.hpp"
+
+#if PLATFORM_LINUX
+#    include "SharedSceneFeed.hpp"
+#endif
 
 namespace Diligent
 {
@@ -36,6 +59,12 @@ namespace Diligent
 class Tutorial05_TextureArray final : public SampleBase
 {
 public:
+    ~Tutorial05_TextureArray();
+
+    virtual void ModifyEngineInitInfo(const ModifyEngineInitInfoAttribs& Attribs) override final;
+
+    virtual CommandLineStatus ProcessCommandLine(int argc, const char* const* argv) override final;
+
     virtual void Initialize(const SampleInitInfo& InitInfo) override final;
 
     virtual void Render() override final;
@@ -45,10 +74,78 @@ public:
 
 private:
     void CreatePipelineState();
+    // Shading cost visualizations, selected in the UI
+    enum class DEBUG_VIEW : int
+    {
+        None,
+        Overdraw,
+        QuadUtilization,
+        MipLevel
+    };
+    // Shader permutation of the cube pipeline selected at run time
+    struct CubePipelineVariant
+    {
+        DEBUG_VIEW DebugView   = DEBUG_VIEW::None;
+        bool       MipFeedback = false;
+
+        bool operator!=(const CubePipelineVariant& Other) const { return DebugView != Other.DebugView || MipFeedback != Other.MipFeedback; }
+    };
+    RefCntAutoPtr<IPipelineState> CreateCubePSO(IShaderSourceInputStreamFactory* pShaderSourceFactory, bool UseCompiledShaders, const CubePipelineVariant& Variant);
+    RefCntAutoPtr<IShaderResourceBinding> CreateCubeSRB(IPipelineState* pPSO);
+    void StartShaderReload();
+    void UpdateShaderHotReload();
     void CreateInstanceBuffer();
-    void LoadTextures();
+    // Startup workers must not record commands, so levels that do not fit into the staging arena
+    // are deferred to UploadDeferredTextureLevels() instead of flushing the uploads
+    void LoadTextures(bool OnWorkerThread);
+    void FlushAndUploadTextureLevel(ITexture* pTexArray, Uint32 Mip, Uint32 Slice, const Box& DstBox, const TextureSubResData& SubresData);
+    void UploadDeferredTextureLevels();
+    void BindTextures(IShaderResourceBinding* pSRB) const;
+    void UpdateMipFeedback();
+    void DropTopMips(Uint32 NumMips);
+    void RestoreTopMips();
+    void RebindTextureArray();
     void UpdateUI();
     void PopulateInstanceBuffer();
+    void StartSimulation();
+    void StopSimulation();
+    void SimulationThreadFunc();
+    void ConnectSceneFeed();
+    void DrawSceneFeed(RESOURCE_STATE_TRANSITION_MODE TransitionMode);
+    void CreateScenes();
+    void UpdateScenes();
+    void RenderScenes(const RenderGraph& Graph);
+    void ShowScenesUI();
+    void ClearRenderTargets(ITextureView* pRTV, ITextureView* pDSV, RESOURCE_STATE_TRANSITION_MODE TransitionMode);
+    Uint32 WriteVSConstants(DynamicUniformRing& Ring, const float4x4& ViewProj);
+    void   DrawCubes(Uint32 ConstantsOffset, RESOURCE_STATE_TRANSITION_MODE TransitionMode);
+    void   DrawCubesStatic(Uint32 ConstantsOffset);
+    void BuildRenderGraph();
+    bool RunDrawBenchmark();
+    void RunDecodeBenchmark();
+    void StopWorkers();
+    // Ends a command line mode that runs to completion inside Initialize()
+    [[noreturn]] void ExitCommandLineMode(bool Succeeded);
+
+    // Resources are transitioned by the render graph, so draws only verify the states in validation mode
+    RESOURCE_STATE_TRANSITION_MODE GetBindTransitionMode() const
+    {
+        return m_ValidationMode ? RESOURCE_STATE_TRANSITION_MODE_VERIFY : RESOURCE_STATE_TRANSITION_MODE_NONE;
+    }
+    // min16float is a precision hint that drivers without 16-bit arithmetic ignore. GL compiles
+    // HLSL through a converter, so it always uses full precision.
+    bool UseSplatHalfPrecision() const
+    {
+        const auto DeviceType = m_pDevice->GetDeviceInfo().Type;
+        return m_UseHalfPrecision && DeviceType != RENDER_DEVICE_TYPE_GL && DeviceType != RENDER_DEVICE_TYPE_GLES;
+    }
+    bool RenderScenesInParallel() const
+    {
+        return m_SceneRenderMode == SCENE_RENDER_MODE::Parallel && !m_pDeferredContexts.empty();
+    }
+    bool RunBatchRender();
+    void StartCapture();
+    void StopCapture();
 
     RefCntAutoPtr<IPipelineState>         m_pPSO;
     RefCntAutoPtr<IBuffer>                m_CubeVertexBuffer;
@@ -56,14 +153,189 @@ private:
     RefCntAutoPtr<IBuffer>                m_InstanceBuffer;
     RefCntAutoPtr<IBuffer>                m_VSConstants;
     RefCntAutoPtr<ITextureView>           m_TextureSRV;
+    RefCntAutoPtr<IBuffer>                m_TextureSliceRemap; // Array slice of every texture index
     RefCntAutoPtr<IShaderResourceBinding> m_SRB;
+    IShaderResourceVariable*              m_ConstantsVar = nullptr;
+
+    // Per-frame constant blocks are suballocated from one dynamic buffer. Every context maps
+    // the buffer through its own ring, and parallel workers bind it through their own SRBs.
+    static constexpr Uint32                            ConstantsRingSize = 64 << 10;
+    DynamicUniformRing                                 m_ConstantsRing;
+    std::vector<DynamicUniformRing>                    m_DeferredConstantsRings;
+    std::vector<RefCntAutoPtr<IShaderResourceBinding>> m_WorkerSRBs;
+    Uint32                                             m_MainConstantsOffset = 0;
+    Uint32                                             m_NumConstantBlocks   = 0;
+    Uint32                                             m_ConstantBytes       = 0;
+
+    InstanceManager             m_Instances{MaxInstances};
+    std::vector<InstanceHandle> m_SceneInstances;
+
+    // Instances spawned by the background simulation thread through a command queue
+    InstanceCommandHub m_InstanceCommands;
+    InstanceProducer*  m_pSimProducer = nullptr;
+    std::thread        m_SimThread;
+    std::atomic<bool>  m_SimRunning{false};
+    std::atomic<bool>  m_SimFinished{false};
+    bool               m_SimEnabled = false;
+
+#if PLATFORM_LINUX
+    // Instances published by an external process through shared memory
+    std::string                      m_SceneFeedName;
+    std::unique_ptr<SharedSceneFeed> m_SceneFeed;
+    RefCntAutoPtr<IBuffer>           m_FeedInstanceBuffer;
+    double                           m_LastFeedCheckTime = -1;
+#endif
+
+    // Independent scenes rendered into offscreen targets with the shared PSO, SRB and geometry
+    enum class SCENE_RENDER_MODE : int
+    {
+        RoundRobin,
+        Parallel
+    };
+    std::vector<std::unique_ptr<OffscreenScene>> m_Scenes;
+    int                                          m_NumScenes                 = 0;
+    SCENE_RENDER_MODE                            m_SceneRenderMode           = SCENE_RENDER_MODE::Parallel;
+    Uint32                                       m_NextScene                 = 0;
+    size_t                                       m_RoundRobinScene           = 0;
+    Uint32                                       m_RoundRobinConstantsOffset = ~0u;
+    std::vector<Uint32>                          m_SceneConstantsOffsets;
+
+    // Offline rendering of camera poses listed in a file (--batch_views)
+    std::string m_BatchViewsPath;
+    std::string m_BatchOutputDir = ".";
+    Uint32      m_BatchWidth     = 512;
+    Uint32      m_BatchHeight    = 512;
+
+    // Recording of the rendered frames (--capture)
+    std::string                   m_CapturePath;
+    FrameCapture::FILE_FORMAT     m_CaptureFormat = FrameCapture::FILE_FORMAT::Y4M;
+    std::unique_ptr<FrameCapture> m_Capture;
+
+    // Frame passes. The graph is rebuilt when the set of passes or resources changes.
+    RenderGraph               m_RenderGraph;
+    bool                      m_RenderGraphDirty = true;
+    RGResourceId              m_RGBackBuffer     = InvalidRGResource;
+    RGResourceId              m_RGDepthBuffer    = InvalidRGResource;
+    std::vector<RGResourceId> m_RGSceneDepthBuffers;
+    ITextureView*             m_pFrameRTV = nullptr;
+    ITextureView*             m_pFrameDSV = nullptr;
+
+    // Validation mode verifies resource states and draw arguments; production mode skips all
+    // checks. Development builds of the engine start in validation mode.
+#if defined(DILIGENT_DEVELOPMENT) || defined(DILIGENT_DEBUG)
+    bool m_ValidationMode = true;
+#else
+    bool m_ValidationMode = false;
+#endif
+    // Redundant binding filters for the immediate and deferred contexts. Statistics of the
+    // previous frame are shown in the UI.
+    ContextStateCache              m_StateCache;
+    std::vector<ContextStateCache> m_DeferredStateCaches;
+    ContextStateCache::Stats       m_StateCacheStats;
+
+    // Main cube draws baked once and replayed every frame (--static_draws)
+    StaticDrawList m_StaticDraws;
+    bool           m_UseStaticDraws           = false;
+    Uint32         m_StaticDrawsInstanceCount = 0;
+
+    // Number of draws submitted per frame by the submission benchmark (--draw_benchmark)
+    Uint32 m_DrawBenchmarkDraws = 0;
+
+    // All buffer and texture uploads go through the upload manager. Background uploads
+    // are limited to the frame budget (--upload_budget, in KB).
+    static constexpr Uint64        UploadStagingSize = 16 << 20;
+    std::unique_ptr<UploadManager> m_Uploads;
+    Uint64                         m_UploadBudget = 4 << 20;
+
+    // Packed assets (--archive, created with AssetPacker). Loose files are used if not set.
+    std::string                   m_ArchivePath;
+    std::unique_ptr<AssetArchive> m_Archive;
+
+    // Loose asset files are read in one batch during initialization: the shaders first, then the texture slices
+    std::unique_ptr<AsyncFileReader> m_FileReader;
+    Uint32                           m_FirstTextureRequest = 0;
+
+    // PNG slices are decoded by the fast decoder unless disabled (--fast_png 0). Other files
+    // always go through the texture loader.
+    bool m_UseFastPngDecoder = true;
+
+    // Iterations per image of the PNG decode benchmark (--decode_benchmark)
+    Uint32 m_DecodeBenchmarkIterations = 0;
+
+    // Splat blending of the pixel shader runs at 16-bit precision where supported (--half_precision 0|1)
+    bool m_UseHalfPrecision = true;
+
+    // Shader hot reload (--hot_reload). When a shader file changes or another pipeline variant is
+    // selected, the pipeline and its SRBs are rebuilt on the thread pool and swapped in between
+    // frames. If compilation fails, the previous pipeline is kept.
+    struct ShaderReloadResult
+    {
+        CubePipelineVariant                                Variant;
+        RefCntAutoPtr<IPipelineState>                      pPSO;
+        RefCntAutoPtr<IShaderResourceBinding>              pSRB;
+        std::vector<RefCntAutoPtr<IShaderResourceBinding>> WorkerSRBs;
+    };
+    bool                      m_HotReload = false;
+    std::vector<Int64>        m_ShaderFileTimes;
+    double                    m_LastShaderCheckTime   = 0;
+    double                    m_ShaderReloadStartTime = 0;
+    RefCntAutoPtr<IAsyncTask> m_ShaderReloadTask;
+    ShaderReloadResult        m_ShaderReload; // Written by the reload task
+    bool                      m_ShaderReloadPending = false;
+    bool                      m_ShaderReloadFailed  = false;
+    CubePipelineVariant       m_Variant;
+    CubePipelineVariant       m_PipelineVariant; // Variant compiled into m_pPSO
+
+    // Feedback of the finest mip level sampled from every array slice, collected in windows of
+    // the given length (--mip_feedback <seconds>, 0 disables). At the end of every window, top mips
+    // that no slice sampled are dropped from the texture array. They are reloaded once the top of
+    // the array has been magnified for MipRestoreWindows windows. Requires pixel shader UAV writes.
+    std::unique_ptr<MipFeedback> m_MipFeedback;
+    float                        m_MipFeedbackWindow      = 10;
+    double                       m_MipFeedbackWindowStart = 0;
+    bool                         m_MipFeedbackWindowDue   = false;
+    std::vector<Uint32>          m_FinestSampledMips;
+    Uint32                       m_NumDroppedMips      = 0;
+    Uint64                       m_DroppedMipBytes     = 0;
+    Uint32                       m_MagnifiedMipWindows = 0;
+    static constexpr Uint32      MipRestoreWindows     = 3;
+
+    // Startup steps run in parallel on a task graph unless disabled (--parallel_init 0).
+    // GL contexts are only current on the main thread, so GL always starts up serially.
+    bool m_ParallelInit = true;
+
+    // Texture levels that did not fit into the staging arena during the parallel startup,
+    // tightly packed
+    struct DeferredTextureLevel
+    {
+        RefCntAutoPtr<ITexture> pTexture;
+        Uint32                  Mip   = 0;
+        Uint32                  Slice = 0;
+        Box                     DstBox;
+        Uint64                  Stride = 0;
+        std::vector<Uint8>      Data;
+    };
+    std::vector<DeferredTextureLevel> m_DeferredTextureLevels;
+
+    // Number of texture slices decoded at a time (--texture_window, 0 decodes all slices at once)
+    Uint32 m_TextureLoadWindow = 1;
+
+    // Texture uploads are recorded on a transfer queue if the adapter has one (--transfer_queue 0|1).
+    // The create info must outlive ModifyEngineInitInfo().
+    bool                       m_UseTransferQueue = true;
+    ImmediateContextCreateInfo m_ImmediateContextCI[2];
+
+    RefCntAutoPtr<IThreadPool> m_pThreadPool;
 
     float4x4             m_ViewProjMatrix;
-    float4x4             m_RotationMatrix;
-    int                  m_GridSize   = 5;
-    static constexpr int MaxGridSize  = 32;
-    static constexpr int MaxInstances = MaxGridSize * MaxGridSize * MaxGridSize;
-    static constexpr int NumTextures  = 4;
+    float4x4             m_RotationMatrix = float4x4::Identity();
+    double               m_CurrTime          = 0;
+    bool                 m_AnimateTextures   = false;
+    bool                 m_FlipbookCrossFade = true;
+    float                m_FlipbookRate      = 1.f;
+    static constexpr int MaxInstances        = 32768; // Capacity of the instance buffer
+    static constexpr int NumTextures         = 4;
+    static constexpr int NumSimObjects       = 1024;
 };
 
 } // namespace Diligent
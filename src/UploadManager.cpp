@@ -0,0 +1,308 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "UploadManager.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "GraphicsAccessories.hpp"
+
+namespace Diligent
+{
+
+UploadManager::UploadManager(IRenderDevice* pDevice, Uint64 StagingSize, Uint64 FrameBudget, IDeviceContext* pTransferContext) :
+    m_Staging(static_cast<size_t>(StagingSize)),
+    m_StagingRing{StagingSize},
+    m_FrameBudget{FrameBudget},
+    m_pTransferContext{pTransferContext}
+{
+    FenceDesc FenceCI;
+    FenceCI.Name = "Upload fence";
+    FenceCI.Type = FENCE_TYPE_CPU_WAIT_ONLY;
+    pDevice->CreateFence(FenceCI, &m_pFence);
+
+    if (m_pTransferContext)
+    {
+        // The graphics queue waits for this fence on the GPU
+        FenceCI.Name = "Transfer queue fence";
+        FenceCI.Type = FENCE_TYPE_GENERAL;
+        pDevice->CreateFence(FenceCI, &m_pTransferFence);
+    }
+}
+
+bool StagingRing::Allocate(Uint64 Size, Uint64& Offset)
+{
+    // The head never catches up with the tail, so that
+    // a full ring can be told apart from an empty one
+    if (m_Head >= m_Tail)
+    {
+        if (m_Head + Size <= m_Capacity)
+        {
+            Offset = m_Head;
+            m_Head += Size;
+            return true;
+        }
+        if (Size < m_Tail)
+        {
+            Offset = 0;
+            m_Head = Size;
+            return true;
+        }
+        return false;
+    }
+
+    if (m_Head + Size < m_Tail)
+    {
+        Offset = m_Head;
+        m_Head += Size;
+        return true;
+    }
+    return false;
+}
+
+bool UploadManager::EnqueueBufferUpdate(IBuffer* pBuffer, Uint64 Offset, Uint64 Size, const void* pData, PRIORITY Priority)
+{
+    if (Size == 0)
+        return true;
+
+    Uint64 StagingOffset = 0;
+    if (m_Queue.empty())
+        m_StagingRing.Reset();
+    if (!m_StagingRing.Allocate(Size, StagingOffset))
+    {
+        if (Size >= m_Staging.size())
+            LOG_ERROR_MESSAGE("Buffer update of ", Size, " bytes does not fit into the ", m_Staging.size(), "-byte staging arena");
+        return false;
+    }
+    memcpy(&m_Staging[static_cast<size_t>(StagingOffset)], pData, static_cast<size_t>(Size));
+    m_QueuedBytes += Size;
+
+    // Updates of adjacent ranges of the same buffer become one copy
+    if (!m_Queue.empty())
+    {
+        auto& Last = m_Queue.back();
+        if (Last.pBuffer == pBuffer && !Last.Submitted && Last.Priority == Priority &&
+            Last.DstOffset + Last.Size == Offset && Last.StagingOffset + Last.Size == StagingOffset)
+        {
+            Last.Size += Size;
+            ++Last.NumUpdates;
+            return true;
+        }
+    }
+
+    PendingUpload Upload;
+    Upload.pBuffer       = pBuffer;
+    Upload.DstOffset     = Offset;
+    Upload.Priority      = Priority;
+    Upload.StagingOffset = StagingOffset;
+    Upload.Size          = Size;
+    m_Queue.emplace_back(std::move(Upload));
+    return true;
+}
+
+bool UploadManager::EnqueueTextureUpdate(ITexture*                pTexture,
+                                         Uint32                   MipLevel,
+                                         Uint32                   Slice,
+                                         const Box&               DstBox,
+                                         const TextureSubResData& SubresData,
+                                         PRIORITY                 Priority)
+{
+    VERIFY(SubresData.pData != nullptr, "Only CPU data can be uploaded");
+
+    const auto&  FmtAttribs = GetTextureFormatAttribs(pTexture->GetDesc().Format);
+    const Uint32 Width      = DstBox.MaxX - DstBox.MinX;
+    const Uint32 Height     = DstBox.MaxY - DstBox.MinY;
+    const Uint32 Depth      = DstBox.MaxZ - DstBox.MinZ;
+
+    Uint64 RowSize = 0;
+    Uint32 NumRows = 0;
+    if (FmtAttribs.ComponentType == COMPONENT_TYPE_COMPRESSED)
+    {
+        RowSize = Uint64{(Width + FmtAttribs.BlockWidth - 1) / FmtAttribs.BlockWidth} * FmtAttribs.ComponentSize;
+        NumRows = (Height + FmtAttribs.BlockHeight - 1) / FmtAttribs.BlockHeight;
+    }
+    else
+    {
+        RowSize = Uint64{Width} * FmtAttribs.GetElementSize();
+        NumRows = Height;
+    }
+    if (RowSize == 0 || NumRows == 0 || Depth == 0)
+        return true;
+
+    // Source strides are preserved; only the last row of the last slice may be shorter
+    const Uint64 Size = SubresData.DepthStride * (Depth - 1) + SubresData.Stride * (NumRows - 1) + RowSize;
+
+    Uint64 StagingOffset = 0;
+    if (m_Queue.empty())
+        m_StagingRing.Reset();
+    if (!m_StagingRing.Allocate(Size, StagingOffset))
+    {
+        if (Size >= m_Staging.size())
+            LOG_ERROR_MESSAGE("Texture update of ", Size, " bytes does not fit into the ", m_Staging.size(), "-byte staging arena");
+        return false;
+    }
+    memcpy(&m_Staging[static_cast<size_t>(StagingOffset)], SubresData.pData, static_cast<size_t>(Size));
+    m_QueuedBytes += Size;
+
+    PendingUpload Upload;
+    Upload.pTexture      = pTexture;
+    Upload.MipLevel      = MipLevel;
+    Upload.Slice         = Slice;
+    Upload.DstBox        = DstBox;
+    Upload.Stride        = SubresData.Stride;
+    Upload.DepthStride   = SubresData.DepthStride;
+    Upload.Priority      = Priority;
+    Upload.StagingOffset = StagingOffset;
+    Upload.Size          = Size;
+    m_Queue.emplace_back(std::move(Upload));
+    return true;
+}
+
+void UploadManager::Submit(IDeviceContext* pContext, const PendingUpload& Upload)
+{
+    // The context copies the source data when the command is recorded,
+    // so the staging memory can be reused right after this call
+    const void* pData = &m_Staging[static_cast<size_t>(Upload.StagingOffset)];
+    if (Upload.pBuffer)
+    {
+        pContext->UpdateBuffer(Upload.pBuffer, Upload.DstOffset, Upload.Size, pData, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    }
+    else
+    {
+        IDeviceContext* pCopyContext = pContext;
+        if (m_pTransferContext)
+        {
+            pCopyContext = m_pTransferContext;
+            if (std::find(m_TransferTextures.begin(), m_TransferTextures.end(), Upload.pTexture) == m_TransferTextures.end())
+                m_TransferTextures.emplace_back(Upload.pTexture);
+            ++m_NumTransferCopies;
+        }
+
+        TextureSubResData SubresData{pData, Upload.Stride, Upload.DepthStride};
+        pCopyContext->UpdateTexture(Upload.pTexture, Upload.MipLevel, Upload.Slice, Upload.DstBox, SubresData,
+                                    RESOURCE_STATE_TRANSITION_MODE_NONE, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    }
+    ++m_NumCopies;
+    m_NumUpdates += Upload.NumUpdates;
+}
+
+Uint64 UploadManager::Flush(IDeviceContext* pContext, bool IgnoreBudget)
+{
+    const Uint64 CompletedValue = m_pFence->GetCompletedValue();
+    while (!m_InFlight.empty() && m_InFlight.front().FenceValue <= CompletedValue)
+    {
+        m_CompletedBytes += m_InFlight.front().Size;
+        m_InFlightBytes -= m_InFlight.front().Size;
+        m_InFlight.pop_front();
+    }
+
+    m_NumCopies         = 0;
+    m_NumUpdates        = 0;
+    m_NumTransferCopies = 0;
+
+    Uint64 FrameBytes = 0;
+    for (auto& Upload : m_Queue)
+    {
+        if (Upload.Priority == PRIORITY::Frame)
+        {
+            Submit(pContext, Upload);
+            Upload.Submitted = true;
+            FrameBytes += Upload.Size;
+        }
+    }
+
+    // Background uploads go in order. An upload larger than the budget is submitted on its
+    // own, so that it cannot block the queue.
+    Uint64 BackgroundBytes = 0;
+    for (auto& Upload : m_Queue)
+    {
+        if (Upload.Submitted)
+            continue;
+        if (!IgnoreBudget && BackgroundBytes > 0 && BackgroundBytes + Upload.Size > m_FrameBudget)
+            break;
+        Submit(pContext, Upload);
+        Upload.Submitted = true;
+        BackgroundBytes += Upload.Size;
+    }
+
+    if (!m_TransferTextures.empty())
+        SubmitTransferUploads(pContext);
+
+    // Release the staging memory of the submitted uploads at the front of the queue
+    while (!m_Queue.empty() && m_Queue.front().Submitted)
+    {
+        m_StagingRing.Release(m_Queue.front().StagingOffset + m_Queue.front().Size);
+        m_Queue.pop_front();
+    }
+
+    const Uint64 SubmittedBytes = FrameBytes + BackgroundBytes;
+    if (SubmittedBytes > 0)
+    {
+        m_QueuedBytes -= SubmittedBytes;
+        m_InFlightBytes += SubmittedBytes;
+        m_InFlight.push_back({m_NextFenceValue, SubmittedBytes});
+        pContext->EnqueueSignal(m_pFence, m_NextFenceValue++);
+    }
+    return SubmittedBytes;
+}
+
+void UploadManager::SubmitTransferUploads(IDeviceContext* pContext)
+{
+    // Copy queues only support a few states. The textures are handed over to the graphics
+    // queue in the common state; the graphics queue transitions them before the first use.
+    std::vector<StateTransitionDesc> Barriers;
+    Barriers.reserve(m_TransferTextures.size());
+    for (auto& pTexture : m_TransferTextures)
+        Barriers.emplace_back(pTexture, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_COMMON, STATE_TRANSITION_FLAG_UPDATE_STATE);
+    m_pTransferContext->TransitionResourceStates(static_cast<Uint32>(Barriers.size()), Barriers.data());
+    m_TransferTextures.clear();
+
+    const Uint64 FenceValue = m_NextTransferFenceValue++;
+    m_pTransferContext->EnqueueSignal(m_pTransferFence, FenceValue);
+    m_pTransferContext->Flush();
+    // The transfer context is not presented, so it has to release its upload memory itself
+    m_pTransferContext->FinishFrame();
+
+    // GPU-side wait: the CPU continues recording while the copy engine works, and only the
+    // graphics commands recorded after this point wait for the copies
+    pContext->DeviceWaitForFence(m_pTransferFence, FenceValue);
+}
+
+UploadManager::Stats UploadManager::GetStats() const
+{
+    Stats S;
+    S.QueuedBytes       = m_QueuedBytes;
+    S.InFlightBytes     = m_InFlightBytes;
+    S.CompletedBytes    = m_CompletedBytes;
+    S.NumCopies         = m_NumCopies;
+    S.NumUpdates        = m_NumUpdates;
+    S.NumTransferCopies = m_NumTransferCopies;
+    return S;
+}
+
+} // namespace Diligent
@@ -0,0 +1,188 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "Fence.h"
+#include "RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+// Allocates contiguous blocks from a ring of the given capacity. Blocks are released in the
+// order they were allocated by moving the tail to the end of the oldest live block. A block never
+// wraps around the end of the ring; the space it skips is reclaimed when the tail passes it.
+class StagingRing
+{
+public:
+    explicit StagingRing(Uint64 Capacity) :
+        m_Capacity{Capacity}
+    {}
+
+    // Returns false if there is no contiguous free block of the requested size
+    bool Allocate(Uint64 Size, Uint64& Offset);
+
+    // Frees everything allocated before the block that ends at End
+    void Release(Uint64 End) { m_Tail = End; }
+
+    // Frees all blocks; must be called when no block is live
+    void Reset()
+    {
+        m_Head = 0;
+        m_Tail = 0;
+    }
+
+    Uint64 GetCapacity() const { return m_Capacity; }
+
+private:
+    const Uint64 m_Capacity;
+
+    Uint64 m_Head = 0;
+    Uint64 m_Tail = 0;
+};
+
+// Single path for all buffer and texture uploads. Source data is copied into a staging arena
+// when an upload is enqueued, and Flush() records the queued copies once per frame. Adjacent
+// updates of the same buffer are merged into a single copy. Background uploads are limited by
+// a per-frame byte budget, so that large loads are spread over several frames instead of
+// producing a spike. Completion of the copies is tracked with a fence.
+//
+// If a transfer context is given, texture uploads are recorded on the transfer queue and the
+// graphics queue waits for them on the GPU, so large copies run on the copy engine next to the
+// graphics work of the previous frames. Textures must include the transfer context in their
+// ImmediateContextMask. Without a transfer context, everything goes to the graphics context.
+class UploadManager
+{
+public:
+    enum class PRIORITY : int
+    {
+        // Data used by the current frame; always submitted by the next Flush()
+        Frame,
+        // Streaming data; submitted in order as the frame budget allows
+        Background
+    };
+
+    struct Stats
+    {
+        // Bytes waiting in the staging arena
+        Uint64 QueuedBytes = 0;
+        // Bytes whose copies were recorded but are not yet complete on the GPU
+        Uint64 InFlightBytes = 0;
+        // Total bytes whose copies have completed
+        Uint64 CompletedBytes = 0;
+        // Copies recorded by the last Flush(), the number of updates they covered,
+        // and the number of copies recorded on the transfer context
+        Uint32 NumCopies         = 0;
+        Uint32 NumUpdates        = 0;
+        Uint32 NumTransferCopies = 0;
+    };
+
+    UploadManager(IRenderDevice* pDevice, Uint64 StagingSize, Uint64 FrameBudget, IDeviceContext* pTransferContext = nullptr);
+
+    // Copy the data into the staging arena. Return false if the arena is full; the upload
+    // may be enqueued again after the next Flush(). Updates of the same region must use the
+    // same priority, as frame uploads may be submitted ahead of background ones.
+    bool EnqueueBufferUpdate(IBuffer* pBuffer, Uint64 Offset, Uint64 Size, const void* pData, PRIORITY Priority = PRIORITY::Frame);
+    bool EnqueueTextureUpdate(ITexture*                pTexture,
+                              Uint32                   MipLevel,
+                              Uint32                   Slice,
+                              const Box&               DstBox,
+                              const TextureSubResData& SubresData,
+                              PRIORITY                 Priority = PRIORITY::Background);
+
+    // Records the copies of all frame uploads and of as many background uploads as the budget
+    // allows. IgnoreBudget submits everything, e.g. during initialization.
+    // Returns the number of bytes submitted.
+    Uint64 Flush(IDeviceContext* pContext, bool IgnoreBudget = false);
+
+    void   SetFrameBudget(Uint64 FrameBudget) { m_FrameBudget = FrameBudget; }
+    Uint64 GetFrameBudget() const { return m_FrameBudget; }
+
+    bool HasPendingUploads() const { return !m_Queue.empty(); }
+
+    IDeviceContext* GetTransferContext() const { return m_pTransferContext; }
+
+    // Completion is checked by Flush(), so the statistics are as of the last frame
+    Stats GetStats() const;
+
+private:
+    struct PendingUpload
+    {
+        RefCntAutoPtr<IBuffer>  pBuffer;
+        RefCntAutoPtr<ITexture> pTexture;
+
+        Uint64   DstOffset   = 0; // Buffer uploads
+        Uint32   MipLevel    = 0; // Texture uploads
+        Uint32   Slice       = 0;
+        Box      DstBox      = {};
+        Uint64   Stride      = 0;
+        Uint64   DepthStride = 0;
+        PRIORITY Priority    = PRIORITY::Frame;
+
+        Uint64 StagingOffset = 0;
+        Uint64 Size          = 0;
+        Uint32 NumUpdates    = 1;
+        bool   Submitted     = false;
+    };
+
+    struct FencedBytes
+    {
+        Uint64 FenceValue = 0;
+        Uint64 Size       = 0;
+    };
+
+    void Submit(IDeviceContext* pContext, const PendingUpload& Upload);
+    void SubmitTransferUploads(IDeviceContext* pContext);
+
+    std::vector<Uint8>        m_Staging;
+    StagingRing               m_StagingRing;
+    std::deque<PendingUpload> m_Queue;
+    Uint64                    m_FrameBudget = 0;
+
+    RefCntAutoPtr<IFence>   m_pFence;
+    Uint64                  m_NextFenceValue = 1;
+    std::deque<FencedBytes> m_InFlight;
+
+    RefCntAutoPtr<IDeviceContext>        m_pTransferContext;
+    RefCntAutoPtr<IFence>                m_pTransferFence;
+    Uint64                               m_NextTransferFenceValue = 1;
+    std::vector<RefCntAutoPtr<ITexture>> m_TransferTextures;
+
+    Uint64 m_QueuedBytes       = 0;
+    Uint64 m_InFlightBytes     = 0;
+    Uint64 m_CompletedBytes    = 0;
+    Uint32 m_NumCopies         = 0;
+    Uint32 m_NumUpdates        = 0;
+    Uint32 m_NumTransferCopies = 0;
+};
+
+} // namespace Diligent
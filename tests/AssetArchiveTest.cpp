@@ -0,0 +1,234 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "AssetArchive.hpp"
+#include "TestFramework.hpp"
+
+using namespace Diligent;
+
+namespace
+{
+
+std::vector<Uint8> MakeRandomData(size_t Size, Uint32 Seed)
+{
+    std::mt19937       Rng{Seed};
+    std::vector<Uint8> Data(Size);
+    for (auto& Byte : Data)
+        Byte = static_cast<Uint8>(Rng());
+    return Data;
+}
+
+// Text-like data with many repeated fragments at different distances
+std::vector<Uint8> MakeCompressibleData(size_t Size, Uint32 Seed)
+{
+    static constexpr const char* Words[] = {"texture ", "array ", "slice ", "mip ", "level ", "instance ", "buffer "};
+
+    std::mt19937       Rng{Seed};
+    std::vector<Uint8> Data;
+    while (Data.size() < Size)
+    {
+        const char* Word = Words[Rng() % _countof(Words)];
+        Data.insert(Data.end(), Word, Word + strlen(Word));
+    }
+    Data.resize(Size);
+    return Data;
+}
+
+bool RoundTrip(const std::vector<Uint8>& Data)
+{
+    const auto         Compressed = AssetArchive::CompressLZ4(Data.data(), Data.size());
+    std::vector<Uint8> Decompressed(Data.size());
+    return AssetArchive::DecompressLZ4(Compressed.data(), Compressed.size(), Decompressed.data(), Decompressed.size()) &&
+        Decompressed == Data;
+}
+
+// Checks the end-of-block rules of the LZ4 block format: the last sequence has no match,
+// the last 5 bytes are literals, and the last match starts at least 12 bytes before the end.
+bool FollowsEndOfBlockRules(const std::vector<Uint8>& Compressed, size_t Size)
+{
+    size_t Pos            = 0;
+    size_t OutPos         = 0;
+    size_t LastMatchStart = 0;
+    bool   HasMatch       = false;
+
+    auto ReadLength = [&](size_t& Length) {
+        Uint8 Byte = 255;
+        while (Byte == 255 && Pos < Compressed.size())
+        {
+            Byte = Compressed[Pos++];
+            Length += Byte;
+        }
+    };
+    while (Pos < Compressed.size())
+    {
+        const Uint8 Token       = Compressed[Pos++];
+        size_t      NumLiterals = Token >> 4;
+        if (NumLiterals == 15)
+            ReadLength(NumLiterals);
+        Pos += NumLiterals;
+        OutPos += NumLiterals;
+        if (Pos >= Compressed.size())
+        {
+            // The last sequence
+            return Pos == Compressed.size() && (Size < 5 || NumLiterals >= 5) &&
+                (!HasMatch || LastMatchStart + 12 <= Size);
+        }
+
+        Pos += 2;
+        size_t MatchLength = Token & 15;
+        if (MatchLength == 15)
+            ReadLength(MatchLength);
+        LastMatchStart = OutPos;
+        HasMatch       = true;
+        OutPos += MatchLength + 4;
+    }
+    return false;
+}
+
+} // namespace
+
+TEST(LZ4, RoundTrip)
+{
+    EXPECT_TRUE(RoundTrip({}));
+    EXPECT_TRUE(RoundTrip({42}));
+    // Too short for any match
+    EXPECT_TRUE(RoundTrip(std::vector<Uint8>(12, 7)));
+    EXPECT_TRUE(RoundTrip(std::vector<Uint8>(13, 7)));
+    for (size_t Size : {100, 4096, 300000})
+    {
+        EXPECT_TRUE(RoundTrip(MakeRandomData(Size, static_cast<Uint32>(Size))));
+        EXPECT_TRUE(RoundTrip(MakeCompressibleData(Size, static_cast<Uint32>(Size))));
+    }
+}
+
+TEST(LZ4, OverlappingMatches)
+{
+    // Runs are encoded as matches that overlap their own output
+    std::vector<Uint8> Data(100000, 0xAB);
+    const auto         Compressed = AssetArchive::CompressLZ4(Data.data(), Data.size());
+    EXPECT_TRUE(Compressed.size() < 1000);
+    EXPECT_TRUE(RoundTrip(Data));
+
+    std::vector<Uint8> Pattern;
+    for (int i = 0; i < 1000; ++i)
+        Pattern.push_back(static_cast<Uint8>("abc"[i % 3]));
+    EXPECT_TRUE(RoundTrip(Pattern));
+}
+
+TEST(LZ4, CompressedDataFollowsBlockFormat)
+{
+    for (size_t Size : {0, 5, 12, 13, 16, 17, 64, 1000, 70000})
+    {
+        const auto Data = MakeCompressibleData(Size, 1);
+        EXPECT_TRUE(FollowsEndOfBlockRules(AssetArchive::CompressLZ4(Data.data(), Data.size()), Size));
+    }
+    // Incompressible data is stored as one literal run with a small overhead
+    const auto Data       = MakeRandomData(4096, 2);
+    const auto Compressed = AssetArchive::CompressLZ4(Data.data(), Data.size());
+    EXPECT_TRUE(Compressed.size() <= Data.size() + Data.size() / 255 + 16);
+}
+
+TEST(LZ4, DecompressReferenceBlock)
+{
+    // Hand-encoded block: "abc", a 21-byte match at offset 3, and the literals "xyzzy"
+    const Uint8 Block[] = {0x3F, 'a', 'b', 'c', 0x03, 0x00, 0x02, 0x50, 'x', 'y', 'z', 'z', 'y'};
+    const char  Expected[] = "abcabcabcabcabcabcabcabcxyzzy";
+
+    std::vector<Uint8> Decompressed(sizeof(Expected) - 1);
+    EXPECT_TRUE(AssetArchive::DecompressLZ4(Block, sizeof(Block), Decompressed.data(), Decompressed.size()));
+    EXPECT_TRUE(memcmp(Decompressed.data(), Expected, Decompressed.size()) == 0);
+}
+
+TEST(LZ4, RejectsCorruptedData)
+{
+    const auto Data       = MakeCompressibleData(5000, 3);
+    const auto Compressed = AssetArchive::CompressLZ4(Data.data(), Data.size());
+
+    std::vector<Uint8> Decompressed(Data.size() + 1);
+    // Wrong size of the output
+    EXPECT_FALSE(AssetArchive::DecompressLZ4(Compressed.data(), Compressed.size(), Decompressed.data(), Data.size() - 1));
+    EXPECT_FALSE(AssetArchive::DecompressLZ4(Compressed.data(), Compressed.size(), Decompressed.data(), Data.size() + 1));
+    // Every truncation either fails or stops short of the full output
+    for (size_t Size = 0; Size < Compressed.size(); ++Size)
+        EXPECT_FALSE(AssetArchive::DecompressLZ4(Compressed.data(), Size, Decompressed.data(), Data.size()));
+
+    // A match before the start of the output
+    const Uint8 BadOffset[] = {0x10, 'a', 0x02, 0x00, 0x50, 'x', 'y', 'z', 'z', 'y'};
+    EXPECT_FALSE(AssetArchive::DecompressLZ4(BadOffset, sizeof(BadOffset), Decompressed.data(), 10));
+    const Uint8 ZeroOffset[] = {0x10, 'a', 0x00, 0x00, 0x50, 'x', 'y', 'z', 'z', 'y'};
+    EXPECT_FALSE(AssetArchive::DecompressLZ4(ZeroOffset, sizeof(ZeroOffset), Decompressed.data(), 10));
+
+    // Random corruption must never write past the output; the result may or may not be valid
+    std::mt19937 Rng{4};
+    for (int i = 0; i < 1000; ++i)
+    {
+        auto Corrupted = Compressed;
+        Corrupted[Rng() % Corrupted.size()] ^= static_cast<Uint8>(1 + Rng() % 255);
+        AssetArchive::DecompressLZ4(Corrupted.data(), Corrupted.size(), Decompressed.data(), Data.size());
+    }
+}
+
+TEST(AssetArchive, WriteAndRead)
+{
+    const char* Path = "Tutorial05Tests.t5pk";
+
+    std::vector<AssetArchive::SourceFile> Files(3);
+    Files[0] = {"textures/b.png", MakeRandomData(1000, 5)};
+    Files[1] = {"textures/a.png", MakeCompressibleData(20000, 6)};
+    Files[2] = {"empty", {}};
+    EXPECT_TRUE(AssetArchive::Write(Path, Files, true));
+
+    auto pArchive = AssetArchive::Open(Path);
+    EXPECT_TRUE(pArchive != nullptr);
+    if (pArchive)
+    {
+        EXPECT_EQ(pArchive->GetNumEntries(), 3u);
+        EXPECT_TRUE(pArchive->Find("textures/c.png") == nullptr);
+        EXPECT_TRUE(pArchive->Find("textures") == nullptr);
+        for (const auto& File : Files)
+        {
+            const auto* pEntry = pArchive->Find(File.Name.c_str());
+            EXPECT_TRUE(pEntry != nullptr);
+            if (pEntry == nullptr)
+                continue;
+            std::vector<Uint8> Data;
+            EXPECT_TRUE(pArchive->Read(*pEntry, Data));
+            EXPECT_TRUE(Data == File.Data);
+        }
+
+        // Random data is stored as is, text-like data is compressed
+        EXPECT_EQ(pArchive->Find("textures/b.png")->Compression, AssetArchive::COMPRESSION_NONE);
+        EXPECT_EQ(pArchive->Find("textures/a.png")->Compression, AssetArchive::COMPRESSION_LZ4);
+        pArchive.reset();
+    }
+    std::remove(Path);
+}
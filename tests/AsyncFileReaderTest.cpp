@@ -0,0 +1,115 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "AsyncFileReader.hpp"
+#include "TestFramework.hpp"
+
+using namespace Diligent;
+
+namespace
+{
+
+std::vector<Uint8> WriteRandomFile(const std::string& Path, size_t Size, Uint32 Seed)
+{
+    std::mt19937       Rng{Seed};
+    std::vector<Uint8> Data(Size);
+    for (auto& Byte : Data)
+        Byte = static_cast<Uint8>(Rng());
+
+    FILE* pFile = fopen(Path.c_str(), "wb");
+    if (pFile != nullptr)
+    {
+        if (!Data.empty())
+            fwrite(Data.data(), 1, Data.size(), pFile);
+        fclose(pFile);
+    }
+    return Data;
+}
+
+} // namespace
+
+TEST(AsyncFileReader, WaitAnyReturnsEveryRequestOnce)
+{
+    ThreadPoolCreateInfo ThreadPoolCI;
+    ThreadPoolCI.NumThreads = 2;
+    auto pThreadPool        = CreateThreadPool(ThreadPoolCI);
+
+    // The first request is not part of the range
+    const std::vector<size_t> FileSizes = {100, 300000, 0, 5000, 1};
+
+    std::vector<std::string>        Paths;
+    std::vector<std::vector<Uint8>> Contents;
+    for (Uint32 i = 0; i < FileSizes.size(); ++i)
+    {
+        Paths.push_back("Tutorial05Tests" + std::to_string(i) + ".bin");
+        Contents.push_back(WriteRandomFile(Paths.back(), FileSizes[i], i));
+    }
+    // A file that does not exist fails, but is still returned
+    Paths.push_back("Tutorial05Tests.missing");
+
+    {
+        AsyncFileReader Reader{pThreadPool};
+        for (const auto& Path : Paths)
+            Reader.AddRequest(Path.c_str());
+        Reader.Submit();
+
+        const Uint32 FirstRequest = 1;
+        const Uint32 NumRequests  = Reader.GetNumRequests() - FirstRequest;
+
+        // Waiting for a request does not remove it from the range
+        EXPECT_TRUE(Reader.Wait(3));
+
+        std::vector<Uint32> NumReturned(Reader.GetNumRequests());
+        for (Uint32 i = 0; i < NumRequests; ++i)
+        {
+            const Uint32 Request = Reader.WaitAny(FirstRequest, NumRequests);
+            EXPECT_TRUE(Request >= FirstRequest && Request < FirstRequest + NumRequests);
+            if (Request < FirstRequest || Request >= FirstRequest + NumRequests)
+                break;
+
+            ++NumReturned[Request];
+            const auto& Expected = Request < Contents.size() ? Contents[Request] : std::vector<Uint8>{};
+            EXPECT_TRUE(Reader.GetData(Request) == Expected);
+        }
+        for (Uint32 Request = FirstRequest; Request < Reader.GetNumRequests(); ++Request)
+            EXPECT_EQ(NumReturned[Request], 1u);
+        EXPECT_EQ(NumReturned[0], 0u);
+        EXPECT_EQ(Reader.WaitAny(FirstRequest, NumRequests), AsyncFileReader::InvalidRequest);
+
+        EXPECT_EQ(Reader.WaitAny(0, 1), 0u);
+        EXPECT_TRUE(Reader.GetData(0) == Contents[0]);
+        EXPECT_EQ(Reader.WaitAny(0, 1), AsyncFileReader::InvalidRequest);
+    }
+
+    for (const auto& Path : Paths)
+        std::remove(Path.c_str());
+}
@@ -0,0 +1,188 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "InstanceCommandQueue.hpp"
+#include "TestFramework.hpp"
+
+using namespace Diligent;
+
+namespace
+{
+
+InstanceData MakeInstance(float TextureInd)
+{
+    InstanceData Data;
+    Data.TextureInd = TextureInd;
+    return Data;
+}
+
+} // namespace
+
+TEST(SPSCQueue, FullQueueRejectsItems)
+{
+    SPSCQueue<int, 8> Queue;
+    for (int i = 0; i < 8; ++i)
+        EXPECT_TRUE(Queue.TryPush(i));
+    EXPECT_FALSE(Queue.TryPush(8));
+
+    // A batch is cut at the free space
+    SPSCQueue<int, 8> Queue2;
+    const int         Items[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    EXPECT_EQ(Queue2.TryPush(Items, 10), 8u);
+    EXPECT_EQ(Queue2.TryPush(Items, 10), 0u);
+}
+
+TEST(SPSCQueue, WrapAroundKeepsOrder)
+{
+    SPSCQueue<int, 8> Queue;
+    std::vector<int>  Popped;
+    auto              Pop = [&](int Item) { Popped.push_back(Item); };
+
+    int Next = 0;
+    // Every round starts at a different position in the ring
+    for (int Round = 0; Round < 20; ++Round)
+    {
+        const int NumPushed = 1 + Round % 8;
+        for (int i = 0; i < NumPushed; ++i)
+            EXPECT_TRUE(Queue.TryPush(Next++));
+
+        // Consume in two parts to check partial consumption
+        const Uint32 NumFirst = NumPushed / 2;
+        EXPECT_EQ(Queue.Consume(Pop, NumFirst), NumFirst);
+        EXPECT_EQ(Queue.Consume(Pop), static_cast<Uint32>(NumPushed) - NumFirst);
+        EXPECT_EQ(Queue.Consume(Pop), 0u);
+    }
+
+    EXPECT_EQ(Popped.size(), static_cast<size_t>(Next));
+    for (size_t i = 0; i < Popped.size(); ++i)
+        EXPECT_EQ(Popped[i], static_cast<int>(i));
+}
+
+TEST(SPSCQueue, ConcurrentProducerAndConsumer)
+{
+    constexpr Uint32 NumItems = 1u << 20;
+
+    SPSCQueue<Uint32, 64> Queue;
+    std::thread           Producer{[&]() {
+        Uint32 Batch[5];
+        for (Uint32 Next = 0; Next < NumItems;)
+        {
+            // Batches of different sizes publish at different positions in the ring
+            const Uint32 BatchSize = std::min(1 + Next % 5, NumItems - Next);
+            for (Uint32 i = 0; i < BatchSize; ++i)
+                Batch[i] = Next + i;
+            const Uint32 NumPushed = Queue.TryPush(Batch, BatchSize);
+            Next += NumPushed;
+            if (NumPushed == 0)
+                std::this_thread::yield();
+        }
+    }};
+
+    Uint32 Expected  = 0;
+    bool   IsInOrder = true;
+    while (Expected < NumItems)
+    {
+        const Uint32 NumPopped = Queue.Consume([&](Uint32 Item) {
+            IsInOrder = IsInOrder && Item == Expected;
+            ++Expected;
+        });
+        if (NumPopped == 0)
+            std::this_thread::yield();
+    }
+    Producer.join();
+
+    EXPECT_TRUE(IsInOrder);
+    EXPECT_EQ(Expected, NumItems);
+}
+
+TEST(InstanceCommandHub, CommandsAreAppliedInOrder)
+{
+    InstanceManager    Instances{16};
+    InstanceCommandHub Hub;
+    InstanceProducer*  pProducer = Hub.RegisterProducer(4);
+    EXPECT_TRUE(pProducer != nullptr);
+    if (pProducer == nullptr)
+        return;
+
+    EXPECT_TRUE(pProducer->Create(0, MakeInstance(1)));
+    EXPECT_TRUE(pProducer->Create(1, MakeInstance(2)));
+    EXPECT_TRUE(pProducer->Update(1, MakeInstance(3)));
+    EXPECT_TRUE(pProducer->Destroy(0));
+
+    auto Stats = Hub.Drain(Instances);
+    EXPECT_EQ(Stats.NumApplied, 4u);
+    EXPECT_EQ(Stats.NumDropped, 0u);
+    EXPECT_EQ(Instances.GetCount(), 1u);
+    EXPECT_EQ(Instances.GetData()[0].TextureInd, 3.f);
+
+    // Unknown ids and updates of destroyed objects are dropped
+    EXPECT_TRUE(pProducer->Update(7, MakeInstance(4)));
+    EXPECT_TRUE(pProducer->Update(0, MakeInstance(5)));
+    Stats = Hub.Drain(Instances);
+    EXPECT_EQ(Stats.NumApplied, 0u);
+    EXPECT_EQ(Stats.NumDropped, 2u);
+    EXPECT_EQ(Instances.GetCount(), 1u);
+
+    // Every command is counted either as applied or as dropped
+    EXPECT_TRUE(pProducer->Update(1, MakeInstance(6)));
+    EXPECT_TRUE(pProducer->Destroy(2));
+    EXPECT_TRUE(pProducer->Create(3, MakeInstance(7)));
+    Stats = Hub.Drain(Instances);
+    EXPECT_EQ(Stats.NumApplied, 2u);
+    EXPECT_EQ(Stats.NumDropped, 1u);
+    EXPECT_EQ(Instances.GetCount(), 2u);
+}
+
+TEST(InstanceCommandHub, DrainLimitLeavesCommandsQueued)
+{
+    InstanceManager    Instances{16};
+    InstanceCommandHub Hub;
+    InstanceProducer*  pProducer = Hub.RegisterProducer(8);
+    EXPECT_TRUE(pProducer != nullptr);
+    if (pProducer == nullptr)
+        return;
+
+    for (Uint32 Id = 0; Id < 8; ++Id)
+        EXPECT_TRUE(pProducer->Create(Id, MakeInstance(static_cast<float>(Id))));
+
+    EXPECT_EQ(Hub.Drain(Instances, 3).NumApplied, 3u);
+    EXPECT_EQ(Instances.GetCount(), 3u);
+    EXPECT_EQ(Hub.Drain(Instances).NumApplied, 5u);
+    EXPECT_EQ(Instances.GetCount(), 8u);
+}
+
+TEST(InstanceCommandHub, ProducerLimit)
+{
+    InstanceCommandHub Hub;
+    for (Uint32 i = 0; i < InstanceCommandHub::MaxProducers; ++i)
+        EXPECT_TRUE(Hub.RegisterProducer(1) != nullptr);
+    EXPECT_TRUE(Hub.RegisterProducer(1) == nullptr);
+}
@@ -0,0 +1,216 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "InstanceManager.hpp"
+#include "TestFramework.hpp"
+
+using namespace Diligent;
+
+namespace
+{
+
+bool HasRanges(const DirtyRangeList& List, const std::vector<std::pair<Uint32, Uint32>>& Expected)
+{
+    if (List.GetNumRanges() != Expected.size())
+        return false;
+    for (Uint32 i = 0; i < List.GetNumRanges(); ++i)
+    {
+        if (List.GetRange(i).Begin != Expected[i].first || List.GetRange(i).End != Expected[i].second)
+            return false;
+    }
+    return true;
+}
+
+// Ranges must be non-empty, sorted and separated by at least one clean element
+bool IsSortedAndDisjoint(const DirtyRangeList& List)
+{
+    for (Uint32 i = 0; i < List.GetNumRanges(); ++i)
+    {
+        const auto& Range = List.GetRange(i);
+        if (Range.Begin >= Range.End)
+            return false;
+        if (i > 0 && Range.Begin <= List.GetRange(i - 1).End)
+            return false;
+    }
+    return true;
+}
+
+bool IsCovered(const DirtyRangeList& List, Uint32 Index)
+{
+    for (Uint32 i = 0; i < List.GetNumRanges(); ++i)
+    {
+        if (Index >= List.GetRange(i).Begin && Index < List.GetRange(i).End)
+            return true;
+    }
+    return false;
+}
+
+} // namespace
+
+TEST(DirtyRangeList, AdjacentElementsExtendRange)
+{
+    DirtyRangeList List;
+    List.MarkDirty(5);
+    List.MarkDirty(6);
+    List.MarkDirty(4);
+    EXPECT_TRUE(HasRanges(List, {{4, 7}}));
+}
+
+TEST(DirtyRangeList, RepeatedElementDoesNotGrowRange)
+{
+    DirtyRangeList List;
+    List.MarkDirty(3);
+    List.MarkDirty(3);
+    List.MarkDirty(3);
+    EXPECT_TRUE(HasRanges(List, {{3, 4}}));
+}
+
+TEST(DirtyRangeList, FirstElement)
+{
+    // Index + 1 >= Begin must not wrap around for the element 0
+    DirtyRangeList List;
+    List.MarkDirty(2);
+    List.MarkDirty(0);
+    EXPECT_TRUE(HasRanges(List, {{0, 1}, {2, 3}}));
+    List.MarkDirty(1);
+    EXPECT_TRUE(HasRanges(List, {{0, 3}}));
+}
+
+TEST(DirtyRangeList, ExtensionMergesWithNextRange)
+{
+    DirtyRangeList List;
+    List.MarkDirty(0);
+    List.MarkDirty(1);
+    List.MarkDirty(3);
+    List.MarkDirty(4);
+    EXPECT_TRUE(HasRanges(List, {{0, 2}, {3, 5}}));
+
+    // Extends the end of the first range, which then touches the second one
+    List.MarkDirty(2);
+    EXPECT_TRUE(HasRanges(List, {{0, 5}}));
+}
+
+TEST(DirtyRangeList, ExtensionMergesWithPreviousRange)
+{
+    DirtyRangeList List;
+    List.MarkDirty(0);
+    List.MarkDirty(3);
+    List.MarkDirty(2);
+    EXPECT_TRUE(HasRanges(List, {{0, 1}, {2, 4}}));
+
+    // Extends the begin of the second range, which then touches the first one
+    List.MarkDirty(1);
+    EXPECT_TRUE(HasRanges(List, {{0, 4}}));
+}
+
+TEST(DirtyRangeList, FullListMergesSmallestGap)
+{
+    DirtyRangeList List;
+    // Gaps of 9 except for the gap of 2 between 30 and 33
+    const Uint32 Indices[] = {0, 10, 20, 30, 33, 43, 53, 63};
+    for (Uint32 Index : Indices)
+        List.MarkDirty(Index);
+    EXPECT_EQ(List.GetNumRanges(), DirtyRangeList::MaxRanges);
+
+    List.MarkDirty(100);
+    EXPECT_TRUE(HasRanges(List, {{0, 1}, {10, 11}, {20, 21}, {30, 34}, {43, 44}, {53, 54}, {63, 64}, {100, 101}}));
+}
+
+TEST(DirtyRangeList, FullListNewElementInsideMergedGap)
+{
+    DirtyRangeList List;
+    for (Uint32 i = 0; i < DirtyRangeList::MaxRanges; ++i)
+        List.MarkDirty(i * 10);
+
+    // All gaps are equal, so the first two ranges are merged and then overlap the new element
+    List.MarkDirty(5);
+    EXPECT_TRUE(IsSortedAndDisjoint(List));
+    EXPECT_TRUE(HasRanges(List, {{0, 11}, {20, 21}, {30, 31}, {40, 41}, {50, 51}, {60, 61}, {70, 71}}));
+}
+
+TEST(DirtyRangeList, FlushKeepsRejectedRanges)
+{
+    DirtyRangeList List;
+    List.MarkDirty(1);
+    List.MarkDirty(5);
+    List.MarkDirty(9);
+
+    Uint32 NumCalls = 0;
+    List.Flush([&](const DirtyRangeList::Range& Range) {
+        ++NumCalls;
+        return Range.Begin != 5;
+    });
+    EXPECT_EQ(NumCalls, 3u);
+    EXPECT_TRUE(HasRanges(List, {{5, 6}}));
+
+    List.Flush([](const DirtyRangeList::Range&) { return true; });
+    EXPECT_TRUE(List.IsEmpty());
+}
+
+TEST(DirtyRangeList, RandomElementsAreCovered)
+{
+    std::mt19937 Rng{42};
+    for (int Iteration = 0; Iteration < 200; ++Iteration)
+    {
+        DirtyRangeList      List;
+        std::vector<Uint32> Marked;
+        const int           NumMarks = 1 + Iteration % 40;
+        for (int i = 0; i < NumMarks; ++i)
+        {
+            const Uint32 Index = Rng() % 64;
+            List.MarkDirty(Index);
+            Marked.push_back(Index);
+        }
+
+        EXPECT_TRUE(List.GetNumRanges() <= DirtyRangeList::MaxRanges);
+        EXPECT_TRUE(IsSortedAndDisjoint(List));
+        for (Uint32 Index : Marked)
+            EXPECT_TRUE(IsCovered(List, Index));
+    }
+}
+
+TEST(InstanceManager, RemoveKeepsArrayDense)
+{
+    InstanceManager Instances{16};
+
+    InstanceHandle Handles[4];
+    for (auto& Handle : Handles)
+        Handle = Instances.Add({});
+    EXPECT_TRUE(Instances.IsDirty());
+
+    // The last instance is moved into the hole, and the stale handle no longer resolves
+    EXPECT_TRUE(Instances.Remove(Handles[1]));
+    EXPECT_FALSE(Instances.Remove(Handles[1]));
+    EXPECT_FALSE(Instances.IsAlive(Handles[1]));
+    EXPECT_TRUE(Instances.IsAlive(Handles[3]));
+    EXPECT_TRUE(Instances.Get(Handles[3]) == Instances.GetData() + 1);
+    EXPECT_EQ(Instances.GetCount(), 3u);
+}
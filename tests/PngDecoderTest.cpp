@@ -0,0 +1,473 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "PngDecoder.hpp"
+#include "RefCntAutoPtr.hpp"
+#include "TextureLoader.h"
+#include "TestFramework.hpp"
+
+using namespace Diligent;
+
+namespace
+{
+
+enum PNG_COLOR_TYPE : Uint8
+{
+    PNG_COLOR_TYPE_GRAY       = 0,
+    PNG_COLOR_TYPE_RGB        = 2,
+    PNG_COLOR_TYPE_PALETTE    = 3,
+    PNG_COLOR_TYPE_GRAY_ALPHA = 4,
+    PNG_COLOR_TYPE_RGBA       = 6
+};
+
+Uint32 GetNumChannels(Uint8 ColorType)
+{
+    static constexpr Uint32 ChannelsPerType[] = {1, 0, 3, 1, 2, 0, 4};
+    return ChannelsPerType[ColorType];
+}
+
+void AppendBE32(std::vector<Uint8>& Data, Uint32 Value)
+{
+    for (int Shift = 24; Shift >= 0; Shift -= 8)
+        Data.push_back(static_cast<Uint8>(Value >> Shift));
+}
+
+Uint32 ComputeCrc32(const Uint8* pData, size_t Size)
+{
+    Uint32 Crc = ~0u;
+    for (size_t i = 0; i < Size; ++i)
+    {
+        Crc ^= pData[i];
+        for (int Bit = 0; Bit < 8; ++Bit)
+            Crc = (Crc >> 1) ^ (0xEDB88320u & (0u - (Crc & 1)));
+    }
+    return ~Crc;
+}
+
+void AppendChunk(std::vector<Uint8>& Png, const char* Type, const Uint8* pData, size_t Size)
+{
+    AppendBE32(Png, static_cast<Uint32>(Size));
+    const size_t TypePos = Png.size();
+    Png.insert(Png.end(), Type, Type + 4);
+    Png.insert(Png.end(), pData, pData + Size);
+    AppendBE32(Png, ComputeCrc32(&Png[TypePos], Size + 4));
+}
+
+struct PngParams
+{
+    Uint32 Width     = 1;
+    Uint32 Height    = 1;
+    Uint8  ColorType = PNG_COLOR_TYPE_RGBA;
+    Uint8  BitDepth  = 8;
+    Uint8  Interlace = 0;
+
+    // The zlib stream is split into IDAT chunks of this size
+    size_t IDATSize = ~size_t{0};
+
+    std::vector<Uint8> Palette;
+    std::vector<Uint8> Transparency;
+};
+
+std::vector<Uint8> MakePng(const PngParams& Params, const std::vector<Uint8>& ZlibData)
+{
+    std::vector<Uint8> Png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+    std::vector<Uint8> Header;
+    AppendBE32(Header, Params.Width);
+    AppendBE32(Header, Params.Height);
+    Header.insert(Header.end(), {Params.BitDepth, Params.ColorType, 0, 0, Params.Interlace});
+    AppendChunk(Png, "IHDR", Header.data(), Header.size());
+    if (!Params.Palette.empty())
+        AppendChunk(Png, "PLTE", Params.Palette.data(), Params.Palette.size());
+    if (!Params.Transparency.empty())
+        AppendChunk(Png, "tRNS", Params.Transparency.data(), Params.Transparency.size());
+    for (size_t Pos = 0; Pos < ZlibData.size(); Pos += Params.IDATSize)
+        AppendChunk(Png, "IDAT", ZlibData.data() + Pos, std::min(Params.IDATSize, ZlibData.size() - Pos));
+    AppendChunk(Png, "IEND", nullptr, 0);
+    return Png;
+}
+
+// Zlib stream of stored deflate blocks of the given size
+std::vector<Uint8> MakeStoredZlib(const std::vector<Uint8>& Data, size_t BlockSize)
+{
+    std::vector<Uint8> Zlib = {0x78, 0x01};
+    size_t             Pos  = 0;
+    do
+    {
+        const size_t Size = std::min(BlockSize, Data.size() - Pos);
+        Zlib.push_back(Pos + Size == Data.size() ? 1 : 0); // BFINAL and BTYPE
+        Zlib.push_back(static_cast<Uint8>(Size));
+        Zlib.push_back(static_cast<Uint8>(Size >> 8));
+        Zlib.push_back(static_cast<Uint8>(~Size));
+        Zlib.push_back(static_cast<Uint8>(~Size >> 8));
+        Zlib.insert(Zlib.end(), Data.begin() + Pos, Data.begin() + Pos + Size);
+        Pos += Size;
+    } while (Pos < Data.size());
+
+    Uint32 A = 1, B = 0;
+    for (Uint8 Byte : Data)
+    {
+        A = (A + Byte) % 65521;
+        B = (B + A) % 65521;
+    }
+    AppendBE32(Zlib, (B << 16) | A);
+    return Zlib;
+}
+
+Uint8 PaethPredictor(int a, int b, int c)
+{
+    const int p  = a + b - c;
+    const int pa = std::abs(p - a);
+    const int pb = std::abs(p - b);
+    const int pc = std::abs(p - c);
+    return static_cast<Uint8>(pa <= pb && pa <= pc ? a : (pb <= pc ? b : c));
+}
+
+// Filters the rows with the filter type returned by GetFilter(y), as an encoder would
+template <typename FilterSelector>
+std::vector<Uint8> FilterRows(const std::vector<Uint8>& Pixels, Uint32 Width, Uint32 Height, Uint32 Bpp, FilterSelector GetFilter)
+{
+    const size_t       RowBytes = size_t{Width} * Bpp;
+    std::vector<Uint8> Filtered;
+    std::vector<Uint8> ZeroRow(RowBytes);
+    for (Uint32 y = 0; y < Height; ++y)
+    {
+        const Uint8* pRow  = &Pixels[y * RowBytes];
+        const Uint8* pPrev = y > 0 ? pRow - RowBytes : ZeroRow.data();
+        const Uint8  Type  = GetFilter(y);
+        Filtered.push_back(Type);
+        for (size_t i = 0; i < RowBytes; ++i)
+        {
+            const int a = i >= Bpp ? pRow[i - Bpp] : 0;
+            const int b = pPrev[i];
+            const int c = i >= Bpp ? pPrev[i - Bpp] : 0;
+
+            int Prediction = 0;
+            switch (Type)
+            {
+                case 1: Prediction = a; break;
+                case 2: Prediction = b; break;
+                case 3: Prediction = (a + b) / 2; break;
+                case 4: Prediction = PaethPredictor(a, b, c); break;
+                default: break;
+            }
+            Filtered.push_back(static_cast<Uint8>(pRow[i] - Prediction));
+        }
+    }
+    return Filtered;
+}
+
+std::vector<Uint8> ExpandToRGBA(const std::vector<Uint8>& Pixels, Uint32 NumChannels)
+{
+    std::vector<Uint8> RGBA;
+    for (size_t i = 0; i < Pixels.size(); i += NumChannels)
+    {
+        const Uint8* p = &Pixels[i];
+        switch (NumChannels)
+        {
+            case 1: RGBA.insert(RGBA.end(), {p[0], p[0], p[0], 255}); break;
+            case 2: RGBA.insert(RGBA.end(), {p[0], p[0], p[0], p[1]}); break;
+            case 3: RGBA.insert(RGBA.end(), {p[0], p[1], p[2], 255}); break;
+            default: RGBA.insert(RGBA.end(), p, p + 4); break;
+        }
+    }
+    return RGBA;
+}
+
+bool HasLevel0(const DecodedPngTexture& Texture, const Uint8* pExpected, size_t ExpectedStride)
+{
+    if (Texture.Mips.empty() || Texture.Desc.Format != TEX_FORMAT_RGBA8_UNORM)
+        return false;
+    const auto&  Level0   = Texture.Mips[0];
+    const size_t RowBytes = size_t{Texture.Desc.Width} * 4;
+    for (Uint32 y = 0; y < Texture.Desc.Height; ++y)
+    {
+        const Uint8* pRow = static_cast<const Uint8*>(Level0.pData) + y * Level0.Stride;
+        if (memcmp(pRow, pExpected + y * ExpectedStride, RowBytes) != 0)
+            return false;
+    }
+    return true;
+}
+
+// 16x12 RGB image with the filter type y % 5 in row y, compressed by zlib with fixed and
+// dynamic Huffman codes
+constexpr Uint32 ReferenceWidth  = 16;
+constexpr Uint32 ReferenceHeight = 12;
+
+std::vector<Uint8> MakeReferencePixels()
+{
+    std::vector<Uint8> Pixels;
+    for (Uint32 y = 0; y < ReferenceHeight; ++y)
+    {
+        for (Uint32 x = 0; x < ReferenceWidth; ++x)
+            Pixels.insert(Pixels.end(), {static_cast<Uint8>(x * 8 + y), static_cast<Uint8>((y * 16) ^ x), static_cast<Uint8>(x * y)});
+    }
+    return Pixels;
+}
+
+const std::vector<Uint8> FixedHuffmanZlib = {
+    0x78, 0x01, 0x63, 0x60, 0x60, 0x60, 0xE0, 0x60, 0x64, 0x10, 0x60, 0x62, 0x90, 0x60, 0x66, 0x50, 0x60, 0x61,
+    0xD0, 0x60, 0x65, 0x30, 0x60, 0x63, 0xB0, 0x60, 0x67, 0x70, 0xE0, 0x60, 0xF0, 0xE0, 0x64, 0x08, 0xE0, 0x62,
+    0x88, 0xE0, 0x66, 0x48, 0xE0, 0x61, 0xC8, 0xE0, 0x65, 0x28, 0xE0, 0x63, 0xA8, 0xE0, 0x67, 0x60, 0x64, 0x14,
+    0x00, 0x6A, 0x60, 0x24, 0x1E, 0x31, 0x01, 0x35, 0x30, 0x0A, 0x00, 0xB5, 0x01, 0x19, 0xCC, 0x8C, 0x02, 0x2C,
+    0x8C, 0x02, 0xAC, 0x8C, 0x02, 0x6C, 0x8C, 0x02, 0xEC, 0x8C, 0x02, 0x1C, 0x8C, 0x02, 0x9C, 0x8C, 0x02, 0x5C,
+    0x8C, 0x02, 0xDC, 0x8C, 0x02, 0x3C, 0x8C, 0x02, 0xBC, 0x8C, 0x02, 0x7C, 0x8C, 0x02, 0xFC, 0xCC, 0x4C, 0x0A,
+    0x0C, 0xAC, 0x9C, 0x4C, 0xAC, 0x9C, 0xCC, 0x60, 0xC4, 0x02, 0x46, 0xAC, 0x60, 0xC4, 0x06, 0x46, 0xEC, 0x60,
+    0xC4, 0x01, 0x46, 0x9C, 0x40, 0xC4, 0x02, 0xB2, 0x01, 0x04, 0x98, 0x18, 0x19, 0x99, 0x19, 0x19, 0x59, 0x08,
+    0x22, 0x06, 0xD6, 0x00, 0x06, 0xDE, 0x40, 0x56, 0xD1, 0x20, 0x2E, 0xD9, 0x60, 0x7E, 0xD5, 0x10, 0x11, 0xDD,
+    0x50, 0x49, 0xD3, 0x30, 0x39, 0xDB, 0x70, 0x65, 0xD7, 0x08, 0x0D, 0xDF, 0x48, 0xDD, 0xD0, 0x28, 0xA3, 0xD8,
+    0x68, 0xF3, 0xD4, 0x18, 0x9B, 0xDC, 0x58, 0xC7, 0xD2, 0x38, 0xB7, 0xDA, 0x78, 0x6F, 0x46, 0xB6, 0x04, 0xA0,
+    0xA7, 0xD9, 0x88, 0x47, 0xA4, 0x7B, 0x9A, 0xD5, 0x83, 0x01, 0xBF, 0x2F, 0x59, 0x39, 0xB9, 0xC0, 0x88, 0x1B,
+    0x8C, 0x78, 0x30, 0x3D, 0xCD, 0xCA, 0xC8, 0xC8, 0xC6, 0xC8, 0xC8, 0x0E, 0x0E, 0x74, 0x4E, 0x4C, 0xC4, 0xC0,
+    0xB5, 0x80, 0x41, 0x68, 0x21, 0x97, 0xD4, 0x22, 0x11, 0xA5, 0xC5, 0x72, 0x5A, 0x4B, 0x34, 0x8C, 0x96, 0x1A,
+    0x59, 0x2D, 0xB3, 0x71, 0x5A, 0xEE, 0xE6, 0xB5, 0x22, 0x20, 0x68, 0x65, 0x54, 0xD4, 0xAA, 0x94, 0xA4, 0xD5,
+    0x79, 0x59, 0x6B, 0x2A, 0x8A, 0xD6, 0x36, 0x55, 0xAD, 0xEB, 0x69, 0x5A, 0x3F, 0x8D, 0x91, 0x7B, 0x03, 0xD0,
+    0xD3, 0xDC, 0xC4, 0x23, 0x00, 0x2A, 0x8B, 0x2E, 0x77, //
+};
+
+const std::vector<Uint8> DynamicHuffmanZlib = {
+    0x78, 0xDA, 0x95, 0xD0, 0x4B, 0x4B, 0xC3, 0x40, 0x18, 0x85, 0xE1, 0xEF, 0x24, 0x99, 0x24, 0x93, 0x4B, 0xFB,
+    0x21, 0x15, 0x54, 0xB0, 0x14, 0x45, 0x28, 0x42, 0x41, 0x02, 0xA2, 0x48, 0x05, 0x15, 0x2C, 0x45, 0x11, 0x6A,
+    0xB5, 0x5A, 0xA3, 0xD5, 0x22, 0x0A, 0x22, 0x28, 0x22, 0x08, 0x45, 0x70, 0xD3, 0xB5, 0x6B, 0xD7, 0xDE, 0xEF,
+    0xB7, 0x9F, 0xE8, 0x74, 0xB6, 0x05, 0x8D, 0xC3, 0xB3, 0x98, 0xCD, 0x61, 0x78, 0x87, 0x88, 0xC8, 0x05, 0xB1,
+    0x41, 0x7D, 0x26, 0xE5, 0x2C, 0xCA, 0x0B, 0x1A, 0xB3, 0x69, 0xD2, 0xA1, 0x19, 0x97, 0xCA, 0x92, 0x2A, 0x1E,
+    0xD5, 0x7D, 0x6A, 0x06, 0x74, 0x10, 0xD2, 0x49, 0x8A, 0x5A, 0x69, 0x02, 0x58, 0x0D, 0x90, 0x9C, 0xA1, 0x06,
+    0x60, 0x35, 0x53, 0x17, 0x13, 0x6C, 0x81, 0x05, 0xD8, 0x06, 0x3B, 0x60, 0x17, 0x2C, 0xC1, 0x1E, 0xD8, 0x07,
+    0x07, 0xE0, 0x10, 0x9C, 0x02, 0xA7, 0x4D, 0x23, 0x47, 0x42, 0x1A, 0x42, 0x9A, 0x9A, 0xA5, 0x09, 0xCD, 0xD6,
+    0x1C, 0xCD, 0xD5, 0xA4, 0x62, 0x75, 0x5E, 0xE8, 0x1C, 0x03, 0x30, 0x01, 0xEB, 0x4F, 0x24, 0x2A, 0x14, 0x2E,
+    0x8B, 0xDE, 0xAA, 0x37, 0xB8, 0x92, 0x1E, 0x59, 0xCD, 0x14, 0x6A, 0xFD, 0xE3, 0x6B, 0xD9, 0xE9, 0xF5, 0xE1,
+    0xF9, 0x7A, 0x7E, 0x69, 0xA3, 0x50, 0x8B, 0xA3, 0xC6, 0xE6, 0xC4, 0xFE, 0x56, 0xF1, 0xA8, 0x31, 0x7B, 0xB6,
+    0x5D, 0xBA, 0xD8, 0x59, 0x84, 0xDD, 0x54, 0xD1, 0x76, 0x72, 0xFF, 0x8F, 0x16, 0x65, 0xFA, 0xBD, 0x52, 0x48,
+    0x4F, 0xF3, 0xB5, 0xA0, 0x3B, 0x5A, 0x00, 0x36, 0xE0, 0xE8, 0x4F, 0x97, 0xDD, 0xC8, 0xBB, 0xA6, 0x9E, 0x1B,
+    0x6F, 0xE0, 0x36, 0x33, 0x74, 0x97, 0x1D, 0xBD, 0xCF, 0x47, 0x0F, 0xD1, 0xD4, 0x63, 0x71, 0xEE, 0xA9, 0xB4,
+    0xF0, 0x5C, 0xA9, 0xBE, 0xC4, 0xF1, 0xEB, 0xDE, 0xEE, 0xDB, 0xF1, 0xE1, 0x7B, 0xEB, 0xF4, 0xA3, 0x7D, 0xFE,
+    0x79, 0xD9, 0xFE, 0xBA, 0x82, 0xFF, 0xAD, 0xA2, 0xFD, 0xE4, 0x7E, 0x00, 0x2A, 0x8B, 0x2E, 0x77, //
+};
+
+std::vector<Uint8> ReadAsset(const char* Name)
+{
+    const std::string  Path  = std::string{TUTORIAL05_ASSETS_DIR} + "/" + Name;
+    std::vector<Uint8> Data;
+    if (FILE* pFile = fopen(Path.c_str(), "rb"))
+    {
+        Uint8 Buffer[4096];
+        for (size_t Size; (Size = fread(Buffer, 1, sizeof(Buffer), pFile)) > 0;)
+            Data.insert(Data.end(), Buffer, Buffer + Size);
+        fclose(pFile);
+    }
+    return Data;
+}
+
+} // namespace
+
+TEST(PngDecoder, AllFiltersAndColorTypes)
+{
+    std::mt19937 Rng{11};
+    for (Uint8 ColorType : {PNG_COLOR_TYPE_GRAY, PNG_COLOR_TYPE_GRAY_ALPHA, PNG_COLOR_TYPE_RGB, PNG_COLOR_TYPE_RGBA})
+    {
+        const Uint32 NumChannels = GetNumChannels(ColorType);
+        for (Uint32 Size : {1u, 7u, 33u})
+        {
+            PngParams Params;
+            Params.Width     = Size;
+            Params.Height    = Size / 2 + 3;
+            Params.ColorType = ColorType;
+            Params.IDATSize  = 37;
+
+            // Few distinct values produce ties in the Paeth predictor
+            const Uint32       NumValues = Size == 33 ? 8 : 256;
+            std::vector<Uint8> Pixels(size_t{Params.Width} * Params.Height * NumChannels);
+            for (auto& Byte : Pixels)
+                Byte = static_cast<Uint8>(Rng() % NumValues);
+            const auto Expected = ExpandToRGBA(Pixels, NumChannels);
+
+            // Filter types 0 to 4 on all rows, then all types mixed in one image
+            for (Uint8 Filter = 0; Filter <= 5; ++Filter)
+            {
+                auto GetFilter = [Filter](Uint32 y) { return static_cast<Uint8>(Filter < 5 ? Filter : y % 5); };
+                const auto Filtered = FilterRows(Pixels, Params.Width, Params.Height, NumChannels, GetFilter);
+                const auto Png      = MakePng(Params, MakeStoredZlib(Filtered, 50));
+
+                DecodedPngTexture Texture;
+                EXPECT_TRUE(DecodePngTexture(Png.data(), Png.size(), false, Texture));
+                EXPECT_EQ(Texture.Desc.Width, Params.Width);
+                EXPECT_EQ(Texture.Desc.Height, Params.Height);
+                EXPECT_TRUE(HasLevel0(Texture, Expected.data(), size_t{Params.Width} * 4));
+            }
+        }
+    }
+}
+
+TEST(PngDecoder, PaletteAndTransparency)
+{
+    PngParams Params;
+    Params.Width        = 4;
+    Params.Height       = 2;
+    Params.ColorType    = PNG_COLOR_TYPE_PALETTE;
+    Params.Palette      = {255, 0, 0, 0, 255, 0, 0, 0, 255};
+    Params.Transparency = {128};
+
+    const std::vector<Uint8> Indices  = {0, 1, 2, 1, 2, 2, 0, 0};
+    const Uint8              Expected[] = {
+        255, 0, 0, 128, 0, 255, 0, 255, 0, 0, 255, 255, 0, 255, 0, 255,
+        0, 0, 255, 255, 0, 0, 255, 255, 255, 0, 0, 128, 255, 0, 0, 128, //
+    };
+    const auto Png = MakePng(Params, MakeStoredZlib(FilterRows(Indices, 4, 2, 1, [](Uint32) { return Uint8{1}; }), 100));
+
+    DecodedPngTexture Texture;
+    EXPECT_TRUE(DecodePngTexture(Png.data(), Png.size(), false, Texture));
+    EXPECT_TRUE(HasLevel0(Texture, Expected, 16));
+
+    // A color key makes the matching pixels transparent
+    Params.ColorType    = PNG_COLOR_TYPE_RGB;
+    Params.Width        = 2;
+    Params.Height       = 1;
+    Params.Palette      = {};
+    Params.Transparency = {0, 10, 0, 20, 0, 30};
+
+    const std::vector<Uint8> Pixels      = {10, 20, 30, 10, 20, 31};
+    const Uint8              ExpectedRGB[] = {10, 20, 30, 0, 10, 20, 31, 255};
+    const auto               RGBPng        = MakePng(Params, MakeStoredZlib(FilterRows(Pixels, 2, 1, 3, [](Uint32) { return Uint8{0}; }), 100));
+    EXPECT_TRUE(DecodePngTexture(RGBPng.data(), RGBPng.size(), false, Texture));
+    EXPECT_TRUE(HasLevel0(Texture, ExpectedRGB, 8));
+}
+
+TEST(PngDecoder, HuffmanBlocks)
+{
+    PngParams Params;
+    Params.Width     = ReferenceWidth;
+    Params.Height    = ReferenceHeight;
+    Params.ColorType = PNG_COLOR_TYPE_RGB;
+
+    const auto Expected = ExpandToRGBA(MakeReferencePixels(), 3);
+    for (const auto* pZlib : {&FixedHuffmanZlib, &DynamicHuffmanZlib})
+    {
+        for (size_t IDATSize : {~size_t{0}, size_t{1}, size_t{100}})
+        {
+            Params.IDATSize = IDATSize;
+            const auto Png  = MakePng(Params, *pZlib);
+
+            DecodedPngTexture Texture;
+            EXPECT_TRUE(DecodePngTexture(Png.data(), Png.size(), false, Texture));
+            EXPECT_TRUE(HasLevel0(Texture, Expected.data(), ReferenceWidth * 4));
+        }
+    }
+}
+
+TEST(PngDecoder, RejectsTruncatedData)
+{
+    PngParams Params;
+    Params.ColorType = PNG_COLOR_TYPE_RGB;
+
+    // A 1x1 RGB image is 4 bytes with the filter type, but the stored block ends after 2
+    const std::vector<Uint8> ShortStored = {0x78, 0x01, 0x01, 0x04, 0x00, 0xFB, 0xFF, 0x00, 0x10};
+    const auto               Png         = MakePng(Params, ShortStored);
+
+    DecodedPngTexture Texture;
+    EXPECT_FALSE(DecodePngTexture(Png.data(), Png.size(), false, Texture));
+
+    // Every truncation of the deflate data must fail; the checksum at the end is not verified
+    Params.Width  = ReferenceWidth;
+    Params.Height = ReferenceHeight;
+    const auto Stored = MakeStoredZlib(FilterRows(MakeReferencePixels(), ReferenceWidth, ReferenceHeight, 3, [](Uint32 y) { return static_cast<Uint8>(y % 5); }), 100);
+    for (const auto* pZlib : {&FixedHuffmanZlib, &DynamicHuffmanZlib, &Stored})
+    {
+        bool AllRejected = true;
+        for (size_t Size = 0; Size + 4 < pZlib->size(); ++Size)
+        {
+            const auto Truncated = MakePng(Params, std::vector<Uint8>{pZlib->begin(), pZlib->begin() + Size});
+            AllRejected          = AllRejected && !DecodePngTexture(Truncated.data(), Truncated.size(), false, Texture);
+        }
+        EXPECT_TRUE(AllRejected);
+    }
+}
+
+TEST(PngDecoder, RejectsUnsupportedFiles)
+{
+    const std::vector<Uint8> Filtered = {0, 1, 2, 3, 4};
+
+    PngParams Params;
+    Params.ColorType = PNG_COLOR_TYPE_RGBA;
+
+    DecodedPngTexture Texture;
+    auto              Png = MakePng(Params, MakeStoredZlib(Filtered, 100));
+    EXPECT_TRUE(DecodePngTexture(Png.data(), Png.size(), false, Texture));
+
+    // Invalid filter type
+    Png = MakePng(Params, MakeStoredZlib({5, 1, 2, 3, 4}, 100));
+    EXPECT_FALSE(DecodePngTexture(Png.data(), Png.size(), false, Texture));
+
+    // Not a PNG file
+    Png[1] = 'X';
+    EXPECT_FALSE(DecodePngTexture(Png.data(), Png.size(), false, Texture));
+
+    // 16-bit and interlaced images go through the texture loader
+    Params.BitDepth = 16;
+    Png             = MakePng(Params, MakeStoredZlib({0, 1, 2, 3, 4, 5, 6, 7, 8}, 100));
+    EXPECT_FALSE(DecodePngTexture(Png.data(), Png.size(), false, Texture));
+    Params.BitDepth  = 8;
+    Params.Interlace = 1;
+    Png              = MakePng(Params, MakeStoredZlib(Filtered, 100));
+    EXPECT_FALSE(DecodePngTexture(Png.data(), Png.size(), false, Texture));
+}
+
+TEST(PngDecoder, MatchesTextureLoader)
+{
+    for (const char* Name : {"DGLogo0.png", "DGLogo1.png", "DGLogo2.png", "DGLogo3.png"})
+    {
+        const auto Png = ReadAsset(Name);
+        EXPECT_FALSE(Png.empty());
+        if (Png.empty())
+            continue;
+
+        DecodedPngTexture Texture;
+        EXPECT_TRUE(DecodePngTexture(Png.data(), Png.size(), false, Texture));
+
+        TextureLoadInfo               LoadInfo;
+        RefCntAutoPtr<ITextureLoader> pLoader;
+        CreateTextureLoaderFromMemory(Png.data(), Png.size(), false, LoadInfo, &pLoader);
+        EXPECT_TRUE(pLoader);
+        if (!pLoader)
+            continue;
+
+        const auto& Desc = pLoader->GetTextureDesc();
+        EXPECT_EQ(Texture.Desc.Width, Desc.Width);
+        EXPECT_EQ(Texture.Desc.Height, Desc.Height);
+        EXPECT_EQ(Desc.Format, TEX_FORMAT_RGBA8_UNORM);
+        if (Texture.Desc.Width != Desc.Width || Texture.Desc.Height != Desc.Height || Desc.Format != TEX_FORMAT_RGBA8_UNORM)
+            continue;
+
+        const auto& Level0 = pLoader->GetSubresourceData(0, 0);
+        EXPECT_TRUE(HasLevel0(Texture, static_cast<const Uint8*>(Level0.pData), static_cast<size_t>(Level0.Stride)));
+    }
+}
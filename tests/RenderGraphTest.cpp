@@ -0,0 +1,174 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "RenderGraph.hpp"
+#include "TestFramework.hpp"
+
+using namespace Diligent;
+
+namespace
+{
+
+using TransientLifetime = RenderGraph::TransientLifetime;
+
+TextureDesc MakeDesc(Uint32 Width, TEXTURE_FORMAT Format, BIND_FLAGS BindFlags = BIND_RENDER_TARGET | BIND_SHADER_RESOURCE)
+{
+    TextureDesc Desc;
+    Desc.Type      = RESOURCE_DIM_TEX_2D;
+    Desc.Width     = Width;
+    Desc.Height    = Width;
+    Desc.Format    = Format;
+    Desc.BindFlags = BindFlags;
+    return Desc;
+}
+
+const TextureDesc ColorDesc = MakeDesc(256, TEX_FORMAT_RGBA8_UNORM);
+const TextureDesc DepthDesc = MakeDesc(256, TEX_FORMAT_D32_FLOAT, BIND_DEPTH_STENCIL);
+
+} // namespace
+
+TEST(RenderGraph, DisjointLifetimesShareTexture)
+{
+    std::vector<TextureDesc> PhysicalDescs;
+
+    const auto Assignment = RenderGraph::AssignPhysicalTextures({{ColorDesc, 0, 1}, {ColorDesc, 2, 3}, {ColorDesc, 4, 4}}, PhysicalDescs);
+    EXPECT_EQ(PhysicalDescs.size(), 1u);
+    EXPECT_TRUE(Assignment == std::vector<Uint32>({0, 0, 0}));
+}
+
+TEST(RenderGraph, OverlappingLifetimesUseDistinctTextures)
+{
+    std::vector<TextureDesc> PhysicalDescs;
+
+    // A texture that is read by the pass that writes the next one is still alive in that pass
+    auto Assignment = RenderGraph::AssignPhysicalTextures({{ColorDesc, 0, 1}, {ColorDesc, 1, 2}}, PhysicalDescs);
+    EXPECT_EQ(PhysicalDescs.size(), 2u);
+    EXPECT_TRUE(Assignment == std::vector<Uint32>({0, 1}));
+
+    // The third texture fits after the first one, but not after the second one
+    PhysicalDescs.clear();
+    Assignment = RenderGraph::AssignPhysicalTextures({{ColorDesc, 2, 5}, {ColorDesc, 0, 1}, {ColorDesc, 1, 3}}, PhysicalDescs);
+    EXPECT_EQ(PhysicalDescs.size(), 2u);
+    EXPECT_TRUE(Assignment == std::vector<Uint32>({0, 0, 1}));
+}
+
+TEST(RenderGraph, IncompatibleDescsUseDistinctTextures)
+{
+    std::vector<TextureDesc> PhysicalDescs;
+
+    const auto Assignment = RenderGraph::AssignPhysicalTextures(
+        {
+            {ColorDesc, 0, 0},
+            {DepthDesc, 1, 1},
+            {MakeDesc(128, TEX_FORMAT_RGBA8_UNORM), 2, 2},
+            {ColorDesc, 3, 3},
+        },
+        PhysicalDescs);
+    EXPECT_EQ(PhysicalDescs.size(), 3u);
+    EXPECT_TRUE(Assignment == std::vector<Uint32>({0, 1, 2, 0}));
+    EXPECT_EQ(PhysicalDescs[1].Format, TEX_FORMAT_D32_FLOAT);
+    EXPECT_EQ(PhysicalDescs[2].Width, 128u);
+}
+
+TEST(RenderGraph, ExistingTexturesAreReused)
+{
+    // Physical textures of the previous graph
+    std::vector<TextureDesc> PhysicalDescs = {DepthDesc, ColorDesc};
+
+    const auto Assignment = RenderGraph::AssignPhysicalTextures({{ColorDesc, 0, 2}, {ColorDesc, 1, 1}}, PhysicalDescs);
+    EXPECT_EQ(PhysicalDescs.size(), 3u);
+    EXPECT_TRUE(Assignment == std::vector<Uint32>({1, 2}));
+
+    // Nothing is created if the graph fits into the existing textures
+    PhysicalDescs.resize(3);
+    EXPECT_TRUE(RenderGraph::AssignPhysicalTextures({{DepthDesc, 0, 0}}, PhysicalDescs) == std::vector<Uint32>({0}));
+    EXPECT_EQ(PhysicalDescs.size(), 3u);
+}
+
+TEST(RenderGraph, RandomLifetimes)
+{
+    constexpr size_t NumPasses = 16;
+
+    std::mt19937 Rng{3};
+    bool         IsValid   = true;
+    bool         IsOptimal = true;
+    for (int Iteration = 0; Iteration < 500; ++Iteration)
+    {
+        std::vector<TransientLifetime> Transients(1 + Rng() % 20);
+        for (auto& Transient : Transients)
+        {
+            Transient.Desc      = Rng() % 2 ? ColorDesc : DepthDesc;
+            Transient.FirstPass = Rng() % NumPasses;
+            Transient.LastPass  = Transient.FirstPass + Rng() % (NumPasses - Transient.FirstPass);
+        }
+
+        std::vector<TextureDesc> PhysicalDescs;
+        const auto               Assignment = RenderGraph::AssignPhysicalTextures(Transients, PhysicalDescs);
+        for (size_t i = 0; i < Transients.size(); ++i)
+        {
+            const auto& T1 = Transients[i];
+            IsValid        = IsValid && Assignment[i] < PhysicalDescs.size() && PhysicalDescs[Assignment[i]].Format == T1.Desc.Format;
+            for (size_t j = i + 1; j < Transients.size(); ++j)
+            {
+                const auto& T2 = Transients[j];
+                if (Assignment[i] == Assignment[j])
+                    IsValid = IsValid && (T1.LastPass < T2.FirstPass || T2.LastPass < T1.FirstPass);
+            }
+        }
+
+        // Assignment in the order of the first passes needs as many textures of each format
+        // as there are textures of that format alive in the busiest pass
+        for (TEXTURE_FORMAT Format : {TEX_FORMAT_RGBA8_UNORM, TEX_FORMAT_D32_FLOAT})
+        {
+            size_t MaxAlive = 0;
+            for (size_t Pass = 0; Pass < NumPasses; ++Pass)
+            {
+                size_t NumAlive = 0;
+                for (const auto& Transient : Transients)
+                {
+                    if (Transient.Desc.Format == Format && Transient.FirstPass <= Pass && Pass <= Transient.LastPass)
+                        ++NumAlive;
+                }
+                MaxAlive = std::max(MaxAlive, NumAlive);
+            }
+
+            size_t NumPhysical = 0;
+            for (const auto& Desc : PhysicalDescs)
+            {
+                if (Desc.Format == Format)
+                    ++NumPhysical;
+            }
+            IsOptimal = IsOptimal && NumPhysical == MaxAlive;
+        }
+    }
+    EXPECT_TRUE(IsValid);
+    EXPECT_TRUE(IsOptimal);
+}
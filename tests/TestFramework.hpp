@@ -0,0 +1,93 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+namespace Diligent
+{
+
+namespace Testing
+{
+
+// Minimal test registry for the unit tests of the sample. Tests are grouped into suites, and
+// every suite is registered with CTest separately (see CMakeLists.txt).
+struct TestCase
+{
+    const char* Suite;
+    const char* Name;
+    void (*Run)();
+};
+
+inline std::vector<TestCase>& GetTestCases()
+{
+    static std::vector<TestCase> Cases;
+    return Cases;
+}
+
+inline int& GetNumFailedChecks()
+{
+    static int NumFailed = 0;
+    return NumFailed;
+}
+
+struct TestRegistrar
+{
+    TestRegistrar(const char* Suite, const char* Name, void (*Run)())
+    {
+        GetTestCases().push_back({Suite, Name, Run});
+    }
+};
+
+inline void ReportFailedCheck(const char* File, int Line, const char* Expression)
+{
+    std::fprintf(stderr, "%s(%d): expectation failed: %s\n", File, Line, Expression);
+    ++GetNumFailedChecks();
+}
+
+} // namespace Testing
+
+} // namespace Diligent
+
+// The macros follow the names of GoogleTest, which the engine tests use
+#define TEST(Suite, Name)                                                                                       \
+    static void Suite##_##Name();                                                                               \
+    static const ::Diligent::Testing::TestRegistrar Suite##_##Name##_Registrar{#Suite, #Name, Suite##_##Name}; \
+    static void Suite##_##Name()
+
+// Failed expectations do not abort the test, so that all failures of a test are reported
+#define EXPECT_TRUE(Expression)                                                     \
+    do                                                                              \
+    {                                                                               \
+        if (!(Expression))                                                          \
+            ::Diligent::Testing::ReportFailedCheck(__FILE__, __LINE__, #Expression); \
+    } while (false)
+
+#define EXPECT_FALSE(Expression) EXPECT_TRUE(!(Expression))
+#define EXPECT_EQ(Value1, Value2) EXPECT_TRUE((Value1) == (Value2))
@@ -0,0 +1,67 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+// Runs the unit tests of the sample. The optional argument selects a suite.
+//
+// Usage: Tutorial05Tests [<suite>]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "TestFramework.hpp"
+
+using namespace Diligent;
+
+int main(int argc, char** argv)
+{
+    const char* Suite = argc > 1 ? argv[1] : nullptr;
+
+    int NumRun    = 0;
+    int NumFailed = 0;
+    for (const auto& Test : Testing::GetTestCases())
+    {
+        if (Suite != nullptr && strcmp(Test.Suite, Suite) != 0)
+            continue;
+
+        const int NumFailedChecks = Testing::GetNumFailedChecks();
+        Test.Run();
+        const bool Passed = Testing::GetNumFailedChecks() == NumFailedChecks;
+        printf("[%s] %s.%s\n", Passed ? "  OK  " : "FAILED", Test.Suite, Test.Name);
+        ++NumRun;
+        if (!Passed)
+            ++NumFailed;
+    }
+
+    if (NumRun == 0)
+    {
+        fprintf(stderr, "No tests found%s%s\n", Suite != nullptr ? " in suite " : "", Suite != nullptr ? Suite : "");
+        return EXIT_FAILURE;
+    }
+    printf("%d of %d tests passed\n", NumRun - NumFailed, NumRun);
+    return NumFailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
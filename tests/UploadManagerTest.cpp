@@ -0,0 +1,141 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include <deque>
+#include <random>
+
+#include "UploadManager.hpp"
+#include "TestFramework.hpp"
+
+using namespace Diligent;
+
+namespace
+{
+
+struct Block
+{
+    Uint64 Offset = 0;
+    Uint64 Size   = 0;
+};
+
+bool Overlap(const Block& A, const Block& B)
+{
+    return A.Offset < B.Offset + B.Size && B.Offset < A.Offset + A.Size;
+}
+
+} // namespace
+
+TEST(StagingRing, FullRingRejectsAllocations)
+{
+    StagingRing Ring{16};
+
+    Uint64 Offset = ~Uint64{0};
+    EXPECT_TRUE(Ring.Allocate(16, Offset));
+    EXPECT_EQ(Offset, 0u);
+    EXPECT_FALSE(Ring.Allocate(1, Offset));
+
+    Ring.Reset();
+    EXPECT_FALSE(Ring.Allocate(17, Offset));
+    EXPECT_TRUE(Ring.Allocate(10, Offset));
+    EXPECT_EQ(Offset, 0u);
+    EXPECT_TRUE(Ring.Allocate(6, Offset));
+    EXPECT_EQ(Offset, 10u);
+    EXPECT_FALSE(Ring.Allocate(1, Offset));
+}
+
+TEST(StagingRing, WrapAround)
+{
+    StagingRing Ring{16};
+
+    Uint64 Offset = 0;
+    EXPECT_TRUE(Ring.Allocate(6, Offset)); // [0, 6)
+    EXPECT_TRUE(Ring.Allocate(6, Offset)); // [6, 12)
+    Ring.Release(6);
+
+    // The block does not fit at the end, and at the start it would reach the tail
+    EXPECT_FALSE(Ring.Allocate(6, Offset));
+
+    // The head wraps around and stays one byte behind the tail
+    EXPECT_TRUE(Ring.Allocate(5, Offset));
+    EXPECT_EQ(Offset, 0u);
+    EXPECT_FALSE(Ring.Allocate(1, Offset));
+
+    // Once the tail passes the end, the skipped space at the end is free again
+    Ring.Release(12);
+    EXPECT_TRUE(Ring.Allocate(6, Offset));
+    EXPECT_EQ(Offset, 5u);
+    EXPECT_FALSE(Ring.Allocate(1, Offset));
+    Ring.Release(5);
+    EXPECT_TRUE(Ring.Allocate(5, Offset));
+    EXPECT_EQ(Offset, 11u);
+}
+
+TEST(StagingRing, LiveBlocksNeverOverlap)
+{
+    constexpr Uint64 Capacity = 256;
+
+    std::mt19937      Rng{7};
+    StagingRing       Ring{Capacity};
+    std::deque<Block> Live;
+    Uint32            NumAllocated = 0;
+    Uint32            NumWrapped   = 0;
+    bool              IsValid      = true;
+    for (int Iteration = 0; Iteration < 10000; ++Iteration)
+    {
+        if (Rng() % 3 != 0)
+        {
+            Block NewBlock;
+            NewBlock.Size = 1 + Rng() % 64;
+            if (!Ring.Allocate(NewBlock.Size, NewBlock.Offset))
+                continue;
+
+            IsValid = IsValid && NewBlock.Offset + NewBlock.Size <= Capacity;
+            for (const auto& LiveBlock : Live)
+                IsValid = IsValid && !Overlap(NewBlock, LiveBlock);
+            if (!Live.empty() && NewBlock.Offset < Live.back().Offset)
+                ++NumWrapped;
+            Live.push_back(NewBlock);
+            ++NumAllocated;
+        }
+        else if (!Live.empty())
+        {
+            // Release the oldest blocks the same way UploadManager::Flush() does
+            const size_t NumReleased = 1 + Rng() % Live.size();
+            for (size_t i = 0; i < NumReleased; ++i)
+            {
+                Ring.Release(Live.front().Offset + Live.front().Size);
+                Live.pop_front();
+            }
+            if (Live.empty())
+                Ring.Reset();
+        }
+    }
+
+    EXPECT_TRUE(IsValid);
+    EXPECT_TRUE(NumAllocated > 1000);
+    EXPECT_TRUE(NumWrapped > 0);
+}
@@ -0,0 +1,116 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+// Packs asset files into an archive that Tutorial05_TextureArray reads with --archive <path>.
+// Entries are named after the file names without directories.
+//
+// Usage: AssetPacker [--no-compress] <archive> <file> [<file> ...]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "AssetArchive.hpp"
+
+using namespace Diligent;
+
+namespace
+{
+
+bool ReadFile(const char* Path, std::vector<Uint8>& Data)
+{
+    FILE* pFile = std::fopen(Path, "rb");
+    if (pFile == nullptr)
+        return false;
+
+    std::fseek(pFile, 0, SEEK_END);
+    Data.resize(static_cast<size_t>(std::ftell(pFile)));
+    std::fseek(pFile, 0, SEEK_SET);
+    const bool Success = std::fread(Data.data(), 1, Data.size(), pFile) == Data.size();
+    std::fclose(pFile);
+    return Success;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int  Arg      = 1;
+    bool Compress = true;
+    if (Arg < argc && std::strcmp(argv[Arg], "--no-compress") == 0)
+    {
+        Compress = false;
+        ++Arg;
+    }
+    if (argc - Arg < 2)
+    {
+        std::printf("Usage: AssetPacker [--no-compress] <archive> <file> [<file> ...]\n");
+        return EXIT_FAILURE;
+    }
+
+    const char* ArchivePath = argv[Arg++];
+
+    std::vector<AssetArchive::SourceFile> Files;
+    Uint64                                TotalSize = 0;
+    for (; Arg < argc; ++Arg)
+    {
+        AssetArchive::SourceFile File;
+
+        const std::string Path      = argv[Arg];
+        const size_t      Separator = Path.find_last_of("/\\");
+        File.Name                   = Separator != std::string::npos ? Path.substr(Separator + 1) : Path;
+        if (!ReadFile(Path.c_str(), File.Data))
+        {
+            std::fprintf(stderr, "Failed to read '%s'\n", Path.c_str());
+            return EXIT_FAILURE;
+        }
+        TotalSize += File.Data.size();
+        Files.emplace_back(std::move(File));
+    }
+
+    const size_t NumFiles = Files.size();
+    if (!AssetArchive::Write(ArchivePath, std::move(Files), Compress))
+        return EXIT_FAILURE;
+
+    if (auto pArchive = AssetArchive::Open(ArchivePath))
+    {
+        Uint64 StoredSize    = 0;
+        Uint32 NumCompressed = 0;
+        for (Uint32 i = 0; i < pArchive->GetNumEntries(); ++i)
+        {
+            const auto& Entry = pArchive->GetEntry(i);
+            StoredSize += Entry.StoredSize;
+            if (Entry.Compression != AssetArchive::COMPRESSION_NONE)
+                ++NumCompressed;
+        }
+        std::printf("Packed %zu files (%u compressed) into '%s': %llu -> %llu bytes\n", NumFiles, NumCompressed, ArchivePath,
+                    static_cast<unsigned long long>(TotalSize), static_cast<unsigned long long>(StoredSize));
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,96 @@
+/*
+ *  Copyright 2019-2024 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+// Test producer for the shared-memory scene feed. Publishes a ring of spinning cubes
+// that Tutorial05_TextureArray renders when started with --scene_feed <name>.
+//
+// Usage: SceneFeedProducer [name] [num_instances] [updates_per_second]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <thread>
+
+#include "SharedSceneFeed.hpp"
+
+using namespace Diligent;
+
+namespace
+{
+
+volatile std::sig_atomic_t g_Exit = 0;
+
+void OnSignal(int)
+{
+    g_Exit = 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const char*  Name         = argc > 1 ? argv[1] : "Tutorial05_SceneFeed";
+    const Uint32 NumInstances = argc > 2 ? static_cast<Uint32>(std::atoi(argv[2])) : 256;
+    const int    Rate         = argc > 3 ? std::max(std::atoi(argv[3]), 1) : 120;
+
+    auto pFeed = SharedSceneFeed::Create(Name, NumInstances);
+    if (!pFeed)
+        return EXIT_FAILURE;
+
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+    std::printf("Publishing %u instances to '%s' at %d Hz. Press Ctrl+C to stop.\n", NumInstances, Name, Rate);
+
+    const auto StartTime = std::chrono::steady_clock::now();
+    const auto Period    = std::chrono::microseconds{1000000 / Rate};
+    auto       NextFrame = StartTime;
+    while (!g_Exit)
+    {
+        const float Time = std::chrono::duration<float>(std::chrono::steady_clock::now() - StartTime).count();
+
+        InstanceData* pInstances = pFeed->BeginWrite();
+        for (Uint32 i = 0; i < NumInstances; ++i)
+        {
+            const float Angle = 2.f * PI_F * static_cast<float>(i) / static_cast<float>(NumInstances) + Time * 0.3f;
+            const float Y     = 4.f + 0.5f * std::sin(Time * 2.f + static_cast<float>(i) * 0.2f);
+
+            auto& Inst      = pInstances[i];
+            Inst.Matrix     = float4x4::Scale(0.25f, 0.25f, 0.25f) * float4x4::RotationY(Time + static_cast<float>(i)) * float4x4::Translation(12.f * std::cos(Angle), Y, 12.f * std::sin(Angle));
+            Inst.TextureInd = static_cast<float>(i % 3);
+            Inst.Flipbook   = float4{0, 0, 0, 0};
+        }
+        pFeed->EndWrite(NumInstances);
+
+        NextFrame += Period;
+        std::this_thread::sleep_until(NextFrame);
+    }
+
+    return EXIT_SUCCESS;
+}